@@ -0,0 +1,262 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2017 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+#ifndef AUTHBASIC_H_
+#define AUTHBASIC_H_
+
+#include "Base64.h"
+
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * Authentication schemes accepted in the authorization header field.
+ */
+enum class AuthScheme: uint8_t {
+	Digest = 1,	///< Digest access authentication only (RFC7616, see AuthDigest).
+	Basic = 2,	///< Basic authentication only (RFC7617), meant to be used over TLS.
+	Both = 3	///< Either of the two, as chosen by the client.
+};
+
+/**
+ * Validator for the basic authorization header field.
+ *
+ * The _user-id:password_ pair is decoded as it is received and compared to
+ * the _username_ and _password_ members of the _AuthProvider_ (only a single
+ * user is supported). There is no hashing involved, and no nonce round-trip
+ * is needed, but the password is sent in the clear (apart from the encoding).
+ *
+ * The comparison is done in constant time, every received byte is compared
+ * to the expected one and the differences are accumulated. It only depends
+ * on the length of the input, not on the position of the first mismatch.
+ *
+ * The interface is the same as that of AuthDigest, so that they can be
+ * used interchangeably (the nonce related parts are no-ops).
+ */
+template<class AuthProvider>
+class AuthBasic: Base64::Parser<AuthBasic<AuthProvider> > {
+	friend Base64::Parser<AuthBasic>;
+
+public:
+	/// Nothing to cache, the check is cheap.
+	class Cache {
+	public:
+		inline void clear() {}
+	};
+
+private:
+	/// Name of the scheme, matched case-insensitively.
+	static constexpr const char* scheme() {return "basic";}
+
+	enum class State: uint8_t {
+		Scheme,
+		Space,
+		Credentials,
+		Failed,
+		Authorized
+	};
+
+	State state;
+
+	/// Number of matched characters of the scheme name.
+	uint8_t schemeIdx;
+
+	/// Bitwise OR of the differences between the received and expected bytes.
+	uint8_t difference;
+
+	/// Number of bytes of the credentials received (saturated).
+	uint16_t position;
+
+	/// Lengths of the expected user name and password, measured once per request.
+	uint16_t userLength, passwordLength;
+
+	static inline uint16_t lengthOf(const char* str) {
+		return str ? (uint16_t)strlen(str) : 0;
+	}
+
+	// Base64::Parser
+	inline void bytesDecoded(const char* buff, uint32_t length) {
+		// The branches only depend on the position, not on the data.
+		while(length--) {
+			char expected = '\0';
+
+			if(position < userLength)
+				expected = AuthProvider::username[position];
+			else if(position == userLength)
+				expected = ':';
+			else if(position <= userLength + passwordLength)
+				expected = AuthProvider::password[position - userLength - 1];
+
+			difference |= *buff++ ^ expected;
+
+			if(position != 0xffff)
+				position++;
+		}
+	}
+
+public:
+	inline void parseAuthField(const char* buff, unsigned int length) {
+		for(; length; buff++, length--) {
+			if(state == State::Scheme) {
+				const char c = (*buff >= 'A' && *buff <= 'Z') ? (*buff - 'A' + 'a') : *buff;
+
+				if(schemeIdx == strlen(scheme()) && c == ' ')
+					state = State::Space;
+				else if(schemeIdx < strlen(scheme()) && c == scheme()[schemeIdx])
+					schemeIdx++;
+				else
+					state = State::Failed;
+			} else if(state == State::Space) {
+				if(*buff != ' ')
+					state = State::Credentials;
+			}
+
+			if(state == State::Credentials) {
+				if(!Base64::Parser<AuthBasic>::parse(buff, length))
+					state = State::Failed;
+
+				break;
+			}
+		}
+	}
+
+	inline void authFieldDone()
+	{
+		if(state == State::Credentials && Base64::Parser<AuthBasic>::done()) {
+			state = (!difference && position == userLength + 1 + passwordLength) ? State::Authorized : State::Failed;
+		} else
+			state = State::Failed;
+	}
+
+	void reset(const char* method, uint32_t now = 0, Cache* cache = nullptr) {
+		Base64::Parser<AuthBasic>::reset();
+		state = (AuthProvider::username && AuthProvider::password) ? State::Scheme : State::Failed;
+		schemeIdx = 0;
+		difference = 0;
+		position = 0;
+		userLength = lengthOf(AuthProvider::username);
+		passwordLength = lengthOf(AuthProvider::password);
+	}
+
+	bool isAuthorized() {
+		return state == State::Authorized;
+	}
+
+	/// Name of the user (only valid if _isAuthorized_ returns true).
+	const char* getUsername() {
+		return AuthProvider::username;
+	}
+
+	bool isStale() {
+		return false;
+	}
+
+	bool hasNonceCount() {
+		return false;
+	}
+
+	uint32_t getNonceCount() {
+		return 0;
+	}
+
+	const char* getNonce() {
+		return nullptr;
+	}
+
+	uint32_t getNonceLength() {
+		return 0;
+	}
+};
+
+/**
+ * Validator that accepts the credentials if either of the
+ * _First_ or the _Second_ one does, both are fed the same
+ * authorization header field. Only the _First_ one can use
+ * a cache and nonces.
+ */
+template<class First, class Second>
+class AuthEither {
+	First first;
+	Second second;
+
+public:
+	typedef typename First::Cache Cache;
+
+	inline void parseAuthField(const char* buff, unsigned int length) {
+		first.parseAuthField(buff, length);
+		second.parseAuthField(buff, length);
+	}
+
+	inline void authFieldDone() {
+		first.authFieldDone();
+		second.authFieldDone();
+	}
+
+	void reset(const char* method, uint32_t now = 0, Cache* cache = nullptr) {
+		first.reset(method, now, cache);
+		second.reset(method, now);
+	}
+
+	bool isAuthorized() {
+		return first.isAuthorized() || second.isAuthorized();
+	}
+
+	const char* getUsername() {
+		return first.isAuthorized() ? first.getUsername() : second.getUsername();
+	}
+
+	bool isStale() {
+		return first.isStale();
+	}
+
+	bool hasNonceCount() {
+		return first.isAuthorized() && first.hasNonceCount();
+	}
+
+	uint32_t getNonceCount() {
+		return first.getNonceCount();
+	}
+
+	const char* getNonce() {
+		return first.getNonce();
+	}
+
+	uint32_t getNonceLength() {
+		return first.getNonceLength();
+	}
+};
+
+/**
+ * Selects the validator type for the enabled authentication schemes.
+ */
+template<AuthScheme schemes, class Digest, class Basic>
+struct AuthValidatorFor {
+	typedef AuthEither<Digest, Basic> Type;
+};
+
+template<class Digest, class Basic>
+struct AuthValidatorFor<AuthScheme::Digest, Digest, Basic> {
+	typedef Digest Type;
+};
+
+template<class Digest, class Basic>
+struct AuthValidatorFor<AuthScheme::Basic, Digest, Basic> {
+	typedef Basic Type;
+};
+
+#endif /* AUTHBASIC_H_ */
@@ -25,44 +25,186 @@
 #include "SplitParser.h"
 #include "ConstantStringMatcher.h"
 #include "TemporaryStringBuffer.h"
+#include "DigestNonce.h"
+#include "DigestHash.h"
+#include "DigestCredentials.h"
 
-#include "md5/md5.h"
-
-template<class AuthProvider>
-class AuthDigest: public 	Splitter<AuthDigest<AuthProvider> >,
-							KvParser<AuthDigest<AuthProvider> > {
+/**
+ * Validator for the digest authorization header field.
+ *
+ * The hash algorithm is selected at compile time (see DigestHash.h), the
+ * A1 hashes provided by the _AuthProvider_ need to be computed with the same.
+ *
+ * The users are looked up in the credential store type named _Credentials_
+ * in the _AuthProvider_ (see DigestCredentials.h), if there is none then
+ * its _username_ and _RFC2069_A1_ members define the only valid user.
+ */
+template<class AuthProvider, class Hash = DigestMd5>
+class AuthDigest: public 	Splitter<AuthDigest<AuthProvider, Hash> >,
+							KvParser<AuthDigest<AuthProvider, Hash> > {
 	friend Splitter<AuthDigest>;
 	friend KvParser<AuthDigest>;
 
+public:
+	/**
+	 * The last verified response, that can be kept between the requests of a
+	 * session to skip the hashing if the same credentials are sent again.
+	 *
+	 * Responses with a nonce-count are never repeated, so they are not cached.
+	 * The user is identified by the address of its A1 hash, so the entries of
+	 * a credential store must not be modified in place while it is in use.
+	 */
+	class Cache {
+		friend AuthDigest;
+		const char* ha1;
+		unsigned char A2[Hash::length];
+		char response[Hash::length];
+		TemporaryStringBuffer<40> nonce;
+	public:
+		inline void clear() {
+			ha1 = nullptr;
+		}
+	};
+
+private:
 	typedef void (*AuthFieldParser)(AuthDigest*, const char*, uint32_t);
-	typedef Keywords<AuthFieldParser, 7> AuthKeywords;
+	typedef Keywords<AuthFieldParser, 10> AuthKeywords;
 	static const AuthKeywords authKeywords;
 	AuthFieldParser fieldParser;
 
+	/*
+	 * Optional nonce validation parameters, if the provider has no nonce
+	 * key then any nonce is accepted (ie. it is up to the client). The
+	 * HttpLogic does not allow that, it always has a key for digest auth.
+	 */
+	struct NonceParams {
+		template<class T> static constexpr const char* k(decltype(&T::nonceKey)) {return T::nonceKey;}
+		template<class T> static constexpr const char* k(...) {return nullptr;}
+		template<class T> static constexpr uint32_t l(decltype(&T::nonceLifetime)) {return T::nonceLifetime;}
+		template<class T> static constexpr uint32_t l(...) {return 0;}
+		static constexpr const char* key = k<AuthProvider>(0);
+		static constexpr uint32_t lifetime = l<AuthProvider>(0);
+		static constexpr bool hasKey = key != nullptr;
+	};
+
+	/*
+	 * The realm of the provider, without one no realm is accepted (the
+	 * empty string stands in, so that the matcher never sees a null).
+	 */
+	struct RealmParams {
+		static constexpr bool hasRealm = AuthProvider::realm != nullptr;
+		static constexpr const char* value = hasRealm ? AuthProvider::realm : "";
+	};
+
+	struct CredentialParams {
+		template<class T> static typename T::Credentials c(typename T::Credentials*);
+		template<class T> static SingleCredential<T> c(...);
+		typedef decltype(c<AuthProvider>(nullptr)) Store;
+	};
+
 	struct {
-		MD5_CTX md5Context;
-		unsigned char A2[16];
-		HexParser<16> response;
-		TemporaryStringBuffer<16> nonceHolder;
+		typename CredentialParams::Store::Matcher user;
+		typename Hash::Context hashContext;
+		unsigned char A2[Hash::length];
+		bool uriDone;
+		HexParser<Hash::length> response;
+		TemporaryStringBuffer<40> nonceHolder;
 		ConstantStringMatcher cstrMatcher;
 	} RFC2069;
 
+	/*
+	 * Additional fields of the RFC2617 (qop=auth) response, these
+	 * can come in any order, so they need to be stored.
+	 */
+	struct {
+		TemporaryStringBuffer<40> cnonce;
+		TemporaryStringBuffer<9> nc;
+		bool qop;
+	} RFC2617;
+
 	enum class State {
 		Initial,
 		AuthTypeWrong,
 		AuthTypeOk,
 		AuthFailed,
+		AuthStale,
 		AuthSucces
 	};
 
+	/// Current time for nonce validation.
+	uint32_t now;
+
+	/// Optional cache of the last verified response.
+	Cache* cache;
+
+	bool isCached(const char* hashA1)
+	{
+		return cache && !RFC2617.qop && cache->ha1 == hashA1
+				&& cache->nonce.length() == RFC2069.nonceHolder.length()
+				&& memcmp(cache->nonce.data(), RFC2069.nonceHolder.data(), RFC2069.nonceHolder.length()) == 0
+				&& memcmp(cache->A2, RFC2069.A2, sizeof(RFC2069.A2)) == 0
+				&& memcmp(cache->response, RFC2069.response.data(), sizeof(cache->response)) == 0;
+	}
+
+	void store(const char* hashA1)
+	{
+		if(cache && !RFC2617.qop) {
+			cache->ha1 = hashA1;
+			memcpy(cache->A2, RFC2069.A2, sizeof(RFC2069.A2));
+			memcpy(cache->response, RFC2069.response.data(), sizeof(cache->response));
+			cache->nonce.clear();
+			cache->nonce.save(RFC2069.nonceHolder.data(), RFC2069.nonceHolder.length());
+		}
+	}
+
+	bool verify(const char* hashA1)
+	{
+		Hash::init(&RFC2069.hashContext);
+		Hash::update(&RFC2069.hashContext, hashA1, strlen(hashA1));
+		Hash::update(&RFC2069.hashContext, ":", 1);
+		Hash::update(&RFC2069.hashContext, RFC2069.nonceHolder.data(), RFC2069.nonceHolder.length());
+		Hash::update(&RFC2069.hashContext, ":", 1);
+
+		if(RFC2617.qop) {
+			Hash::update(&RFC2069.hashContext, RFC2617.nc.data(), RFC2617.nc.length());
+			Hash::update(&RFC2069.hashContext, ":", 1);
+			Hash::update(&RFC2069.hashContext, RFC2617.cnonce.data(), RFC2617.cnonce.length());
+			Hash::update(&RFC2069.hashContext, ":auth:", 6);
+		}
+
+		unsigned char str[16];
+
+		for(uint32_t i=0; i<Hash::length / 8; i++) {
+			for(int j=0; j<8; j++) {
+				static const char hex[] = "0123456789abcdef";
+				str[2*j + 0] = hex[RFC2069.A2[8 * i + j] >> 4];
+				str[2*j + 1] = hex[RFC2069.A2[8 * i + j] & 0xf];
+			}
+			Hash::update(&RFC2069.hashContext, str, sizeof(str));
+		}
+
+		unsigned char result[Hash::length];
+		Hash::final(result, &RFC2069.hashContext);
+
+		if(memcmp(result, RFC2069.response.data(), sizeof(result)) != 0)
+			return false;
+
+		store(hashA1);
+		return true;
+	}
+
 	static void parseUsername(AuthDigest* self, const char* buff, uint32_t length) {
 		if(!buff) {
 			if(length)
-				self->RFC2069.cstrMatcher.reset();
-			else if(!self->RFC2069.cstrMatcher.matches(AuthProvider::username))
-				self->state = State::AuthFailed;
+				self->RFC2069.user.reset();
+			else {
+				self->RFC2069.user.done();
+
+				if(!self->RFC2069.user.ha1())
+					self->state = State::AuthFailed;
+			}
 		} else {
-			self->RFC2069.cstrMatcher.progressWithMatching(AuthProvider::username, buff, length);
+			self->RFC2069.user.progress(buff, length);
 		}
 	}
 
@@ -79,10 +221,12 @@ class AuthDigest: public 	Splitter<AuthDigest<AuthProvider> >,
 	static void parseUri(AuthDigest* self, const char* buff, uint32_t length)
 	{
 		if(!buff) {
-			if(!length)
-				MD5_Final(self->RFC2069.A2, &self->RFC2069.md5Context);
+			if(!length) {
+				Hash::final(self->RFC2069.A2, &self->RFC2069.hashContext);
+				self->RFC2069.uriDone = true;
+			}
 		} else {
-			MD5_Update(&self->RFC2069.md5Context, buff, length);
+			Hash::update(&self->RFC2069.hashContext, buff, length);
 		}
 	}
 
@@ -91,10 +235,10 @@ class AuthDigest: public 	Splitter<AuthDigest<AuthProvider> >,
 		if(!buff) {
 			if(length)
 				self->RFC2069.cstrMatcher.reset();
-			else if(!self->RFC2069.cstrMatcher.matches(AuthProvider::realm))
+			else if(!RealmParams::hasRealm || !self->RFC2069.cstrMatcher.matches(RealmParams::value))
 				self->state = State::AuthFailed;
 		} else {
-			self->RFC2069.cstrMatcher.progressWithMatching(AuthProvider::realm, buff, length);
+			self->RFC2069.cstrMatcher.progressWithMatching(RealmParams::value, buff, length);
 		}
 	}
 
@@ -110,15 +254,56 @@ class AuthDigest: public 	Splitter<AuthDigest<AuthProvider> >,
 		}
 	}
 
+	static void parseCnonce(AuthDigest* self, const char* buff, uint32_t length)
+	{
+		if(!buff) {
+			if(length)
+				self->RFC2617.cnonce.clear();
+		} else if(!self->RFC2617.cnonce.save(buff, length))
+			self->state = State::AuthFailed;
+	}
+
+	static void parseNc(AuthDigest* self, const char* buff, uint32_t length)
+	{
+		if(!buff) {
+			if(length)
+				self->RFC2617.nc.clear();
+			else if(self->RFC2617.nc.length() != 8)
+				self->state = State::AuthFailed;
+		} else if(!self->RFC2617.nc.save(buff, length))
+			self->state = State::AuthFailed;
+		else {
+			for(uint32_t i = 0; i < length; i++) {
+				const char c = buff[i] | 0x20;
+				if(!('0' <= c && c <= '9') && !('a' <= c && c <= 'f'))
+					self->state = State::AuthFailed;
+			}
+		}
+	}
+
+	static void parseQop(AuthDigest* self, const char* buff, uint32_t length)
+	{
+		if(!buff) {
+			if(length)
+				self->RFC2069.cstrMatcher.reset();
+			else if(!self->RFC2069.cstrMatcher.matches("auth"))
+				self->state = State::AuthFailed;
+			else
+				self->RFC2617.qop = true;
+		} else {
+			self->RFC2069.cstrMatcher.progressWithMatching("auth", buff, length);
+		}
+	}
+
 	static void parseAlgorithm(AuthDigest* self, const char* buff, uint32_t length)
 	{
 		if(!buff) {
 			if(length)
 				self->RFC2069.cstrMatcher.reset();
-			else if(!self->RFC2069.cstrMatcher.matches("MD5"))
+			else if(!self->RFC2069.cstrMatcher.matches(Hash::name()))
 				self->state = State::AuthFailed;
 		} else {
-			self->RFC2069.cstrMatcher.progressWithMatching("MD5", buff, length);
+			self->RFC2069.cstrMatcher.progressWithMatching(Hash::name(), buff, length);
 		}
 	}
 
@@ -188,39 +373,45 @@ public:
 	inline void authFieldDone()
 	{
 		Splitter<AuthDigest>::splittingDone();
-		const char* hashA1 = AuthProvider::RFC2069_A1;
-
-		if(state == State::AuthTypeOk && hashA1) {
-			MD5_Init(&RFC2069.md5Context);
-			MD5_Update(&RFC2069.md5Context, hashA1, strlen(hashA1));
-			MD5_Update(&RFC2069.md5Context, ":", 1);
-			MD5_Update(&RFC2069.md5Context, RFC2069.nonceHolder.data(), RFC2069.nonceHolder.length());
-			MD5_Update(&RFC2069.md5Context, ":", 1);
-
-			unsigned char str[16];
-
-			for(int i=0; i<2; i++) {
-				for(int j=0; j<8; j++) {
-					static const char hex[] = "0123456789abcdef";
-					str[2*j + 0] = hex[RFC2069.A2[8 * i + j] >> 4];
-					str[2*j + 1] = hex[RFC2069.A2[8 * i + j] & 0xf];
-				}
-				MD5_Update(&RFC2069.md5Context, str, sizeof(str));
-			}
+		const char* hashA1 = RFC2069.user.ha1();
 
-			MD5_Final(str, &RFC2069.md5Context);
+		if(RFC2617.qop && (RFC2617.nc.length() != 8 || !RFC2617.cnonce.length()))
+			state = State::AuthFailed;
 
-			if(memcmp(str, RFC2069.response.data(), sizeof(str)) == 0) {
-				state = State::AuthSucces;
-			} else
+		if(state == State::AuthTypeOk && hashA1 && RFC2069.uriDone && RFC2069.response.isDone()) {
+			if(!isCached(hashA1) && !verify(hashA1))
 				state = State::AuthFailed;
+			else if(!NonceParams::hasKey)
+				state = State::AuthSucces;
+			else {
+				switch(DigestNonce::check(NonceParams::key, RFC2069.nonceHolder.data(),
+						RFC2069.nonceHolder.length(), now, NonceParams::lifetime)) {
+					case DigestNonce::Result::Valid:
+						state = State::AuthSucces;
+						break;
+					case DigestNonce::Result::Stale:
+						state = State::AuthStale;
+						break;
+					default:
+						state = State::AuthFailed;
+				}
+			}
 		}
 	}
 
-	void reset(const char* method) {
-		MD5_Init(&RFC2069.md5Context);
-		MD5_Update(&RFC2069.md5Context, method, strlen(method));
-		MD5_Update(&RFC2069.md5Context, ":", 1);
+	void reset(const char* method, uint32_t now = 0, Cache* cache = nullptr) {
+		this->now = now;
+		this->cache = cache;
+		RFC2069.user.reset();
+		RFC2069.uriDone = false;
+		RFC2069.response.clear();
+		RFC2069.nonceHolder.clear();
+		RFC2617.cnonce.clear();
+		RFC2617.nc.clear();
+		RFC2617.qop = false;
+		Hash::init(&RFC2069.hashContext);
+		Hash::update(&RFC2069.hashContext, method, strlen(method));
+		Hash::update(&RFC2069.hashContext, ":", 1);
 		Splitter<AuthDigest>::reset();
 		KvParser<AuthDigest>::reset();
     	keywordMatcher.reset();
@@ -230,28 +421,84 @@ public:
 	bool isAuthorized() {
 		return state == State::AuthSucces;
 	}
+
+	/// Name of the user (only valid if _isAuthorized_ returns true).
+	const char* getUsername() {
+		return RFC2069.user.username();
+	}
+
+	/// Returns true if the credentials are right, but the nonce is too old.
+	bool isStale() {
+		return state == State::AuthStale;
+	}
+
+	/// Returns true if the client used the RFC2617 style response with a nonce-count.
+	bool hasNonceCount() {
+		return RFC2617.qop;
+	}
+
+	/// The value of the nonce-count (only valid if _hasNonceCount_ returns true).
+	uint32_t getNonceCount() {
+		uint32_t ret = 0;
+
+		for(uint32_t i = 0; i < RFC2617.nc.length(); i++) {
+			const char c = RFC2617.nc.data()[i];
+			ret = ret << 4 | ((c <= '9') ? (c - '0') : ((c | 0x20) - 'a' + 10));
+		}
+
+		return ret;
+	}
+
+	/// Nonce supplied by the client.
+	const char* getNonce() {
+		return RFC2069.nonceHolder.data();
+	}
+
+	/// Length of the nonce supplied by the client.
+	uint32_t getNonceLength() {
+		return RFC2069.nonceHolder.length();
+	}
 };
 
-template<class AuthProvider>
-const typename AuthDigest<AuthProvider>::AuthKeywords
-AuthDigest<AuthProvider>::authKeywords({
-	typename AuthKeywords::Keyword("uri", &AuthDigest<AuthProvider>::parseUri),
-	typename AuthKeywords::Keyword("nonce", &AuthDigest<AuthProvider>::parseNonce),
-	typename AuthKeywords::Keyword("realm", &AuthDigest<AuthProvider>::parseRealm),
+template<class AuthProvider, class Hash>
+const typename AuthDigest<AuthProvider, Hash>::AuthKeywords
+AuthDigest<AuthProvider, Hash>::authKeywords({
+	typename AuthKeywords::Keyword("uri", &AuthDigest<AuthProvider, Hash>::parseUri),
+	typename AuthKeywords::Keyword("nonce", &AuthDigest<AuthProvider, Hash>::parseNonce),
+	typename AuthKeywords::Keyword("realm", &AuthDigest<AuthProvider, Hash>::parseRealm),
 	typename AuthKeywords::Keyword("Digest", nullptr),
-	typename AuthKeywords::Keyword("response", &AuthDigest<AuthProvider>::parseResponse),
-	typename AuthKeywords::Keyword("username", &AuthDigest<AuthProvider>::parseUsername),
-	typename AuthKeywords::Keyword("algorithm", &AuthDigest<AuthProvider>::parseAlgorithm)
+	typename AuthKeywords::Keyword("response", &AuthDigest<AuthProvider, Hash>::parseResponse),
+	typename AuthKeywords::Keyword("username", &AuthDigest<AuthProvider, Hash>::parseUsername),
+	typename AuthKeywords::Keyword("algorithm", &AuthDigest<AuthProvider, Hash>::parseAlgorithm),
+	typename AuthKeywords::Keyword("cnonce", &AuthDigest<AuthProvider, Hash>::parseCnonce),
+	typename AuthKeywords::Keyword("nc", &AuthDigest<AuthProvider, Hash>::parseNc),
+	typename AuthKeywords::Keyword("qop", &AuthDigest<AuthProvider, Hash>::parseQop)
+});
 
-	/*
-		For RFC2617 and RFC7235
 
-		AuthKeywords::Keyword("cnonce", AuthField::CNonce),
-		AuthKeywords::Keyword("nc", AuthField::Nc),
-		AuthKeywords::Keyword("qop", AuthField::Qop)
-	*/
-});
+/**
+ * Storage for the cache of an AuthDigest validator if it is _enabled_.
+ */
+template<class Validator, bool enabled>
+struct AuthDigestCache {
+	typename Validator::Cache cache;
+
+	inline typename Validator::Cache* get() {
+		return &cache;
+	}
+
+	inline void clear() {
+		cache.clear();
+	}
+};
 
+template<class Validator>
+struct AuthDigestCache<Validator, false> {
+	inline typename Validator::Cache* get() {
+		return nullptr;
+	}
 
+	inline void clear() {}
+};
 
 #endif /* AUTHDIGEST_H_ */
@@ -10,6 +10,13 @@
 
 #include "meta/Sequence.h"
 
+#include <stdint.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__) && !defined(BASE64_NO_SIMD)
+#define BASE64_SSSE3
+#include <tmmintrin.h>
+#endif
+
 namespace detail {
 	/// Mapping inversion helper template declaration.
 	template<const char (&forward)[64], class> struct Reversor;
@@ -62,8 +69,14 @@ namespace detail {
 	template<const char (&forward)[64], int... i>
 	constexpr const char Reversor<forward, pet::Sequence<i...>>::value[];
 
-	/// Forward and reverse alphabet lookup for the encoder and decoder.
-	struct Alphabet {
+	/**
+	 * Forward and reverse alphabet lookup for the encoder and decoder.
+	 *
+	 * A template only to allow defining the tables in the header
+	 * without violating the one definition rule.
+	 */
+	template<class = void>
+	struct AlphabetTables {
 		/// The encoder table.
 		static constexpr const char forwardLut[64] = {
 				'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H', 'I', 'J', 'K', 'L', 'M', 'N', 'O', 'P',
@@ -75,13 +88,186 @@ namespace detail {
 		static constexpr const char (&reverseLut)[256] = Reversor<forwardLut, pet::sequence<0, 256>>::value;
 	};
 
-	constexpr const char Alphabet::forwardLut[];
+	template<class Dummy>
+	constexpr const char AlphabetTables<Dummy>::forwardLut[];
+
+	typedef AlphabetTables<> Alphabet;
+
+	/**
+	 * Bulk encoder and decoder kernels.
+	 *
+	 * They process whole groups (three bytes of data, four characters
+	 * of encoded text) from the input into the output buffer, as many
+	 * as they can, and move the input pointer accordingly.
+	 *
+	 * The portable kernels use the lookup tables. The vectorized ones
+	 * (Muła, Lemire: Faster Base64 Encoding and Decoding Using AVX2
+	 * Instructions, 2018) use the SSSE3 byte shuffle for the lookup,
+	 * and process sixteen characters at a time. They are only compiled
+	 * in for x86 targets with a GCC compatible compiler (unless
+	 * BASE64_NO_SIMD is defined) and are selected at runtime if the
+	 * CPU supports them.
+	 *
+	 * A template only to allow defining the selector in the header
+	 * without violating the one definition rule.
+	 */
+	template<class = void>
+	struct Base64Kernels {
+		/// Set if the vectorized kernels are in use.
+		static bool vectorized;
+
+		static inline uint32_t decodePortable(const char* &in, const char* end, char* out, uint32_t space)
+		{
+			uint32_t ret = 0;
+
+			for(; end - in >= 4 && space - ret >= 3; in += 4) {
+				const uint8_t a = Alphabet::reverseLut[(unsigned char)in[0]];
+				const uint8_t b = Alphabet::reverseLut[(unsigned char)in[1]];
+				const uint8_t c = Alphabet::reverseLut[(unsigned char)in[2]];
+				const uint8_t d = Alphabet::reverseLut[(unsigned char)in[3]];
+
+				// Invalid characters and padding are handled by the caller.
+				if((a | b | c | d) & 0x80)
+					break;
+
+				out[ret++] = a << 2 | b >> 4;
+				out[ret++] = b << 4 | c >> 2;
+				out[ret++] = c << 6 | d;
+			}
+
+			return ret;
+		}
+
+		static inline uint32_t encodePortable(const char* &in, const char* end, char* out, uint32_t space)
+		{
+			uint32_t ret = 0;
+
+			for(; end - in >= 3 && space - ret >= 4; in += 3) {
+				const uint8_t a = in[0], b = in[1], c = in[2];
+				out[ret++] = Alphabet::forwardLut[a >> 2];
+				out[ret++] = Alphabet::forwardLut[b >> 4 | (a & 0x3) << 4];
+				out[ret++] = Alphabet::forwardLut[c >> 6 | (b & 0xf) << 2];
+				out[ret++] = Alphabet::forwardLut[c & 0x3f];
+			}
+
+			return ret;
+		}
+
+#ifdef BASE64_SSSE3
+		/*
+		 * The characters are classified by their nibbles, the
+		 * high one selects the offset to be added to get the
+		 * value, and an input is invalid if the bitmasks looked
+		 * up by its nibbles have a common bit set.
+		 */
+		__attribute__((target("ssse3")))
+		static inline uint32_t decodeSsse3(const char* &in, const char* end, char* out, uint32_t space)
+		{
+			const __m128i lutLo = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+					0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a);
+			const __m128i lutHi = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+					0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+			const __m128i lutRoll = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+			const __m128i pack = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+			const __m128i nibble = _mm_set1_epi8(0x0f);
+			uint32_t ret = 0;
+
+			// The store writes sixteen bytes, of which twelve are valid.
+			for(; end - in >= 16 && space - ret >= 16; in += 16, ret += 12) {
+				const __m128i input = _mm_loadu_si128((const __m128i*)in);
+				const __m128i hi = _mm_and_si128(_mm_srli_epi32(input, 4), nibble);
+				const __m128i lo = _mm_and_si128(input, nibble);
+				const __m128i check = _mm_and_si128(_mm_shuffle_epi8(lutLo, lo), _mm_shuffle_epi8(lutHi, hi));
+
+				if(_mm_movemask_epi8(_mm_cmpgt_epi8(check, _mm_setzero_si128())))
+					break;
+
+				const __m128i slash = _mm_cmpeq_epi8(input, _mm_set1_epi8('/'));
+				const __m128i values = _mm_add_epi8(input, _mm_shuffle_epi8(lutRoll, _mm_add_epi8(slash, hi)));
+
+				// Merge the 6 bit values into 12 then 24 bit ones, and drop the unused bytes.
+				const __m128i merged = _mm_madd_epi16(
+						_mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140)),
+						_mm_set1_epi32(0x00011000));
+
+				_mm_storeu_si128((__m128i*)(out + ret), _mm_shuffle_epi8(merged, pack));
+			}
+
+			return ret;
+		}
+
+		/*
+		 * Each three bytes of input are spread into four 16 bit halves,
+		 * then the 6 bit values are moved into place with multiplications.
+		 * The offsets to be added to get the characters are looked up by
+		 * a reduced index derived from the value.
+		 */
+		__attribute__((target("ssse3")))
+		static inline uint32_t encodeSsse3(const char* &in, const char* end, char* out, uint32_t space)
+		{
+			const __m128i spread = _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+			const __m128i offsets = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+					'0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+			uint32_t ret = 0;
+
+			// The load reads sixteen bytes, of which twelve are used.
+			for(; end - in >= 16 && space - ret >= 16; in += 12, ret += 16) {
+				const __m128i input = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)in), spread);
+
+				const __m128i values = _mm_or_si128(
+						_mm_mulhi_epu16(_mm_and_si128(input, _mm_set1_epi32(0x0fc0fc00)), _mm_set1_epi32(0x04000040)),
+						_mm_mullo_epi16(_mm_and_si128(input, _mm_set1_epi32(0x003f03f0)), _mm_set1_epi32(0x01000010)));
+
+				__m128i index = _mm_subs_epu8(values, _mm_set1_epi8(51));
+				index = _mm_or_si128(index, _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), values), _mm_set1_epi8(13)));
+
+				_mm_storeu_si128((__m128i*)(out + ret), _mm_add_epi8(_mm_shuffle_epi8(offsets, index), values));
+			}
+
+			return ret;
+		}
+
+		static inline bool supported() {
+			__builtin_cpu_init();
+			return __builtin_cpu_supports("ssse3");
+		}
+#else
+		static inline bool supported() {
+			return false;
+		}
+#endif
+
+		static inline bool accelerate(bool enable) {
+			return vectorized = enable && supported();
+		}
+
+		static inline uint32_t decode(const char* &in, const char* end, char* out, uint32_t space) {
+			uint32_t ret = 0;
+#ifdef BASE64_SSSE3
+			if(vectorized)
+				ret = decodeSsse3(in, end, out, space);
+#endif
+			return ret + decodePortable(in, end, out + ret, space - ret);
+		}
+
+		static inline uint32_t encode(const char* &in, const char* end, char* out, uint32_t space) {
+			uint32_t ret = 0;
+#ifdef BASE64_SSSE3
+			if(vectorized)
+				ret = encodeSsse3(in, end, out, space);
+#endif
+			return ret + encodePortable(in, end, out + ret, space - ret);
+		}
+	};
+
+	template<class Dummy>
+	bool Base64Kernels<Dummy>::vectorized = Base64Kernels<Dummy>::supported();
 }
 
 /**
  * Non-buffered, base64 encoder and decoder suite.
  *
- *  - Size of internal state is one byte only for both the encoder and decoder.
+ *  - Size of internal state is one byte only for the encoder, two for the decoder.
  *  - Supports processing of arbitrarily fragmented data.
  */
 struct Base64 {
@@ -146,99 +332,89 @@ struct Base64 {
 
 public:
 	/**
-	 * Non-buffered base64 decoder.
+	 * Base64 decoder that writes into a caller supplied output buffer.
 	 *
-	 * The user needs to be in CRTP relation to it, and receives
-	 * decoded data via (probably inlined) method call byte-by-byte,
+	 * The input can be fed in arbitrary fragments, and the output can be
+	 * taken in arbitrarily sized blocks, so that decoded data can be put
+	 * directly where it is needed (instead of being passed byte-by-byte).
 	 */
-	template<class Child>
-	struct Parser {
+	class Decoder {
 		/// Internal state.
 		State state;
 
-	protected:
-		/*
-		 * User interface
-		 */
-		inline void byteDecoded(char) {}
+		/// Cleared if an invalid character is found.
+		bool valid;
 
 	public:
 		/// Initialize internal state.
-		void reset() {
+		inline void reset() {
 			state.reset();
+			valid = true;
 		}
 
-		/// Process a block of input data.
-		inline bool parse(const char* buff, uint32_t length) {
-			auto self = static_cast<Child*>(this);
+		/**
+		 * Process input data, until it is consumed or the output is full.
+		 *
+		 * The input pointer and length are updated to reflect the amount
+		 * of data processed. Processing stops at an invalid character,
+		 * which can be checked with _isValid_.
+		 *
+		 * @return The number of bytes written to the output.
+		 */
+		inline uint32_t decode(const char* &buff, uint32_t &length, char* output, uint32_t space) {
+			const char* const end = buff + length;
+			uint32_t ret = 0;
 
 			/*
-			 * Iterate over the input byte-by-byte, unless a full group
+			 * Iterate over the input byte-by-byte, unless full groups
 			 * can be processed at once (handled from inside the loop).
 			 */
-			for(const char* const end = buff + length; buff != end;) {
+			while(buff != end) {
+				// Fast forward if starting a new group, until the first invalid or padding character.
+				if(state.getIdx() == 0) {
+					if(const uint32_t n = detail::Base64Kernels<>::decode(buff, end, output + ret, space - ret)) {
+						ret += n;
+						continue;
+					}
+				}
+
 				// Look up value, for the input character.
 				uint8_t value = detail::Alphabet::reverseLut[(unsigned char)*buff];
 
 				// The value of -1 means that an invalid or padding character was found.
 				if(value == (uint8_t)-1) {
-					if(*buff != '=')
-						return false;
+					if(*buff != '=') {
+						valid = false;
+						break;
+					}
 
 					state.setIdx(0);
 					buff++;
 					continue;
 				}
 
+				// Every character outputs a byte, except for the first in a group.
+				if(state.getIdx() != 0 && ret == space)
+					break;
+
 				switch(state.getIdx()) {
 				case 0:
-					// Fast forward if full a block of data is in reach and starting a new block.
-				    if(end-buff >= 4) {
-				    	// Read and look up all four bytes at once.
-				        uint8_t value2 = detail::Alphabet::reverseLut[(unsigned char)buff[1]];
-				        uint8_t value3 = detail::Alphabet::reverseLut[(unsigned char)buff[2]];
-				        uint8_t value4 = detail::Alphabet::reverseLut[(unsigned char)buff[3]];
-
-				        // Only the third and fourth bytes can be padding.
-				        if(value2 == -1)
-				            return false;
-
-                        self->byteDecoded(value << 2 | value2 >> 4);
-
-                        // The third byte can be padding.
-		                if(value3 == (uint8_t)-1)
-		                    return buff[2] == '=';
-
-                        self->byteDecoded(value2 << 4 | value3 >> 2);
-
-                        // The fourth byte can be padding.
-                        if(value4 == (uint8_t)-1)
-                            return buff[3] == '=';
-
-                        self->byteDecoded(value3 << 6 | value4);
-
-                        // Four byte consumed.
-				        buff += 4;
-				        continue;
-				    }
-
 				    // The first byte in a block can not be output alone.
 					state.setLeftover(value);
 					break;
-
 				case 1:
 					// Second input, first output byte.
-					self->byteDecoded(state.getLeftover() << 2 | value >> 4);
+					output[ret++] = state.getLeftover() << 2 | value >> 4;
 					state.setLeftover(value);
 					break;
 				case 2:
 					// Third input, second output byte.
-					self->byteDecoded(state.getLeftover() << 4 | value >> 2);
+					output[ret++] = state.getLeftover() << 4 | value >> 2;
 					state.setLeftover(value);
 					break;
 				case 3:
 					// Fourth input, third output byte.
-					self->byteDecoded(state.getLeftover() << 6 | value);
+					output[ret++] = state.getLeftover() << 6 | value;
 					break;
 				}
 
@@ -247,31 +423,99 @@ public:
 				buff++;
 			}
 
+			length = end - buff;
+			return ret;
+		}
+
+		/// Check for invalid input.
+		inline bool isValid() {
+			return valid;
+		}
+
+		/// Check correct termination of the input.
+		inline bool done() {
+			return valid && state.getIdx() == 0;
+		}
+	};
+
+	/**
+	 * Non-buffered base64 decoder.
+	 *
+	 * The user needs to be in CRTP relation to it, and receives decoded
+	 * data via (probably inlined) method calls, either in blocks or
+	 * byte-by-byte (the default block handler calls the byte handler).
+	 */
+	template<class Child>
+	struct Parser {
+		/// Internal state.
+		Decoder decoder;
+
+		/// Maximal number of bytes passed to the block handler at once.
+		static constexpr uint32_t blockSize = 96;
+
+	protected:
+		/*
+		 * User interface
+		 */
+		inline void byteDecoded(char) {}
+
+		inline void bytesDecoded(const char* buff, uint32_t length) {
+			for(uint32_t i = 0; i < length; i++)
+				static_cast<Child*>(this)->byteDecoded(buff[i]);
+		}
+
+	public:
+		/// Initialize internal state.
+		void reset() {
+			decoder.reset();
+		}
+
+		/// Process a block of input data.
+		inline bool parse(const char* buff, uint32_t length) {
+			while(length) {
+				char output[blockSize];
+
+				if(const uint32_t n = decoder.decode(buff, length, output, sizeof(output)))
+					static_cast<Child*>(this)->bytesDecoded(output, n);
+
+				if(!decoder.isValid())
+					return false;
+			}
+
 			return true;
 		}
 
 		/// Check correct termination of the input.
 		bool done() {
-			return state.getIdx() == 0;
+			return decoder.done();
 		}
 	};
 
 	/**
 	 * Non-buffered base64 encoder.
 	 *
-	 * The user needs to be in CRTP relation to it, and receives
-	 * encoded data via (probably inlined) method call byte-by-byte,
+	 * The user needs to be in CRTP relation to it, and receives encoded
+	 * data via (probably inlined) method calls, either in blocks or
+	 * byte-by-byte (the default block handler calls the byte handler).
 	 */
 	template<class Child>
 	struct Formater {
 			State state;
 
+		/// Maximal number of characters passed to the block handler at once.
+		static constexpr uint32_t blockSize = 128;
+
 	protected:
 		/*
 		 * User interface
 		 */
 		inline void byteEncoded(char ) {}
 
+		inline void bytesEncoded(const char* buff, uint32_t length) {
+			for(uint32_t i = 0; i < length; i++)
+				static_cast<Child*>(this)->byteEncoded(buff[i]);
+		}
+
 	public:
 		/// Initialize internal state.
 		void reset() {
@@ -283,42 +527,39 @@ public:
 			auto self = static_cast<Child*>(this);
 
 			/*
-			 * Iterate over the input byte-by-byte, unless a full group
+			 * Iterate over the input byte-by-byte, unless full groups
 			 * can be processed at once (handled from inside the loop).
 			 */
 			for(const char* const end = buff + length; buff != end;) {
 				uint8_t value = (unsigned char)*buff;
+				char output[blockSize];
 
 				switch(state.getIdx()) {
 				case 0:
-					// Fast forward if full a block of data is in reach and starting a new block.
-                    if(end-buff >= 3) {
-                       uint8_t value2 = buff[1];
-                       uint8_t value3 = buff[2];
-
-                       self->byteEncoded(detail::Alphabet::forwardLut[value >> 2]);
-                       self->byteEncoded(detail::Alphabet::forwardLut[value2 >> 4 | (value & 0x3) << 4]);
-                       self->byteEncoded(detail::Alphabet::forwardLut[value3 >> 6 | (value2 & 0xf )<< 2]);
-                       self->byteEncoded(detail::Alphabet::forwardLut[value3 & 0x3f]);
-                       buff += 3;
-                       continue;
-                    }
-
-                    // One byte in, one out, some data stored in leftover, move on to next stage.
-					self->byteEncoded(detail::Alphabet::forwardLut[value >> 2]);
+					// Fast forward if full groups of data are in reach and starting a new one.
+					if(const uint32_t n = detail::Base64Kernels<>::encode(buff, end, output, sizeof(output))) {
+						self->bytesEncoded(output, n);
+						continue;
+					}
+
+					// One byte in, one out, some data stored in leftover, move on to next stage.
+					output[0] = detail::Alphabet::forwardLut[value >> 2];
+					self->bytesEncoded(output, 1);
 					state.setLeftover(value & 0x03);
 					state.setIdx(1);
 					break;
 				case 1:
 					// Second byte in, second out, stored data replaced in leftover, move on to next stage.
-					self->byteEncoded(detail::Alphabet::forwardLut[value >> 4 | state.getLeftover() << 4]);
+					output[0] = detail::Alphabet::forwardLut[value >> 4 | state.getLeftover() << 4];
+					self->bytesEncoded(output, 1);
 					state.setLeftover(value & 0x0f);
 					state.setIdx(2);
 					break;
 				case 2:
 					// Third byte in, last two of the group out, move back to initial state.
-					self->byteEncoded(detail::Alphabet::forwardLut[value >> 6 | state.getLeftover() << 2]);
-					self->byteEncoded(detail::Alphabet::forwardLut[value & 0x3f]);
+					output[0] = detail::Alphabet::forwardLut[value >> 6 | state.getLeftover() << 2];
+					output[1] = detail::Alphabet::forwardLut[value & 0x3f];
+					self->bytesEncoded(output, 2);
 					state.setIdx(0);
 					break;
 				}
@@ -332,17 +573,18 @@ public:
 			auto self = static_cast<Child*>(this);
 
 			switch(state.getIdx()) {
-			case 1:
+			case 1: {
 				// Only one byte in the input group, flush the rest of it, and add padding.
-				self->byteEncoded(detail::Alphabet::forwardLut[state.getLeftover() << 4]);
-				self->byteEncoded('=');
-				self->byteEncoded('=');
+				const char output[] = {detail::Alphabet::forwardLut[state.getLeftover() << 4], '=', '='};
+				self->bytesEncoded(output, sizeof(output));
 				break;
-			case 2:
+			}
+			case 2: {
 				// Only two bytes in the input group, flush the rest of it, and add padding.
-				self->byteEncoded(detail::Alphabet::forwardLut[state.getLeftover() << 2]);
-				self->byteEncoded('=');
+				const char output[] = {detail::Alphabet::forwardLut[state.getLeftover() << 2], '='};
+				self->bytesEncoded(output, sizeof(output));
 				break;
+			}
 			default:
 				// Nothing to do for a finished input group of three.
 				break;
@@ -350,6 +592,16 @@ public:
 		}
 	};
 
+	/**
+	 * Selects the encoder and decoder kernels.
+	 *
+	 * The vectorized ones are used if _enable_ is set and the CPU supports
+	 * them, returns true if they are in use. Only needed for testing and
+	 * benchmarking, by default the best available kernels are selected.
+	 */
+	static inline bool accelerate(bool enable) {
+		return detail::Base64Kernels<>::accelerate(enable);
+	}
 };
 
 
@@ -57,6 +57,37 @@ public:
 		}
 	}
 
+	/**
+	 * Process a block of data ignoring the case of the letters.
+	 *
+	 * Same as progressWithMatching, but the uppercase letters of the
+	 * input are matched against the lowercase ones of _str_, which
+	 * is expected not to contain uppercase letters itself.
+	 */
+	void progressWithMatchingNoCase(const char* str, const char* buff, uint32_t length)
+	{
+		if(idx == -1u)
+			return;
+
+		if(idx + length > strlen(str))
+			idx = -1u;
+		else {
+			for(uint32_t i = 0; i < length; i++) {
+				char c = buff[i];
+
+				if('A' <= c && c <= 'Z')
+					c += 'a' - 'A';
+
+				if(c != str[idx + i]) {
+					idx = -1u;
+					return;
+				}
+			}
+
+			idx += length;
+		}
+	}
+
 	/// Initialize internal state.
 	void reset() {
 		idx = 0;
@@ -0,0 +1,206 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2017 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+#ifndef CONTENTDIGEST_H_
+#define CONTENTDIGEST_H_
+
+#include "Base64.h"
+#include "KvParser.h"
+#include "SplitParser.h"
+
+#include "md5/md5.h"
+
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * Integrity check of a request body.
+ *
+ * It takes the MD5 hash of the body that the client sends in the Content-MD5
+ * (RFC 1864) or the Digest (RFC 3230) header field. The body is then hashed
+ * as it is received, so the stored content does not have to be read again.
+ *
+ * Both header field parsers use the protocol of the ones in HttpLogic. They
+ * are called with a null pointer and non-zero length before the value, then
+ * with the data, and finally with a null pointer and zero length after the
+ * value. If both fields are present, the one that comes last is checked.
+ */
+class ContentDigest: Splitter<ContentDigest>, KvParser<ContentDigest> {
+	friend Splitter<ContentDigest>;
+	friend KvParser<ContentDigest>;
+
+	static constexpr uint8_t hashLength = 16;
+	static constexpr uint8_t invalid = 0xff;
+	static constexpr const char* md5Key() {return "md5";}
+
+	enum class State: uint8_t {
+		None, Expected, Invalid
+	};
+
+	State state;
+
+	/// Number of decoded bytes of the expected hash (or _invalid_).
+	uint8_t decoded;
+
+	/// Number of matched characters of the algorithm name (or _invalid_).
+	uint8_t keyIdx;
+
+	/// Set while the value of the MD5 instance of a Digest field is parsed.
+	bool md5Value;
+
+	Base64::Decoder decoder;
+	unsigned char expected[hashLength];
+	MD5_CTX context;
+
+	inline void startDecoding() {
+		decoder.reset();
+		decoded = 0;
+	}
+
+	// The hash is decoded in place, input left over means it is too long.
+	inline void decode(const char* buff, uint32_t length) {
+		if(decoded != invalid) {
+			decoded += decoder.decode(buff, length, (char*)expected + decoded, hashLength - decoded);
+
+			if(length || !decoder.isValid())
+				decoded = invalid;
+		}
+	}
+
+	inline void finishDecoding() {
+		if(decoded == hashLength && decoder.done()) {
+			state = State::Expected;
+			MD5_Init(&context);
+		} else
+			state = State::Invalid;
+	}
+
+	// KvParser, the algorithm names are case insensitive.
+	inline void parseKey(const char* buff, unsigned int length) {
+		while(length-- && keyIdx != invalid) {
+			char c = *buff++;
+
+			if('A' <= c && c <= 'Z')
+				c += 'a' - 'A';
+
+			keyIdx = (keyIdx < strlen(md5Key()) && c == md5Key()[keyIdx]) ? keyIdx + 1 : invalid;
+		}
+	}
+
+	inline void keyDone() {
+		md5Value = keyIdx == strlen(md5Key());
+		keyIdx = 0;
+
+		if(md5Value)
+			startDecoding();
+	}
+
+	inline void parseValue(const char* buff, unsigned int length) {
+		if(md5Value)
+			decode(buff, length);
+	}
+
+	inline void valueDone() {
+		if(md5Value) {
+			finishDecoding();
+			md5Value = false;
+		}
+	}
+
+	// Splitter
+	inline void parseField(const char* buff, unsigned int length) {
+		KvParser<ContentDigest>::progressWithKv(buff, length);
+	}
+
+	inline void fieldDone() {
+		KvParser<ContentDigest>::kvDone();
+		KvParser<ContentDigest>::reset();
+	}
+
+public:
+	/// Initialize internal state (no hash expected).
+	inline void reset() {
+		state = State::None;
+	}
+
+	/// Parser for the value of the Content-MD5 header field.
+	inline void parseContentMd5(const char* buff, uint32_t length) {
+		if(!buff) {
+			if(length)
+				startDecoding();
+			else
+				finishDecoding();
+		} else
+			decode(buff, length);
+	}
+
+	/// Parser for the value of the Digest header field, instances other than MD5 are ignored.
+	inline void parseDigest(const char* buff, uint32_t length) {
+		if(!buff) {
+			if(length) {
+				Splitter<ContentDigest>::reset();
+				KvParser<ContentDigest>::reset();
+				keyIdx = 0;
+				md5Value = false;
+			} else
+				Splitter<ContentDigest>::splittingDone();
+		} else
+			Splitter<ContentDigest>::progressWithSplitting(buff, length);
+	}
+
+	/// True if a header field could not be parsed.
+	inline bool isMalformed() {
+		return state == State::Invalid;
+	}
+
+	/// Hash the next block of the body (if there is anything to check).
+	inline void update(const char* buff, uint32_t length) {
+		if(state == State::Expected)
+			MD5_Update(&context, buff, length);
+	}
+
+	/// Check the hash of the whole body, true if it matches or there is nothing to check.
+	inline bool matches() {
+		if(state != State::Expected)
+			return true;
+
+		unsigned char result[hashLength];
+		MD5_Final(result, &context);
+		state = State::None;
+		return memcmp(result, expected, hashLength) == 0;
+	}
+};
+
+/**
+ * Storage for a ContentDigest if it is _enabled_, the disabled one has
+ * no state and accepts everything.
+ */
+template<bool enabled>
+struct OptionalContentDigest: ContentDigest {};
+
+template<>
+struct OptionalContentDigest<false> {
+	inline void reset() {}
+	inline void parseContentMd5(const char* buff, uint32_t length) {}
+	inline void parseDigest(const char* buff, uint32_t length) {}
+	inline bool isMalformed() { return false; }
+	inline void update(const char* buff, uint32_t length) {}
+	inline bool matches() { return true; }
+};
+
+#endif /* CONTENTDIGEST_H_ */
@@ -0,0 +1,714 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2017 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+#ifndef DAVLOCK_H_
+#define DAVLOCK_H_
+
+#include "UXml.h"
+#include "TemporaryStringBuffer.h"
+
+#include "md5/md5.h"
+
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * Running hash of a resource path.
+ *
+ * Resources are never stored by name in the lock table, only the 32-bit
+ * FNV-1a hash of their path is, which is computed on the fly while the
+ * path elements pass by. The _covers_ member marks the depth-infinity locks
+ * on the ancestor collections (by their position in the lock table).
+ *
+ * The hashes of the outermost ancestors are recorded too, so that the locks
+ * on the members of a collection can be found. Below the recorded levels
+ * the resources are conservatively taken to be members of any collection
+ * that they share the recorded ancestors with.
+ */
+struct DavLockPath {
+	static constexpr uint32_t initial = 0x811c9dc5;
+	static constexpr uint32_t prime = 0x01000193;
+
+	/// Number of the outermost ancestors recorded.
+	static constexpr uint32_t maxAncestors = 4;
+
+	/// Hash of the path processed so far.
+	uint32_t hash;
+
+	/// Deep locks on the ancestors, bit _i_ stands for the entry at index _i_ of the lock table.
+	uint32_t covers;
+
+	/// Number of path elements (the root is at level zero).
+	uint32_t level;
+
+	/// Hashes of the outermost ancestors, the one at index _i_ is at level _i_.
+	uint32_t ancestors[maxAncestors];
+
+	/// Initialize internal state.
+	inline void reset() {
+		hash = initial;
+		covers = 0;
+		level = 0;
+	}
+
+	/// Process a block of path data.
+	inline void update(const char* at, uint32_t length) {
+		while(length--)
+			hash = (hash ^ (uint8_t)*at++) * prime;
+	}
+
+	/// Account for an element separator.
+	inline void separator() {
+		if(level < maxAncestors)
+			ancestors[level] = hash;
+
+		level++;
+		hash = (hash ^ (uint8_t)'/') * prime;
+	}
+
+	/// Check if the resource with the ancestors at the _level_ is a member of the collection (at any depth).
+	inline bool contains(uint32_t level, const uint32_t* ancestors) const {
+		if(level <= this->level)
+			return false;
+
+		if(this->level < maxAncestors)
+			return ancestors[this->level] == hash;
+
+		for(uint32_t i = 0; i < maxAncestors; i++)
+			if(ancestors[i] != this->ancestors[i])
+				return false;
+
+		return true;
+	}
+};
+
+/**
+ * Non-buffered lock token collector.
+ *
+ * Scans arbitrarily fragmented header data (If and Lock-Token headers)
+ * for tokens in the _opaquelocktoken:<hex>_ format issued by the lock
+ * table, and stores the numeric value of the first _n_ ones found.
+ */
+template<unsigned int n>
+class DavLockTokenParser {
+	static constexpr const char* prefix = "opaquelocktoken:";
+	static constexpr uint32_t prefixLength = 16;
+
+	/// Number of matched prefix characters, or digits if larger than the prefix length.
+	uint32_t idx;
+
+	/// The value of the token currently being parsed.
+	uint32_t value;
+
+	/// Number of tokens stored.
+	uint32_t count;
+
+	/// Token storage.
+	uint32_t tokens[n];
+
+	inline void store() {
+		if(idx > prefixLength && value && count < n)
+			tokens[count++] = value;
+
+		idx = 0;
+	}
+
+public:
+	/// Initialize internal state, drop all collected tokens.
+	inline void reset() {
+		idx = 0;
+		count = 0;
+	}
+
+	/// Process a block of header data.
+	inline void parseTokens(const char* at, uint32_t length) {
+		while(length--) {
+			const char c = *at++;
+
+			if(idx < prefixLength) {
+				if(c == prefix[idx])
+					idx++;
+				else
+					idx = (c == prefix[0]) ? 1 : 0;
+
+				value = 0;
+			} else {
+				uint8_t digit;
+
+				if('0' <= c && c <= '9')
+					digit = c - '0';
+				else if('a' <= c && c <= 'f')
+					digit = c - 'a' + 10;
+				else if('A' <= c && c <= 'F')
+					digit = c - 'A' + 10;
+				else {
+					store();
+
+					if(c == prefix[0])
+						idx = 1;
+
+					continue;
+				}
+
+				value = value << 4 | digit;
+				idx++;
+			}
+		}
+	}
+
+	/// Finalize processing of a header field.
+	inline void done() {
+		store();
+	}
+
+	/// Number of collected tokens.
+	inline uint32_t getCount() const {
+		return count;
+	}
+
+	/// Collected token accessor.
+	inline uint32_t getToken(uint32_t i) const {
+		return tokens[i];
+	}
+
+	/// Check if the token is among the collected ones.
+	inline bool contains(uint32_t token) const {
+		for(uint32_t i = 0; i < count; i++)
+			if(tokens[i] == token)
+				return true;
+
+		return false;
+	}
+};
+
+/**
+ * Non-buffered parser for the Timeout header.
+ *
+ * Takes the first _Second-<n>_ or _Infinite_ entry of the list, where
+ * infinite is represented as the largest possible value.
+ */
+class DavLockTimeoutParser {
+	static constexpr const char* second = "Second-";
+	static constexpr const char* infinite = "Infinite";
+
+	enum class State: uint8_t {Name, Seconds, Infinite, Done} state;
+	uint32_t idx;
+	uint32_t value;
+	bool valid;
+
+public:
+	/// Initialize internal state.
+	inline void reset() {
+		state = State::Name;
+		idx = 0;
+		value = 0;
+		valid = false;
+	}
+
+	/// Process a block of header data.
+	inline void parseTimeout(const char* at, uint32_t length) {
+		for(; length-- && state != State::Done; at++) {
+			const char c = *at;
+
+			switch(state) {
+			case State::Name:
+				if(c == ' ' && !idx)
+					break;
+
+				if(c == second[idx]) {
+					if(!second[++idx])
+						state = State::Seconds;
+				} else if(c == infinite[idx] && strncmp(second, infinite, idx) == 0) {
+					state = State::Infinite;
+					idx++;
+				} else
+					state = State::Done;
+
+				break;
+			case State::Infinite:
+				if(c != infinite[idx])
+					state = State::Done;
+				else if(!infinite[++idx]) {
+					value = -1u;
+					valid = true;
+					state = State::Done;
+				}
+				break;
+			case State::Seconds:
+				if('0' <= c && c <= '9') {
+					const uint32_t next = value * 10 + (c - '0');
+					value = (next / 10 == value) ? next : -1u;
+					valid = true;
+				} else
+					state = State::Done;
+				break;
+			default:
+				break;
+			}
+		}
+	}
+
+	/// Timeout value in seconds, or zero if the header is not valid.
+	inline uint32_t getSeconds() const {
+		return valid ? value : 0;
+	}
+};
+
+/**
+ * Fixed capacity WebDAV lock table.
+ *
+ * Holds write locks identified by the path hash of the locked resource
+ * and a numeric token unique to the lock. A token of zero marks a free
+ * entry, so a statically allocated (zero initialized) instance is empty.
+ *
+ * The tokens are the truncated MD5 of a secret seed, a counter and the
+ * time of creation, so that they can not be guessed from the ones seen
+ * before. They are 32-bit values sent in the _opaquelocktoken:<hex>_ form,
+ * which deliberately deviates from RFC 4918 that asks for a UUID there,
+ * in order to keep the entries and the token parser small.
+ *
+ * Time is measured in seconds by the user supplied clock, expiration
+ * is checked using wrapping arithmetic.
+ */
+template<unsigned int size>
+class DavLockTable {
+	static_assert(size <= 32, "Too many locks (the deep locked ancestors are tracked in a 32-bit mask)");
+
+public:
+	/// Result of a lock acquisition attempt.
+	enum class Result: uint8_t {Ok, Conflict, Full};
+
+	/// Lock entry.
+	struct Lock {
+		uint32_t token;
+		uint32_t path;
+		uint32_t level;
+		uint32_t ancestors[DavLockPath::maxAncestors];
+		uint32_t expiry;
+		uint32_t timeout;
+		bool exclusive;
+		bool deep;
+	};
+
+private:
+	/// Lock storage.
+	Lock locks[size];
+
+	/// Token generator secret.
+	uint32_t seed;
+
+	/// Number of tokens generated.
+	uint32_t counter;
+
+	static inline bool isExpired(const Lock& lock, uint32_t now) {
+		return (int32_t)(lock.expiry - now) <= 0;
+	}
+
+	inline bool isActive(const Lock& lock, uint32_t now) {
+		return lock.token && !isExpired(lock, now);
+	}
+
+	/// Check if the lock is on the resource itself.
+	static inline bool isOn(const Lock& lock, const DavLockPath& path) {
+		return lock.path == path.hash && lock.level == path.level;
+	}
+
+	/// Check if the lock at the index applies to the resource (directly or through a deep locked ancestor).
+	inline bool applies(uint32_t i, const DavLockPath& path) {
+		return isOn(locks[i], path) || (path.covers & (1u << i));
+	}
+
+	/**
+	 * Check if the _outer_ lock applies to the resource of the _inner_ one,
+	 * which is a member of the collection at the _path_.
+	 *
+	 * Below the recorded ancestors it can not be decided if a lock on another
+	 * member applies, then it is taken not to, so that only a missing token
+	 * can be assumed this way.
+	 */
+	inline bool protects(uint32_t outer, const Lock& inner, const DavLockPath& path) {
+		const Lock& lock = locks[outer];
+
+		if(lock.path == inner.path && lock.level == inner.level)
+			return true;
+
+		if(!lock.deep)
+			return false;
+
+		if(applies(outer, path))
+			return true;
+
+		return lock.level < inner.level && lock.level < DavLockPath::maxAncestors
+				&& inner.ancestors[lock.level] == lock.path;
+	}
+
+	/**
+	 * Check if the lock on a member of the collection at the _path_ is passed
+	 * by the tokens. An exclusive one needs its own token, a shared one the
+	 * token of any shared lock that applies to the resource of the member.
+	 */
+	template<class Tokens>
+	inline bool isMemberPassed(const Lock& lock, const DavLockPath& path, const Tokens& tokens, uint32_t now) {
+		if(tokens.contains(lock.token))
+			return true;
+
+		if(lock.exclusive)
+			return false;
+
+		for(uint32_t i = 0; i < size; i++)
+			if(isActive(locks[i], now) && !locks[i].exclusive && tokens.contains(locks[i].token) && protects(i, lock, path))
+				return true;
+
+		return false;
+	}
+
+	inline uint32_t newToken(uint32_t now) {
+		while(true) {
+			const uint32_t input[] = {seed, ++counter, now};
+			unsigned char digest[16];
+			MD5_CTX ctx;
+
+			MD5_Init(&ctx);
+			MD5_Update(&ctx, input, sizeof(input));
+			MD5_Final(digest, &ctx);
+
+			const uint32_t token = (uint32_t)digest[0] << 24 | (uint32_t)digest[1] << 16 | (uint32_t)digest[2] << 8 | digest[3];
+
+			if(!token)
+				continue;
+
+			bool unique = true;
+			for(const Lock& lock: locks)
+				if(lock.token == token)
+					unique = false;
+
+			if(unique)
+				return token;
+		}
+	}
+
+public:
+	/**
+	 * Drop all locks, and seed the token generator.
+	 *
+	 * The seed is optional (the state is zero initialized), but without
+	 * a random one the tokens depend only on the time and the count of
+	 * the locks created, which makes them predictable.
+	 */
+	inline void reset(uint32_t seed = 0) {
+		for(Lock& lock: locks)
+			lock.token = 0;
+
+		this->seed = seed;
+		counter = 0;
+	}
+
+	/**
+	 * Try to create a new lock.
+	 *
+	 * The _path_ is the resource as recorded by the _DavLockPath_ during
+	 * path processing. A depth-infinity lock also conflicts with the locks
+	 * on the members of the collection.
+	 */
+	inline Result acquire(const DavLockPath& path, bool exclusive, bool deep,
+			uint32_t timeout, uint32_t now, const Lock* &result)
+	{
+		Lock* free = nullptr;
+
+		for(uint32_t i = 0; i < size; i++) {
+			Lock& lock = locks[i];
+
+			if(!isActive(lock, now)) {
+				if(!free)
+					free = &lock;
+
+				continue;
+			}
+
+			if(applies(i, path) || (deep && path.contains(lock.level, lock.ancestors)))
+				if(exclusive || lock.exclusive)
+					return Result::Conflict;
+		}
+
+		if(!free)
+			return Result::Full;
+
+		free->token = newToken(now);
+		free->path = path.hash;
+		free->level = path.level;
+		memcpy(free->ancestors, path.ancestors, sizeof(free->ancestors));
+		free->timeout = timeout;
+		free->expiry = now + timeout;
+		free->exclusive = exclusive;
+		free->deep = deep;
+		result = free;
+		return Result::Ok;
+	}
+
+	/// Extend the expiration time of an existing lock, returns null if not found.
+	inline const Lock* refresh(uint32_t token, const DavLockPath& path, uint32_t timeout, uint32_t now)
+	{
+		for(uint32_t i = 0; i < size; i++) {
+			Lock& lock = locks[i];
+
+			if(lock.token == token && isActive(lock, now) && applies(i, path)) {
+				lock.timeout = timeout;
+				lock.expiry = now + timeout;
+				return &lock;
+			}
+		}
+
+		return nullptr;
+	}
+
+	/// Remove a lock, returns false if not found.
+	inline bool release(uint32_t token, const DavLockPath& path, uint32_t now)
+	{
+		for(uint32_t i = 0; i < size; i++) {
+			Lock& lock = locks[i];
+
+			if(lock.token == token && isActive(lock, now) && applies(i, path)) {
+				lock.token = 0;
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	/**
+	 * Mark the depth-infinity locks on the collection (regardless of expiration),
+	 * to be called before the separator of the next path element is processed.
+	 */
+	inline void enterCollection(DavLockPath& path)
+	{
+		for(uint32_t i = 0; i < size; i++)
+			if(locks[i].token && locks[i].deep && isOn(locks[i], path))
+				path.covers |= 1u << i;
+	}
+
+	/**
+	 * Check if modification of the resource is allowed.
+	 *
+	 * An exclusive lock that applies to the resource needs to be identified
+	 * by one of the submitted tokens, while the shared ones are passed if any
+	 * one of them is.
+	 */
+	template<class Tokens>
+	inline bool permits(const DavLockPath& path, const Tokens& tokens, uint32_t now)
+	{
+		bool shared = false, passed = false;
+
+		for(uint32_t i = 0; i < size; i++) {
+			if(!isActive(locks[i], now) || !applies(i, path))
+				continue;
+
+			if(tokens.contains(locks[i].token))
+				passed = true;
+			else if(locks[i].exclusive)
+				return false;
+			else
+				shared = true;
+		}
+
+		return passed || !shared;
+	}
+
+	/**
+	 * Check if removal of the resource is allowed (by DELETE or MOVE).
+	 *
+	 * Besides the locks that apply to the resource (see _permits_), the
+	 * ones on the members of a collection need to be passed as well.
+	 */
+	template<class Tokens>
+	inline bool permitsRemoval(const DavLockPath& path, const Tokens& tokens, uint32_t now)
+	{
+		if(!permits(path, tokens, now))
+			return false;
+
+		for(uint32_t i = 0; i < size; i++)
+			if(isActive(locks[i], now) && !applies(i, path) && path.contains(locks[i].level, locks[i].ancestors))
+				if(!isMemberPassed(locks[i], path, tokens, now))
+					return false;
+
+		return true;
+	}
+};
+
+/**
+ * Parser for XML WebDAV lock requests.
+ *
+ * It uses the UXml low-level XML parser, in the same fashion as the
+ * _DavRequestParser_, to find out the scope of the requested lock.
+ * Only write locks are supported, the owner information is ignored.
+ * A request without a body is a lock refresh request.
+ */
+template<unsigned int stackSize>
+class DavLockRequestParser: UXml<DavLockRequestParser<stackSize>, stackSize> {
+	typedef UXml<DavLockRequestParser<stackSize>, stackSize> Super;
+	friend Super;
+
+	/// The XML hierarchy level being processed.
+	enum class State: uint8_t {Root, Info, Scope, Type, Done};
+
+	static constexpr const char* lockinfo = "lockinfo";
+	static constexpr const char* lockscope = "lockscope";
+	static constexpr const char* locktype = "locktype";
+	static constexpr const char* exclusive = "exclusive";
+	static constexpr const char* shared = "shared";
+	static constexpr const char* write = "write";
+
+	/// Tag name buffer.
+	TemporaryStringBuffer<32> temp;
+
+	/// Nesting level of elements, that are not interpreted.
+	uint16_t ignoredDepth;
+
+	State state;
+	bool isBad;
+	bool isEmpty;
+	bool isExclusive;
+	bool isWrite;
+
+	/*
+	 * UXml parser callback methods.
+	 */
+	inline void onTagStart() {
+		temp.clear();
+	}
+
+	inline void onTagName(const char* buff, uint32_t len) {
+		if(!temp.save(buff, len))
+			isBad = true;
+	}
+
+	inline void onContentStart();
+	inline void onCloseTag();
+
+	inline void onContent(const char* buff, uint32_t len) {}
+	inline void onTagNameEnd() {}
+	inline void onAttributeNameStart() {}
+	inline void onAttributeName(const char* buff, uint32_t len) {}
+	inline void onAttributeNameEnd() {}
+	inline void onAttributeValueStart() {}
+	inline void onAttributeValue(const char* buff, uint32_t len) {}
+	inline void onAttributeValueEnd() {}
+
+public:
+	/// Initialize internal state.
+	inline void reset() {
+		state = State::Root;
+		ignoredDepth = 0;
+		isBad = false;
+		isEmpty = true;
+		isExclusive = true;
+		isWrite = false;
+		Super::reset();
+	}
+
+	/// Process WebDAV XML request data. Returns false on error.
+	inline bool parseLockRequest(const char* buff, uint32_t len) {
+		if(isBad || !Super::parseXml(buff, len))
+			isBad = true;
+
+		return !isBad;
+	}
+
+	/// Finalize processing (should be called when end of data is reached). Returns false on error.
+	inline bool done() {
+		if(isBad || !Super::done() || (!isEmpty && !isWrite))
+			isBad = true;
+
+		return !isBad;
+	}
+
+	/// Returns true if no lockinfo element was found (ie. it is a refresh request).
+	inline bool isRefresh() {
+		return isEmpty;
+	}
+
+	/// Returns true for exclusive lock requests and false for shared ones.
+	inline bool isExclusiveLock() {
+		return isExclusive;
+	}
+};
+
+template<unsigned int stackSize>
+inline void DavLockRequestParser<stackSize>::onContentStart()
+{
+	temp.terminate();
+	const char* name = strchr(temp.data(), ':');
+	name = name ? name + 1 : temp.data();
+
+	if(ignoredDepth) {
+		ignoredDepth++;
+		return;
+	}
+
+	switch(state) {
+	case State::Root:
+		if(strcmp(name, lockinfo) == 0) {
+			isEmpty = false;
+			state = State::Info;
+		} else
+			isBad = true;
+		break;
+	case State::Info:
+		if(strcmp(name, lockscope) == 0)
+			state = State::Scope;
+		else if(strcmp(name, locktype) == 0)
+			state = State::Type;
+		else
+			ignoredDepth++;
+		break;
+	case State::Scope:
+		if(strcmp(name, exclusive) == 0)
+			isExclusive = true;
+		else if(strcmp(name, shared) == 0)
+			isExclusive = false;
+		else
+			isBad = true;
+
+		ignoredDepth++;
+		break;
+	case State::Type:
+		if(strcmp(name, write) == 0)
+			isWrite = true;
+		else
+			isBad = true;
+
+		ignoredDepth++;
+		break;
+	default:
+		isBad = true;
+		break;
+	}
+}
+
+template<unsigned int stackSize>
+inline void DavLockRequestParser<stackSize>::onCloseTag()
+{
+	if(ignoredDepth)
+		ignoredDepth--;
+	else if(state == State::Scope || state == State::Type)
+		state = State::Info;
+	else if(state == State::Info)
+		state = State::Done;
+}
+
+#endif /* DAVLOCK_H_ */
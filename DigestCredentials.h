@@ -0,0 +1,490 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2017 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+#ifndef DIGESTCREDENTIALS_H_
+#define DIGESTCREDENTIALS_H_
+
+#include "ConstantStringMatcher.h"
+
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * User name and the corresponding A1 hash (ie. the hex encoded
+ * hash of the _username:realm:password_ string).
+ */
+struct DigestCredential {
+	const char* username;
+	const char* ha1;
+
+	constexpr DigestCredential(const char* username, const char* ha1): username(username), ha1(ha1) {}
+};
+
+/*
+ * Credential stores provide a _Matcher_ type, that looks up the user
+ * name while it is being received:
+ *
+ *  - _reset_ is called before the user name,
+ *  - _progress_ with the fragments of it,
+ *  - _done_ after the last fragment, after which
+ *  - _username_ and _ha1_ return the matching entry (or null if there is none).
+ */
+
+/**
+ * Single user, with the name and the hash taken from the _username_
+ * and _RFC2069_A1_ members of the _Params_ type.
+ */
+template<class Params>
+struct SingleCredential {
+	class Matcher {
+		static constexpr bool hasUsername = Params::username != nullptr;
+		ConstantStringMatcher matcher;
+		bool matched;
+	public:
+		inline void reset() {
+			matcher.reset();
+			matched = false;
+		}
+
+		inline void progress(const char* buff, uint32_t length) {
+			if(hasUsername)
+				matcher.progressWithMatching(Params::username, buff, length);
+		}
+
+		inline void done() {
+			matched = hasUsername && matcher.matches(Params::username);
+		}
+
+		inline const char* username() {
+			return matched ? Params::username : nullptr;
+		}
+
+		inline const char* ha1() {
+			return matched ? Params::RFC2069_A1 : nullptr;
+		}
+	};
+};
+
+/**
+ * Runtime provided table of users.
+ *
+ * The _Source_ type needs to have a static _credentials(uint32_t &count)_
+ * method, that returns the entries sorted by the user name (in _strcmp_ order).
+ * It is called at the start of every request, so the table can be changed
+ * between requests.
+ *
+ * The range of entries that start with the already received part of the
+ * name is narrowed down by a binary search for every received character,
+ * so the name does not need to be stored.
+ */
+template<class Source>
+struct SortedCredentials {
+	class Matcher {
+		const DigestCredential* table;
+		uint32_t first, last, position;
+		bool matched;
+
+		/// First entry in the range, which has a character greater (or equal, if not _inclusive_) at the current position.
+		inline uint32_t search(uint32_t low, uint32_t high, unsigned char c, bool inclusive) {
+			while(low < high) {
+				const uint32_t mid = low + (high - low) / 2;
+				const unsigned char k = table[mid].username[position];
+
+				if(k < c || (inclusive && k == c))
+					low = mid + 1;
+				else
+					high = mid;
+			}
+
+			return low;
+		}
+
+	public:
+		inline void reset() {
+			table = Source::credentials(last);
+			first = position = 0;
+			matched = false;
+		}
+
+		inline void progress(const char* buff, uint32_t length) {
+			while(length-- && first < last) {
+				const unsigned char c = *buff++;
+
+				if(!c) {
+					first = last;
+				} else {
+					first = search(first, last, c, false);
+					last = search(first, last, c, true);
+					position++;
+				}
+			}
+		}
+
+		inline void done() {
+			matched = first < last && !table[first].username[position];
+		}
+
+		inline const char* username() {
+			return matched ? table[first].username : nullptr;
+		}
+
+		inline const char* ha1() {
+			return matched ? table[first].ha1 : nullptr;
+		}
+	};
+};
+
+/**
+ * Compile-time generation of the perfect hash table for StaticCredentials.
+ *
+ * It is a two level (FKS) scheme: the users are distributed into as many
+ * buckets as there are users by the FNV-1a hash of their name. Every bucket
+ * has as many slots as the square of the number of users in it and its own
+ * seed, that is chosen so that the users of the bucket get distinct slots.
+ * The total number of slots is not bounded by the scheme, only its expected
+ * value is less than twice the number of users (eg. a table of 400 users
+ * can take 840 slots), Build::slots gives the actual size of the table.
+ *
+ * The tables are built in stages, every stage is an array of constants
+ * computed (by parameter pack expansion) from the previous ones. The users
+ * are ordered by bucket with a merge sort (one stage per pass) and the
+ * offsets of the buckets are computed with a parallel prefix sum, so that
+ * every element of every stage can be computed in logarithmic time.
+ */
+namespace DigestCredentialTable {
+	constexpr uint32_t maxSeed = 254;
+
+	template<uint32_t... i> struct Indices {};
+
+	template<class, class> struct Concat;
+
+	template<uint32_t... a, uint32_t... b>
+	struct Concat<Indices<a...>, Indices<b...> > {
+		typedef Indices<a..., (sizeof...(a) + b)...> Type;
+	};
+
+	template<uint32_t n> struct Sequence {
+		typedef typename Concat<typename Sequence<n / 2>::Type, typename Sequence<n - n / 2>::Type>::Type Type;
+	};
+
+	template<> struct Sequence<0> { typedef Indices<> Type; };
+	template<> struct Sequence<1> { typedef Indices<0> Type; };
+
+	constexpr uint32_t fnv(const char* str, uint32_t hash = 2166136261u) {
+		return *str ? fnv(str + 1, (hash ^ (unsigned char)*str) * 16777619u) : hash;
+	}
+
+	constexpr uint32_t scramble(uint32_t x) {
+		return ((x ^ (x >> 16)) * 0x85ebca6bu) ^ (((x ^ (x >> 16)) * 0x85ebca6bu) >> 13);
+	}
+
+	constexpr uint32_t mix(uint32_t hash, uint32_t seed) {
+		return scramble(hash ^ seed * 0x9e3779b9u);
+	}
+
+	constexpr uint32_t length(const char* str) {
+		return *str ? 1 + length(str + 1) : 0;
+	}
+
+	constexpr uint32_t larger(uint32_t a, uint32_t b) {
+		return a > b ? a : b;
+	}
+
+	constexpr uint32_t smaller(uint32_t a, uint32_t b) {
+		return a < b ? a : b;
+	}
+
+	/// Number of doubling steps needed to cover _n_ elements.
+	constexpr uint32_t steps(uint32_t n, uint32_t l = 0) {
+		return ((1u << l) >= n) ? l : steps(n, l + 1);
+	}
+
+	template<class Input> struct Build;
+
+	/// Sort keys (bucket * count + user index) in sorted runs of 2^level elements.
+	template<class Input, uint32_t level, class = typename Sequence<Build<Input>::count>::Type> struct SortStage;
+	template<class Input, uint32_t level, uint32_t... i> struct SortStage<Input, level, Indices<i...> > {
+		static constexpr uint32_t values[sizeof...(i)] = {Build<Input>::template merged<level>(i)...};
+	};
+
+	template<class Input, uint32_t... i> struct SortStage<Input, 0, Indices<i...> > {
+		static constexpr uint32_t values[sizeof...(i)] = {Build<Input>::key(i)...};
+	};
+
+	/// Index of the first user of each bucket (in sorted order).
+	template<class Input, class = typename Sequence<Build<Input>::buckets + 1>::Type> struct StartsStage;
+	template<class Input, uint32_t... i> struct StartsStage<Input, Indices<i...> > {
+		static constexpr uint32_t values[sizeof...(i)] = {Build<Input>::start(i)...};
+	};
+
+	/// Prefix sums of the slot counts of the buckets, covering 2^level elements.
+	template<class Input, uint32_t level, class = typename Sequence<Build<Input>::buckets + 1>::Type> struct ScanStage;
+	template<class Input, uint32_t level, uint32_t... i> struct ScanStage<Input, level, Indices<i...> > {
+		static constexpr uint32_t values[sizeof...(i)] = {Build<Input>::template scanned<level>(i)...};
+	};
+
+	template<class Input, uint32_t... i> struct ScanStage<Input, 0, Indices<i...> > {
+		static constexpr uint32_t values[sizeof...(i)] = {(i ? Build<Input>::size(i - 1) : 0)...};
+	};
+
+	template<class Input, class = typename Sequence<Build<Input>::buckets>::Type> struct SeedsStage;
+	template<class Input, uint32_t... i> struct SeedsStage<Input, Indices<i...> > {
+		static constexpr uint8_t values[sizeof...(i)] = {(uint8_t)Build<Input>::seed(i)...};
+	};
+
+	template<class Input, class = typename Sequence<Build<Input>::buckets + 1>::Type> struct OffsetsStage;
+	template<class Input, uint32_t... i> struct OffsetsStage<Input, Indices<i...> > {
+		static constexpr uint16_t values[sizeof...(i)] = {(uint16_t)Build<Input>::offset(i)...};
+	};
+
+	template<class Input, class = typename Sequence<Build<Input>::slots>::Type> struct SlotsStage;
+	template<class Input, uint32_t... i> struct SlotsStage<Input, Indices<i...> > {
+		static constexpr uint16_t values[sizeof...(i)] = {(uint16_t)Build<Input>::occupant(i)...};
+	};
+
+	/// The functions used to compute the stages.
+	template<class Input>
+	struct Build {
+		static constexpr uint32_t count = sizeof(Input::credentials) / sizeof(DigestCredential);
+		static constexpr uint32_t buckets = count;
+
+		static constexpr uint32_t hash(uint32_t i) {
+			return fnv(Input::credentials[i].username);
+		}
+
+		static constexpr uint32_t key(uint32_t i) {
+			return hash(i) % buckets * count + i;
+		}
+
+		/*
+		 * Merging of the sorted runs of the previous stage. The element at position
+		 * _k_ of the merged run is determined by the number of elements taken from
+		 * the left run before it, which is found by a binary search.
+		 */
+		template<uint32_t level>
+		static constexpr uint32_t at(uint32_t i) {
+			return SortStage<Input, level>::values[i];
+		}
+
+		template<uint32_t level>
+		static constexpr bool leftFirst(uint32_t left, uint32_t right, uint32_t rightLength, uint32_t k, uint32_t i) {
+			return i == 0 || k - i >= rightLength || at<level>(left + i - 1) < at<level>(right + k - i);
+		}
+
+		template<uint32_t level>
+		static constexpr uint32_t taken(uint32_t left, uint32_t leftLength, uint32_t right, uint32_t rightLength, uint32_t k, uint32_t low, uint32_t high) {
+			return (low >= high) ? low : leftFirst<level>(left, right, rightLength, k, (low + high + 1) / 2) ?
+					taken<level>(left, leftLength, right, rightLength, k, (low + high + 1) / 2, high) :
+					taken<level>(left, leftLength, right, rightLength, k, low, (low + high + 1) / 2 - 1);
+		}
+
+		template<uint32_t level>
+		static constexpr uint32_t pick(uint32_t left, uint32_t leftLength, uint32_t right, uint32_t rightLength, uint32_t k, uint32_t i) {
+			return (i < leftLength && (k - i >= rightLength || at<level>(left + i) < at<level>(right + k - i))) ?
+					at<level>(left + i) : at<level>(right + k - i);
+		}
+
+		template<uint32_t level>
+		static constexpr uint32_t merge(uint32_t left, uint32_t leftLength, uint32_t right, uint32_t rightLength, uint32_t k) {
+			return pick<level>(left, leftLength, right, rightLength, k,
+					taken<level>(left, leftLength, right, rightLength, k, (k > rightLength) ? k - rightLength : 0, smaller(k, leftLength)));
+		}
+
+		template<uint32_t level>
+		static constexpr uint32_t merge(uint32_t left, uint32_t width, uint32_t k) {
+			return merge<level>(left, smaller(width, count - left), left + width,
+					(left + width < count) ? smaller(width, count - left - width) : 0, k);
+		}
+
+		template<uint32_t level>
+		static constexpr uint32_t merged(uint32_t p) {
+			return merge<level - 1>(p - p % (2u << (level - 1)), 1u << (level - 1), p % (2u << (level - 1)));
+		}
+
+		static constexpr uint32_t sorted(uint32_t p) {
+			return SortStage<Input, steps(count)>::values[p];
+		}
+
+		static constexpr uint32_t lowerBound(uint32_t key, uint32_t low, uint32_t high) {
+			return (low >= high) ? low : (sorted((low + high) / 2) < key) ?
+					lowerBound(key, (low + high) / 2 + 1, high) : lowerBound(key, low, (low + high) / 2);
+		}
+
+		static constexpr uint32_t start(uint32_t b) {
+			return lowerBound(b * count, 0, count);
+		}
+
+		static constexpr uint32_t member(uint32_t p) {
+			return sorted(p) % count;
+		}
+
+		/// Number of slots of a bucket (the square of the number of its users).
+		static constexpr uint32_t size(uint32_t b) {
+			return (StartsStage<Input>::values[b + 1] - StartsStage<Input>::values[b]) *
+					(StartsStage<Input>::values[b + 1] - StartsStage<Input>::values[b]);
+		}
+
+		template<uint32_t level>
+		static constexpr uint32_t scanned(uint32_t b) {
+			return ScanStage<Input, level - 1>::values[b] +
+					((b >= (1u << (level - 1))) ? ScanStage<Input, level - 1>::values[b - (1u << (level - 1))] : 0);
+		}
+
+		/// First slot of the bucket.
+		static constexpr uint32_t offset(uint32_t b) {
+			return ScanStage<Input, steps(buckets + 1)>::values[b];
+		}
+
+		static constexpr uint32_t slots = offset(buckets);
+
+		static constexpr uint32_t slot(uint32_t b, uint32_t p, uint32_t seed) {
+			return mix(hash(member(p)), seed) % size(b);
+		}
+
+		static constexpr bool distinctFrom(uint32_t b, uint32_t p, uint32_t q, uint32_t end, uint32_t seed) {
+			return q == end || (slot(b, p, seed) != slot(b, q, seed) && distinctFrom(b, p, q + 1, end, seed));
+		}
+
+		static constexpr bool distinct(uint32_t b, uint32_t p, uint32_t end, uint32_t seed) {
+			return p == end || (distinctFrom(b, p, p + 1, end, seed) && distinct(b, p + 1, end, seed));
+		}
+
+		/// The first seed that gives distinct slots for the users of the bucket (or _maxSeed_ + 1 if there is none).
+		static constexpr uint32_t seed(uint32_t b, uint32_t s = 0) {
+			return (s > maxSeed || distinct(b, StartsStage<Input>::values[b], StartsStage<Input>::values[b + 1], s)) ?
+					s : seed(b, s + 1);
+		}
+
+		static constexpr bool seedsFound(uint32_t low, uint32_t high) {
+			return (high - low == 1) ? (SeedsStage<Input>::values[low] <= maxSeed) :
+					seedsFound(low, low + (high - low) / 2) && seedsFound(low + (high - low) / 2, high);
+		}
+
+		/// Last bucket in the range, whose first slot is not after _t_.
+		static constexpr uint32_t findBucket(uint32_t t, uint32_t low, uint32_t high) {
+			return (high - low <= 1) ? low : (OffsetsStage<Input>::values[low + (high - low) / 2] <= t) ?
+					findBucket(t, low + (high - low) / 2, high) : findBucket(t, low, low + (high - low) / 2);
+		}
+
+		static constexpr uint32_t occupant(uint32_t b, uint32_t t, uint32_t p, uint32_t end) {
+			return (p == end) ? count : (slot(b, p, SeedsStage<Input>::values[b]) == t) ?
+					member(p) : occupant(b, t, p + 1, end);
+		}
+
+		static constexpr uint32_t occupantOf(uint32_t b, uint32_t t) {
+			return occupant(b, t - OffsetsStage<Input>::values[b], StartsStage<Input>::values[b], StartsStage<Input>::values[b + 1]);
+		}
+
+		/// The user that goes into the slot (or _count_ if it is empty).
+		static constexpr uint32_t occupant(uint32_t t) {
+			return occupantOf(findBucket(t, 0, buckets), t);
+		}
+
+		static constexpr uint32_t maxLength(uint32_t low, uint32_t high) {
+			return (high - low == 1) ? length(Input::credentials[low].username) :
+					larger(maxLength(low, low + (high - low) / 2), maxLength(low + (high - low) / 2, high));
+		}
+	};
+
+	/*
+	 * Only the last three stages are used at runtime.
+	 */
+	template<class Input, uint32_t... i> constexpr uint8_t SeedsStage<Input, Indices<i...> >::values[sizeof...(i)];
+	template<class Input, uint32_t... i> constexpr uint16_t OffsetsStage<Input, Indices<i...> >::values[sizeof...(i)];
+	template<class Input, uint32_t... i> constexpr uint16_t SlotsStage<Input, Indices<i...> >::values[sizeof...(i)];
+}
+
+/**
+ * Compile-time table of users.
+ *
+ * The _Input_ type needs to have a static constexpr array of DigestCredential
+ * entries named _credentials_ (that also needs to be defined out of the class).
+ *
+ * The user name is hashed while it is being received and stored in a buffer
+ * as long as the longest name in the table, the lookup is a single probe into
+ * a perfect hash table that is generated at compile-time, and a comparison.
+ */
+template<class Input>
+struct StaticCredentials {
+	typedef DigestCredentialTable::Build<Input> Build;
+	static constexpr uint32_t maxLength = Build::maxLength(0, Build::count);
+
+	static_assert(Build::count > 0, "The credential table must not be empty");
+	static_assert(Build::count < 0xffff, "The credential table is too big");
+	static_assert(Build::slots < 0xffff, "The credential table is too big");
+	static_assert(Build::seedsFound(0, Build::buckets), "Could not generate hash table (duplicate user names?)");
+
+	class Matcher {
+		char name[maxLength ? maxLength : 1];
+		uint32_t length, hash;
+		const DigestCredential* entry;
+
+	public:
+		inline void reset() {
+			length = 0;
+			hash = DigestCredentialTable::fnv("");
+			entry = nullptr;
+		}
+
+		inline void progress(const char* buff, uint32_t size) {
+			if(length > maxLength)
+				return;
+
+			if(size > maxLength - length) {
+				length = maxLength + 1;
+				return;
+			}
+
+			memcpy(name + length, buff, size);
+			length += size;
+
+			while(size--)
+				hash = (hash ^ (unsigned char)*buff++) * 16777619u;
+		}
+
+		inline void done() {
+			const uint16_t *offsets = DigestCredentialTable::OffsetsStage<Input>::values;
+			const uint32_t b = hash % Build::buckets;
+			const uint32_t size = offsets[b + 1] - offsets[b];
+			entry = nullptr;
+
+			if(length > maxLength || !size)
+				return;
+
+			const uint32_t t = offsets[b] + DigestCredentialTable::mix(hash, DigestCredentialTable::SeedsStage<Input>::values[b]) % size;
+			const uint32_t idx = DigestCredentialTable::SlotsStage<Input>::values[t];
+
+			if(idx < Build::count) {
+				const DigestCredential* candidate = Input::credentials + idx;
+
+				if(strlen(candidate->username) == length && memcmp(candidate->username, name, length) == 0)
+					entry = candidate;
+			}
+		}
+
+		inline const char* username() {
+			return entry ? entry->username : nullptr;
+		}
+
+		inline const char* ha1() {
+			return entry ? entry->ha1 : nullptr;
+		}
+	};
+};
+
+#endif /* DIGESTCREDENTIALS_H_ */
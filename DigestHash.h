@@ -0,0 +1,71 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2017 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+#ifndef DIGESTHASH_H_
+#define DIGESTHASH_H_
+
+#include "md5/md5.h"
+#include "sha256/sha256.h"
+
+#include <stdint.h>
+
+/**
+ * Hash algorithms usable for digest authentication.
+ *
+ * A hash policy provides the context type, the length of the digest
+ * in bytes, the name of the algorithm as used in the _algorithm_
+ * parameter of the challenge and the response (RFC 7616) and the
+ * usual init/update/final operations.
+ */
+struct DigestMd5 {
+	typedef MD5_CTX Context;
+	static constexpr uint32_t length = 16;
+	static constexpr const char* name() {return "MD5";}
+
+	static inline void init(Context* ctx) {
+		MD5_Init(ctx);
+	}
+
+	static inline void update(Context* ctx, const void* data, uint32_t size) {
+		MD5_Update(ctx, data, size);
+	}
+
+	static inline void final(unsigned char* result, Context* ctx) {
+		MD5_Final(result, ctx);
+	}
+};
+
+struct DigestSha256 {
+	typedef SHA256_CTX Context;
+	static constexpr uint32_t length = 32;
+	static constexpr const char* name() {return "SHA-256";}
+
+	static inline void init(Context* ctx) {
+		SHA256_Init(ctx);
+	}
+
+	static inline void update(Context* ctx, const void* data, uint32_t size) {
+		SHA256_Update(ctx, data, size);
+	}
+
+	static inline void final(unsigned char* result, Context* ctx) {
+		SHA256_Final(result, ctx);
+	}
+};
+
+#endif /* DIGESTHASH_H_ */
@@ -0,0 +1,210 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2017 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+#ifndef DIGESTNONCE_H_
+#define DIGESTNONCE_H_
+
+#include "md5/md5.h"
+
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * Stateless digest authentication nonce.
+ *
+ * The nonce is the hexadecimal creation timestamp and serial number followed
+ * by the truncated HMAC-MD5 of the same, keyed with a server side secret. This
+ * way the nonces issued by the server can be validated and their age can be
+ * determined without storing anything about the clients, while the serial
+ * number makes the ones issued at the same time distinct.
+ */
+class DigestNonce {
+	static constexpr uint32_t timeDigits = 8;
+	static constexpr uint32_t serialDigits = 8;
+	static constexpr uint32_t stampDigits = timeDigits + serialDigits;
+	static constexpr uint32_t macDigits = 16;
+
+	static inline void hex(const unsigned char* in, uint32_t length, char* out) {
+		static const char digits[] = "0123456789abcdef";
+		while(length--) {
+			*out++ = digits[*in >> 4];
+			*out++ = digits[*in++ & 0xf];
+		}
+	}
+
+	/// Compute the HMAC-MD5 of the timestamp and serial number digits.
+	static inline void mac(const char* key, const char* stamp, unsigned char result[16])
+	{
+		unsigned char pad[64];
+		uint32_t keyLength = key ? strlen(key) : 0;
+		MD5_CTX ctx;
+
+		memset(pad, 0, sizeof(pad));
+
+		if(keyLength > sizeof(pad)) {
+			MD5_Init(&ctx);
+			MD5_Update(&ctx, key, keyLength);
+			MD5_Final(pad, &ctx);
+		} else
+			memcpy(pad, key, keyLength);
+
+		for(unsigned char &c: pad)
+			c ^= 0x36;
+
+		MD5_Init(&ctx);
+		MD5_Update(&ctx, pad, sizeof(pad));
+		MD5_Update(&ctx, stamp, stampDigits);
+		MD5_Final(result, &ctx);
+
+		for(unsigned char &c: pad)
+			c ^= 0x36 ^ 0x5c;
+
+		MD5_Init(&ctx);
+		MD5_Update(&ctx, pad, sizeof(pad));
+		MD5_Update(&ctx, result, 16);
+		MD5_Final(result, &ctx);
+	}
+
+public:
+	/// Number of characters in a nonce.
+	static constexpr uint32_t length = stampDigits + macDigits;
+
+	/// Outcome of nonce validation.
+	enum class Result: uint8_t {Valid, Stale, Invalid};
+
+	/// Create a nonce for the current time and the _serial_ number, into the _length_ sized buffer.
+	static inline void generate(const char* key, uint32_t now, uint32_t serial, char* out)
+	{
+		unsigned char temp[16];
+
+		for(uint32_t i = 0; i < sizeof(now); i++) {
+			temp[i] = now >> (8 * (sizeof(now) - 1 - i));
+			temp[sizeof(now) + i] = serial >> (8 * (sizeof(serial) - 1 - i));
+		}
+
+		hex(temp, sizeof(now) + sizeof(serial), out);
+		mac(key, out, temp);
+		hex(temp, macDigits / 2, out + stampDigits);
+	}
+
+	/// Check the authenticity and the age of a nonce.
+	static inline Result check(const char* key, const char* nonce, uint32_t nonceLength, uint32_t now, uint32_t lifetime)
+	{
+		if(nonceLength != length)
+			return Result::Invalid;
+
+		uint32_t time = 0;
+
+		for(uint32_t i = 0; i < timeDigits; i++) {
+			const char c = nonce[i];
+
+			if('0' <= c && c <= '9')
+				time = time << 4 | (c - '0');
+			else if('a' <= c && c <= 'f')
+				time = time << 4 | (c - 'a' + 10);
+			else
+				return Result::Invalid;
+		}
+
+		unsigned char temp[16];
+		char expected[macDigits];
+		mac(key, nonce, temp);
+		hex(temp, macDigits / 2, expected);
+
+		char diff = 0;
+		for(uint32_t i = 0; i < macDigits; i++)
+			diff |= expected[i] ^ nonce[stampDigits + i];
+
+		if(diff)
+			return Result::Invalid;
+
+		return (now - time > lifetime) ? Result::Stale : Result::Valid;
+	}
+};
+
+/**
+ * Fixed capacity nonce-count tracker.
+ *
+ * Remembers the last nonce-count value seen for the most recently used
+ * nonces (identified by their 32-bit FNV-1a hash), in order to reject
+ * replayed requests. A nonce that is not (or no longer) tracked is only
+ * accepted with the initial count, so the client gets a new challenge
+ * when an entry is evicted. A statically allocated (zero initialized)
+ * instance is empty.
+ */
+template<unsigned int size>
+class DigestNonceCounter {
+	struct Entry {
+		uint32_t key;
+		uint32_t count;
+		uint32_t used;
+	};
+
+	/// Tracked nonces, a count of zero marks a free entry.
+	Entry entries[size];
+
+	/// Usage counter for least recently used eviction.
+	uint32_t clock;
+
+	static inline uint32_t hash(const char* nonce, uint32_t length) {
+		uint32_t ret = 0x811c9dc5;
+
+		while(length--)
+			ret = (ret ^ (uint8_t)*nonce++) * 0x01000193;
+
+		return ret;
+	}
+
+public:
+	/// Forget all nonces.
+	inline void reset() {
+		for(Entry& entry: entries)
+			entry.count = 0;
+	}
+
+	/// Check that the count is greater than the last one seen for the nonce, and record it.
+	inline bool accept(const char* nonce, uint32_t length, uint32_t count)
+	{
+		const uint32_t key = hash(nonce, length);
+		Entry* victim = entries;
+
+		for(Entry& entry: entries) {
+			if(entry.count && entry.key == key) {
+				if(count <= entry.count)
+					return false;
+
+				entry.count = count;
+				entry.used = ++clock;
+				return true;
+			}
+
+			if(victim->count && (!entry.count || (int32_t)(entry.used - victim->used) < 0))
+				victim = &entry;
+		}
+
+		if(count != 1)
+			return false;
+
+		victim->key = key;
+		victim->count = count;
+		victim->used = ++clock;
+		return true;
+	}
+};
+
+#endif /* DIGESTNONCE_H_ */
@@ -21,6 +21,105 @@
 
 #include <stdint.h>
 
+namespace detail {
+	/**
+	 * Value of the hexadecimal digits indexed by the character code, -1 for
+	 * any other character. A template only to allow defining the table in
+	 * the header without violating the one definition rule.
+	 */
+	template<class = void>
+	struct HexDigitTable {
+		static constexpr const int8_t values[256] = {
+				-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+				-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+				-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+				 0,  1,  2,  3,  4,  5,  6,  7,  8,  9, -1, -1, -1, -1, -1, -1,
+				-1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+				-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+				-1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+				-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+				-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+				-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+				-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+				-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+				-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+				-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+				-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+				-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+		};
+	};
+
+	template<class Dummy>
+	constexpr const int8_t HexDigitTable<Dummy>::values[];
+}
+
+/**
+ * Hexadecimal digit lookup.
+ */
+struct HexDigit {
+	/// Value of the hexadecimal digit _c_, or -1 if it is not one.
+	static inline int8_t value(char c) {
+		return detail::HexDigitTable<>::values[(unsigned char)c];
+	}
+};
+
+/**
+ * Decoder of a percent encoded character (%XX), that is fed
+ * with the characters of the escape sequence one by one.
+ */
+class PercentEscape {
+	/// Number of characters of the escape sequence processed, zero if not in one.
+	uint8_t idx;
+
+	/// The character being decoded.
+	char decoded;
+
+public:
+	enum class Result: uint8_t {
+		Pending, Done, Invalid
+	};
+
+	/// Initialize internal state.
+	inline void reset() {
+		idx = 0;
+	}
+
+	/// Start an escape sequence (the percent sign is found).
+	inline void start() {
+		idx = 1;
+	}
+
+	/// True if in an escape sequence.
+	inline bool isActive() {
+		return idx != 0;
+	}
+
+	/// Process the next hexadecimal digit, the sequence is over if not pending.
+	inline Result feed(char c) {
+		const int8_t digit = HexDigit::value(c);
+
+		if(digit < 0) {
+			idx = 0;
+			return Result::Invalid;
+		}
+
+		if(idx == 1) {
+			decoded = digit << 4;
+			idx = 2;
+			return Result::Pending;
+		}
+
+		decoded |= digit;
+		idx = 0;
+		return Result::Done;
+	}
+
+	/// The decoded character, valid if the sequence is done.
+	inline const char* value() {
+		return &decoded;
+	}
+};
+
 /**
  * Non-buffered parser for fixed size hexadecimal data.
  */
@@ -51,15 +150,9 @@ inline void HexParser<size>::parseHex(const char *at, uint32_t length)
 		idx = -1u;
 	else {
 		while(length--) {
-			char digit;
-
-			if('0' <= *at && *at <= '9')
-				digit = *at - '0';
-			else if('a' <= *at && *at <= 'f')
-				digit = *at - 'a' + 10;
-			else if('A' <= *at && *at <= 'F')
-				digit = *at - 'A' + 10;
-			else {
+			const int8_t digit = HexDigit::value(*at);
+
+			if(digit < 0) {
 				idx = -1u;
 				return;
 			}
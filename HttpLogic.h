@@ -22,21 +22,54 @@
 #include "Keywords.h"
 #include "UrlParser.h"
 #include "PathParser.h"
+#include "QueryParser.h"
 #include "AuthDigest.h"
+#include "AuthBasic.h"
+#include "ContentDigest.h"
+#include "DavLock.h"
 #include "DavRequestParser.h"
 #include "HttpRequestParser.h"
+#include "JsonParser.h"
 
 #include "DavProperty.h"
 
 #include "algorithm/Str.h"
 #include "meta/Configuration.h"
 
+#include <new>
+#include <type_traits>
+
+/**
+ * Handling of requests that are known to fail before their body is received.
+ */
+enum class RejectPolicy: uint8_t {
+	Wait,	///< Send the response after the whole body is received (and ignored).
+	Drain,	///< Send the response immediately, then skip the rest of the body.
+	Close	///< Send the response immediately, then stop processing and close the connection.
+};
+
 namespace HttpConfig {
 	PET_CONFIG_VALUE(AuthUser, const char*);
 	PET_CONFIG_VALUE(AuthRealm, const char*);
 	PET_CONFIG_VALUE(AuthPasswdHash, const char*);
+	PET_CONFIG_VALUE(AuthPassword, const char*);
+	PET_CONFIG_VALUE(AuthSchemes, AuthScheme);
+	PET_CONFIG_TYPE(AuthHash);
+	PET_CONFIG_TYPE(AuthCredentials);
+	PET_CONFIG_VALUE(AuthNonceKey, const char*);
+	PET_CONFIG_VALUE(AuthNonceLifetime, uint32_t);
+	PET_CONFIG_VALUE(AuthNonceCount, uint32_t);
+	PET_CONFIG_VALUE(AuthCache, bool);
+	PET_CONFIG_VALUE(ContentMd5, bool);
+	PET_CONFIG_VALUE(PathElementLength, uint32_t);
+	PET_CONFIG_VALUE(BodyBufferSize, uint32_t);
+	PET_CONFIG_VALUE(JsonBodyDepth, uint16_t);
 	PET_CONFIG_VALUE(DavStackSize, uint32_t);
+	PET_CONFIG_VALUE(DavLockCount, uint32_t);
+	PET_CONFIG_VALUE(DavLockTimeout, uint32_t);
+	PET_CONFIG_VALUE(EarlyReject, RejectPolicy);
 	PET_CONFIG_TYPE(DavProperties);
+	PET_CONFIG_TYPE(QueryParameters);
 }
 
 // TODO add checks for destination accessibility.
@@ -46,7 +79,9 @@ typedef http_status HttpStatus;
 template<class Provider, class... Options>
 class HttpLogic: public HttpRequestParser<HttpLogic<Provider, Options...> >,
 					UrlParser<HttpLogic<Provider, Options...> >,
-					PathParser<HttpLogic<Provider, Options...> >
+					PathParser<HttpLogic<Provider, Options...> >,
+					QueryDispatcher<HttpLogic<Provider, Options...>,
+						typename HttpConfig::QueryParameters<void>::template extract<Options...>::type>
 {
 public:
 	enum class AuthStatus: uint8_t {
@@ -69,26 +104,86 @@ private:
 
 	static constexpr uint32_t davStackSize = HttpConfig::DavStackSize<1>::extract<Options...>::value;
 
+	/// Maximal length of a path element (file or directory name) in bytes.
+	static constexpr uint32_t pathElementLength = HttpConfig::PathElementLength<32>::extract<Options...>::value;
+
+	/// Size of the buffer used for batching small fragments of uploaded content (zero disables it).
+	static constexpr uint32_t bodyBufferSize = HttpConfig::BodyBufferSize<0>::extract<Options...>::value;
+
+	/// Nesting limit of the parser of JSON request bodies (zero disables parsing them).
+	static constexpr uint16_t jsonBodyDepth = HttpConfig::JsonBodyDepth<0>::extract<Options...>::value;
+
+	/*
+	 * Number of simultaneous locks (zero disables locking) and the
+	 * maximal lock timeout in seconds (must be less than 2^31).
+	 */
+	static constexpr uint32_t davLockCount = HttpConfig::DavLockCount<0>::extract<Options...>::value;
+	static constexpr uint32_t davLockTimeout = HttpConfig::DavLockTimeout<600>::extract<Options...>::value;
+
+	static constexpr RejectPolicy earlyReject = HttpConfig::EarlyReject<RejectPolicy::Drain>::extract<Options...>::value;
+
+	static constexpr bool contentMd5 = HttpConfig::ContentMd5<false>::extract<Options...>::value;
+
 	struct AuthParams {
 		static constexpr const char* username = HttpConfig::AuthUser<nullptr>::extract<Options...>::value;
 		static constexpr const char* realm = HttpConfig::AuthRealm<nullptr>::extract<Options...>::value;
 		static constexpr const char* RFC2069_A1 = HttpConfig::AuthPasswdHash<nullptr>::extract<Options...>::value;
+		static constexpr const char* password = HttpConfig::AuthPassword<nullptr>::extract<Options...>::value;
+		static constexpr AuthScheme schemes = HttpConfig::AuthSchemes<AuthScheme::Digest>::extract<Options...>::value;
+		static constexpr const char* nonceKey = HttpConfig::AuthNonceKey<nullptr>::extract<Options...>::value;
+		static constexpr uint32_t nonceLifetime = HttpConfig::AuthNonceLifetime<300>::extract<Options...>::value;
+		static constexpr uint32_t nonceCount = HttpConfig::AuthNonceCount<8>::extract<Options...>::value;
+		static constexpr bool cache = HttpConfig::AuthCache<false>::extract<Options...>::value;
 		static constexpr const bool ok = username && realm && RFC2069_A1;
+		typedef std::integral_constant<bool, realm != nullptr> HasRealm;
+		typedef typename HttpConfig::AuthHash<DigestMd5>::template extract<Options...>::type Hash;
+		typedef typename HttpConfig::AuthCredentials<SingleCredential<AuthParams> >::template extract<Options...>::type Credentials;
 	};
 
 	typedef void (*HeaderFieldParser)(HttpLogic*, const char*, uint32_t);
-	typedef Keywords<HeaderFieldParser, 4> HeaderKeywords;
+	typedef Keywords<HeaderFieldParser, 11> HeaderKeywords;
 	typedef DavRequestParser<davStackSize> DavReqParser;
+	typedef DavLockRequestParser<davStackSize> DavLockReqParser;
+	typedef JsonParser<jsonBodyDepth ? jsonBodyDepth : 1> JsonBodyParser;
+	typedef DavLockTable<davLockCount ? davLockCount : 1> LockTable;
+	typedef DigestNonceCounter<AuthParams::nonceCount ? AuthParams::nonceCount : 1> NonceCounter;
+	typedef typename AuthValidatorFor<AuthParams::schemes,
+			AuthDigest<AuthParams, typename AuthParams::Hash>,
+			AuthBasic<AuthParams> >::Type AuthValidator;
+
+	static_assert(!AuthParams::HasRealm::value || !((uint8_t)AuthParams::schemes & (uint8_t)AuthScheme::Digest)
+			|| AuthParams::nonceKey != nullptr, "Digest authentication needs a nonce key (AuthNonceKey)");
 
 	static const HeaderKeywords headerKeywords;
 
+	/// The locks are shared between all the sessions of the same type.
+	static LockTable lockTable;
+
+	/// Nonce-counts are tracked for all the sessions of the same type, too.
+	static NonceCounter nonceCounter;
+
+	/// Number of nonces issued, so that every challenge gets a distinct one.
+	static uint32_t nonceSerial;
+
 	static constexpr const char* crLf = "\r\n";
 	static constexpr const char* keepAliveHeader = "Connection: Keep-Alive\r\n";
 	static constexpr const char* closeHeader = "Connection: Close\r\n";
+	static constexpr const char* continueResponse = "HTTP/1.1 100 Continue\r\n\r\n";
+	static constexpr const char* challengeHeader = "WWW-Authenticate: Digest realm=\"";
+	static constexpr const char* challengeNonce = "\", nonce=\"";
+	static constexpr const char* challengeAlgorithm = "\", qop=\"auth\", algorithm=";
+	static constexpr const char* challengeStale = ", stale=true";
+	static constexpr const char* basicChallengeHeader = "WWW-Authenticate: Basic realm=\"";
+	static constexpr const char* basicChallengeCharset = "\", charset=\"UTF-8\"";
 	static constexpr const char* chunkedHeader = "Transfer-Encoding: chunked\r\n";
 	static constexpr const char* emptyBodyHeader = "Content-Length: 0\r\n";
 	static constexpr const char* allowStrDav = "Allow: OPTIONS,GET,PUT,HEAD,DELETE,PROPFIND,COPY,MOVE\r\n";
+	static constexpr const char* allowStrDavLock = "Allow: OPTIONS,GET,PUT,HEAD,DELETE,PROPFIND,COPY,MOVE,LOCK,UNLOCK\r\n";
 	static constexpr const char* davHeader = "Dav: 1\r\n";
+	static constexpr const char* davLockHeader = "Dav: 1,2\r\n";
+	static constexpr const char* xmlContentTypeHeader = "Content-Type: application/xml; charset=\"utf-8\"\r\n";
+	static constexpr const char* lockTokenHeader = "Lock-Token: <opaquelocktoken:";
+	static constexpr const char* lockTokenTrailer = ">\r\n";
 	static constexpr const char* allowStrNoDav = "Allow: OPTIONS,GET,HEAD\r\n";
 
 	// Once per request
@@ -112,6 +207,19 @@ private:
 
 	static constexpr const char* xmlFileTrailer = "</response>";
 
+	// Lock discovery, before the scope
+	static constexpr const char* xmlLockHeader = "<?xml version=\"1.0\" encoding=\"UTF-8\"?><prop xmlns=\"DAV:\"><lockdiscovery>"
+			"<activelock><locktype><write/></locktype><lockscope>";
+
+	// Lock discovery, between the fields
+	static constexpr const char* xmlLockExclusive = "<exclusive/></lockscope><depth>";
+	static constexpr const char* xmlLockShared = "<shared/></lockscope><depth>";
+	static constexpr const char* xmlLockTimeout = "</depth><timeout>Second-";
+	static constexpr const char* xmlLockToken = "</timeout><locktoken><href>opaquelocktoken:";
+
+	// Lock discovery, after the token
+	static constexpr const char* xmlLockTrailer = "</href></locktoken></activelock></lockdiscovery></prop>";
+
 	enum class Depth: uint8_t {
 		File, Directory, Traverse
 	};
@@ -121,13 +229,46 @@ private:
 
 	bool parseSource;
 	bool overwrite;
+
+	// Set if the client waits for an interim response before sending the body.
+	bool expectation;
+
+	// Set if the final response is already sent before the body is received.
+	bool responseSent;
+
+	// Set if the body of a POST request is passed to the JSON parser.
+	bool jsonBody;
+
+	// Set if the credentials are right but the nonce has expired.
+	bool staleNonce;
 	AuthStatus authState;
+
+	// Access rights of the source resource, queried once the headers are in.
+	DavAccess sourceAccess;
+
+	// Name of the authorized user.
+	const char* authUser;
+
+	// Last verified digest response of the connection (if enabled).
+	AuthDigestCache<AuthValidator, AuthParams::cache> authCache;
+
+	// Expected hash of the uploaded content (if enabled).
+	OptionalContentDigest<contentMd5> contentDigest;
 	Depth depth;
 
 	HeaderFieldParser fieldParser;
 
 	HttpStatus status;
-	TemporaryStringBuffer<32> tempString;
+	TemporaryStringBuffer<pathElementLength + 1> tempString;
+
+	// Path hash being computed and the one of the request URL.
+	DavLockPath lockPath, urlLockPath;
+
+	// Tokens submitted in the If or Lock-Token header.
+	DavLockTokenParser<2> lockTokens;
+
+	// Requested lock timeout, limited to the configured maximum.
+	uint32_t lockTimeout;
 
 	union {
 		// Only used during headerName matching, result can
@@ -136,7 +277,7 @@ private:
 
 		// Only used for auth field processing, the result is copied into
 		// authState property immediately in the afterHeaderValue method
-		AuthDigest<AuthParams> authFieldValidator;
+		AuthValidator authFieldValidator;
 
 		// Only used for the overwrite field processing, the result is copied
 		// into overwrite property immediately in the afterHeaderValue method
@@ -146,9 +287,23 @@ private:
 		// into depth property immediately in the afterHeaderValue method
 		typename DepthKeywords::Matcher depthMatcher;
 
+		// Only used for the timeout field processing, the result is copied
+		// into lockTimeout property immediately in the afterHeaderValue method
+		DavLockTimeoutParser timeoutParser;
+
 		// Only used for WebDAV request processing, after all the data
 		// originally contained in the header fields are copied
 		DavReqParser davReqParser;
+
+		// Only used for WebDAV lock request processing, same as above
+		DavLockReqParser davLockParser;
+
+		// Only used for batching the uploaded content, same as above
+		TemporaryStringBuffer<bodyBufferSize + 1> bodyBuffer;
+
+		// Only used for JSON request bodies (if enabled), same as above,
+		// it is constructed in place as it has virtual methods
+		alignas(JsonBodyParser) char jsonParserStorage[jsonBodyDepth ? sizeof(JsonBodyParser) : 1];
 	};
 
 	static void parseUsername(HttpLogic* self, const char* buff, uint32_t length);
@@ -156,13 +311,25 @@ private:
 	static void parseOverwrite(HttpLogic*, const char*, uint32_t);
 	static void parseDestination(HttpLogic*, const char*, uint32_t);
 	static void parseAuthorization(HttpLogic*, const char*, uint32_t);
+	static void parseLockToken(HttpLogic*, const char*, uint32_t);
+	static void parseTimeout(HttpLogic*, const char*, uint32_t);
+	static void parseExpect(HttpLogic*, const char*, uint32_t);
+	static void parseContentMd5(HttpLogic*, const char*, uint32_t);
+	static void parseDigest(HttpLogic*, const char*, uint32_t);
+	static void parseContentType(HttpLogic*, const char*, uint32_t);
 
 	// UrlParser
 	friend UrlParser<HttpLogic>;
 	inline int onPath(const char *at, size_t length);
 	inline void pathDone();
-	inline void onQuery(const char* at, uint32_t length) {}
-	inline void queryDone() {}
+	inline void onQuery(const char* at, uint32_t length);
+	inline void queryDone();
+
+	// QueryDispatcher
+	typedef QueryDispatcher<HttpLogic, typename HttpConfig::QueryParameters<void>::template extract<Options...>::type> QueryParams;
+	friend QueryParams;
+	template<class Key> inline void onParameter(Key key, const char* at, uint32_t length);
+	template<class Key> inline void parameterDone(Key key);
 
 	// PathParser
 	friend PathParser<HttpLogic>;
@@ -201,7 +368,20 @@ private:
 	inline void sendPropEnd(const DavProperty* prop);
 
 	inline void newRequest();
+	inline void writeBody(const char *at, uint32_t length);
+	inline HttpStatus arrangeJsonBody();
+	inline JsonBodyParser& jsonParser();
+	inline void finishJsonBody();
+	inline void checkAccess();
+	inline void rejectEarly();
+	inline void finishErrorResponse();
+	inline void sendRealm(std::true_type);
+	inline void sendRealm(std::false_type) {}
 	inline bool generatePropfindResponse(bool file, typename DavReqParser::Type type);
+	inline bool isLockProtected();
+	inline HttpStatus processLock(const typename LockTable::Lock* &lock);
+	inline HttpStatus processUnlock();
+	inline void generateLockResponse(const typename LockTable::Lock* lock);
 protected:
 	inline void beginHeaders();
 	inline void sendChunk(const char*, uint32_t);
@@ -222,8 +402,10 @@ protected:
 	inline HttpStatus copy(const char* dstName, uint32_t length, bool overwrite) { return HTTP_STATUS_FORBIDDEN; }
 	inline HttpStatus move(const char* dstName, uint32_t length, bool overwrite) { return HTTP_STATUS_FORBIDDEN; }
 	inline HttpStatus arrangeReceiveInto(const char* dstName, uint32_t length) { return HTTP_STATUS_OK; }
+	inline HttpStatus arrangeJsonReceive(const char* dstName, uint32_t length, EntityFilter* &filter) { return HTTP_STATUS_UNSUPPORTED_MEDIA_TYPE; }
 	inline HttpStatus writeContent(const char* buff, uint32_t length) { return HTTP_STATUS_OK; }
 	inline HttpStatus contentWritten() { return HTTP_STATUS_OK; }
+	inline void contentDiscarded() {}
 	inline HttpStatus arrangeSendFrom(uint32_t &size) { return HTTP_STATUS_NOT_FOUND; }
 	inline HttpStatus readContent() { return HTTP_STATUS_NOT_FOUND; }
 	inline HttpStatus contentRead() { return HTTP_STATUS_NOT_FOUND; }
@@ -234,8 +416,14 @@ protected:
 	inline bool stepListing() { return false; }
 	inline HttpStatus fileListingDone() { return HTTP_STATUS_FORBIDDEN; }
 	inline HttpStatus directoryListingDone() { return HTTP_STATUS_FORBIDDEN; }
+	inline HttpStatus lockResource(const char* dstName, uint32_t length) { return HTTP_STATUS_OK; }
+	template<class Key> inline void onQueryParameter(Key key, const char* str, uint32_t length) {}
+	template<class Key> inline void queryParameterDone(Key key) {}
+	inline uint32_t currentTime() { return 0; }
+	inline void closeConnection() {}
 public:
 	inline AuthStatus getAuthStatus();
+	inline const char* getAuthUser();
 	inline HttpStatus getStatus();
 	inline void parse(const char *at, size_t length);
 	inline void reset();
@@ -243,6 +431,39 @@ public:
 
 	static inline const char* getStatusLine(HttpStatus);
 	static inline bool isError(HttpStatus);
+	static inline void resetLocks(uint32_t seed = 0);
+
+	/**
+	 * Per session memory usage in bytes with the chosen configuration.
+	 *
+	 * The parsers of the header fields and the request body share the
+	 * same storage, the size of that is the largest of them.
+	 */
+	struct MemoryReport {
+		/// The whole session state (excluding the provider's own members).
+		static constexpr size_t session() { return sizeof(HttpLogic); }
+
+		/// Buffer of the current path element (_PathElementLength_).
+		static constexpr size_t pathElement() { return sizeof(tempString); }
+
+		/// WebDAV request body parser (_DavStackSize_).
+		static constexpr size_t davRequest() { return sizeof(davReqParser); }
+
+		/// Buffer for batching the uploaded content (_BodyBufferSize_).
+		static constexpr size_t bodyBuffer() { return sizeof(HttpLogic::bodyBuffer); }
+
+		/// JSON request body parser (_JsonBodyDepth_).
+		static constexpr size_t jsonBody() { return sizeof(jsonParserStorage); }
+
+		/// Authorization header field parser (_AuthHash_, _AuthCredentials_).
+		static constexpr size_t authorization() { return sizeof(authFieldValidator); }
+
+		/// Last verified digest response (_AuthCache_).
+		static constexpr size_t authCache() { return sizeof(HttpLogic::authCache); }
+
+		/// Expected hash of the uploaded content (_ContentMd5_).
+		static constexpr size_t contentDigest() { return sizeof(HttpLogic::contentDigest); }
+	};
 };
 
 template<class Provider, class... Options>
@@ -253,8 +474,18 @@ newRequest()
 
 	status = HTTP_STATUS_OK;
 	authState = AuthStatus::None;
+	sourceAccess = DavAccess::NoDav;
+	authUser = nullptr;
 	fieldParser = nullptr;
 	depth = Depth::Traverse;
+	overwrite = false;
+	expectation = false;
+	responseSent = false;
+	jsonBody = false;
+	staleNonce = false;
+	lockTokens.reset();
+	lockTimeout = davLockTimeout;
+	contentDigest.reset();
 }
 
 template<class Provider, class... Options>
@@ -262,6 +493,7 @@ inline void HttpLogic<Provider, Options...>::
 reset()
 {
 	HttpRequestParser<HttpLogic>::reset();
+	authCache.clear();
 	newRequest();
 }
 
@@ -397,16 +629,35 @@ template<class Provider, class... Options>
 void HttpLogic<Provider, Options...>::
 parseAuthorization(HttpLogic* self, const char* buff, uint32_t length)
 {
+	/*
+	 * Nonce-counts are only tracked if the application provides a clock,
+	 * without one the nonces repeat after a restart, and the clients that
+	 * got the same nonce would lock each other out.
+	 */
+	static constexpr bool hasClock = !std::is_same<decltype(&Provider::currentTime), uint32_t (HttpLogic::*)()>::value;
+
 	if(!buff) {
 		if(length)
-			self->authFieldValidator.reset(HttpRequestParser<HttpLogic>::getMethodText(self->getMethod()));
+			self->authFieldValidator.reset(HttpRequestParser<HttpLogic>::getMethodText(self->getMethod()),
+					((Provider*)self)->currentTime(), self->authCache.get());
 		else {
 			self->authFieldValidator.authFieldDone();
 			if(!self->authFieldValidator.isAuthorized()) {
 				self->status = HTTP_STATUS_UNAUTHORIZED;
+				self->staleNonce = self->authFieldValidator.isStale();
 				self->authState = AuthStatus::Failed;
-			} else
+			} else if(AuthParams::nonceCount && hasClock && self->authFieldValidator.hasNonceCount()
+					&& !nonceCounter.accept(self->authFieldValidator.getNonce(),
+							self->authFieldValidator.getNonceLength(),
+							self->authFieldValidator.getNonceCount())) {
+				// Replayed or untracked request, a new nonce is needed.
+				self->status = HTTP_STATUS_UNAUTHORIZED;
+				self->staleNonce = true;
+				self->authState = AuthStatus::Failed;
+			} else {
 				self->authState = AuthStatus::Ok;
+				self->authUser = self->authFieldValidator.getUsername();
+			}
 		}
 	} else
 		self->authFieldValidator.parseAuthField(buff, length);
@@ -423,6 +674,7 @@ parseDestination(HttpLogic* self, const char* buff, uint32_t length)
 			self->parseSource = false;
 			((Provider*)self)->resetDestinationLocator();
 			self->tempString.clear();
+			self->lockPath.reset();
 		} else {
 			self->UrlParser<HttpLogic>::done();
 		}
@@ -431,11 +683,110 @@ parseDestination(HttpLogic* self, const char* buff, uint32_t length)
 }
 
 
+template<class Provider, class... Options>
+void HttpLogic<Provider, Options...>::
+parseLockToken(HttpLogic* self, const char* buff, uint32_t length)
+{
+	if(!buff) {
+		if(!length)
+			self->lockTokens.done();
+	} else
+		self->lockTokens.parseTokens(buff, length);
+}
+
+template<class Provider, class... Options>
+void HttpLogic<Provider, Options...>::
+parseTimeout(HttpLogic* self, const char* buff, uint32_t length)
+{
+	if(!buff) {
+		if(length)
+			self->timeoutParser.reset();
+		else if(uint32_t seconds = self->timeoutParser.getSeconds())
+			self->lockTimeout = (seconds < davLockTimeout) ? seconds : davLockTimeout;
+	} else
+		self->timeoutParser.parseTimeout(buff, length);
+}
+
+template<class Provider, class... Options>
+void HttpLogic<Provider, Options...>::
+parseExpect(HttpLogic* self, const char* buff, uint32_t length)
+{
+	static constexpr const char* continueStr = "100-continue";
+	if(!buff) {
+		if(!length) {
+			self->expectation = true;
+			if(!self->cstrMatcher.matches(continueStr))
+				self->status = HTTP_STATUS_EXPECTATION_FAILED;
+		} else
+			self->cstrMatcher.reset();
+	} else
+		self->cstrMatcher.progressWithMatchingNoCase(continueStr, buff, length);
+}
+
+template<class Provider, class... Options>
+void HttpLogic<Provider, Options...>::
+parseContentMd5(HttpLogic* self, const char* buff, uint32_t length)
+{
+	self->contentDigest.parseContentMd5(buff, length);
+
+	if(!buff && !length && self->contentDigest.isMalformed())
+		self->status = HTTP_STATUS_BAD_REQUEST;
+}
+
+template<class Provider, class... Options>
+void HttpLogic<Provider, Options...>::
+parseDigest(HttpLogic* self, const char* buff, uint32_t length)
+{
+	self->contentDigest.parseDigest(buff, length);
+
+	if(!buff && !length && self->contentDigest.isMalformed())
+		self->status = HTTP_STATUS_BAD_REQUEST;
+}
+
+/*
+ * Only the media type is checked (case-insensitively), the parameters
+ * (after a semicolon or whitespace) are ignored. The jsonBody flag is set
+ * while skipping them, the final value is only determined at the end of
+ * the field.
+ */
+template<class Provider, class... Options>
+inline void HttpLogic<Provider, Options...>::
+parseContentType(HttpLogic* self, const char* buff, uint32_t length)
+{
+	static constexpr const char* jsonStr = "application/json";
+	if(!buff) {
+		if(!length) {
+			self->jsonBody = jsonBodyDepth && self->cstrMatcher.matches(jsonStr) &&
+					self->HttpRequestParser<HttpLogic>::getMethod() == HttpRequestParser<HttpLogic>::Method::HTTP_POST;
+		} else {
+			self->jsonBody = false;
+			self->cstrMatcher.reset();
+		}
+	} else if(!self->jsonBody) {
+		uint32_t n = 0;
+
+		while(n < length && buff[n] != ';' && buff[n] != ' ' && buff[n] != '\t')
+			n++;
+
+		self->cstrMatcher.progressWithMatchingNoCase(jsonStr, buff, n);
+		self->jsonBody = n < length;
+	}
+}
+
 template<class Provider, class... Options>
 inline void HttpLogic<Provider, Options...>::
 parseElement(const char *at, size_t length)
 {
-	tempString.save(at, length);
+	/*
+	 * A truncated name would refer to a different resource, so the request
+	 * is rejected: the element is either in the request URL or the
+	 * Destination header (that is the only field with a path in it).
+	 */
+	if(!tempString.save(at, length) && !isError(status))
+		status = fieldParser ? HTTP_STATUS_BAD_REQUEST : HTTP_STATUS_URI_TOO_LONG;
+
+	if(davLockCount)
+		lockPath.update(at, length);
 }
 
 template<class Provider, class... Options>
@@ -445,12 +796,17 @@ beforeElement() {
 		((Provider*)this)->enterDestination(tempString.data(), tempString.length());
 
 	tempString.clear();
+
+	if(davLockCount) {
+		lockTable.enterCollection(lockPath);
+		lockPath.separator();
+	}
 }
 
 template<class Provider, class... Options>
 inline void HttpLogic<Provider, Options...>::
 elementDone() {
-	if(parseSource)
+	if(parseSource && !isError(status))
 		status = ((Provider*)this)->enterSource(tempString.data(), tempString.length());
 }
 
@@ -466,6 +822,47 @@ template<class Provider, class... Options>
 inline void HttpLogic<Provider, Options...>::
 pathDone() {
 	PathParser<HttpLogic>::done();
+
+	if(!PathParser<HttpLogic>::isValid())
+		status = HTTP_STATUS_BAD_REQUEST;
+}
+
+/*
+ * The query of the Destination header field is ignored,
+ * only the one in the request line is dispatched.
+ */
+template<class Provider, class... Options>
+inline void HttpLogic<Provider, Options...>::
+onQuery(const char* at, uint32_t length) {
+	if(!fieldParser)
+		QueryParams::parseQuery(at, length);
+}
+
+template<class Provider, class... Options>
+inline void HttpLogic<Provider, Options...>::
+queryDone() {
+	if(!fieldParser) {
+		QueryParams::done();
+
+		if(!QueryParams::isValid() && !isError(status))
+			status = HTTP_STATUS_BAD_REQUEST;
+	}
+}
+
+template<class Provider, class... Options>
+template<class Key>
+inline void HttpLogic<Provider, Options...>::
+onParameter(Key key, const char* at, uint32_t length) {
+	if(!isError(status) && QueryParams::isValid())
+		((Provider*)this)->onQueryParameter(key, at, length);
+}
+
+template<class Provider, class... Options>
+template<class Key>
+inline void HttpLogic<Provider, Options...>::
+parameterDone(Key key) {
+	if(!isError(status) && QueryParams::isValid())
+		((Provider*)this)->queryParameterDone(key);
 }
 
 template<class Provider, class... Options>
@@ -478,12 +875,15 @@ template<class Provider, class... Options>
 inline void HttpLogic<Provider, Options...>::beforeUrl() {
 	this->UrlParser<HttpLogic>::reset();
 	this->PathParser<HttpLogic>::reset();
+	this->QueryParams::reset();
+	lockPath.reset();
 
 	switch(HttpRequestParser<HttpLogic>::getMethod()) {
 		case HttpRequestParser<HttpLogic>::Method::HTTP_PUT:
 		case HttpRequestParser<HttpLogic>::Method::HTTP_POST:
 		case HttpRequestParser<HttpLogic>::Method::HTTP_MKCOL:
 		case HttpRequestParser<HttpLogic>::Method::HTTP_DELETE:
+		case HttpRequestParser<HttpLogic>::Method::HTTP_LOCK:
 			parseSource = false;
 			break;
 		default:
@@ -505,6 +905,7 @@ inline int HttpLogic<Provider, Options...>::onUrl(const char *at, size_t length)
 template<class Provider, class... Options>
 inline void HttpLogic<Provider, Options...>::afterUrl() {
 	this->UrlParser<HttpLogic>::done();
+	urlLockPath = lockPath;
 }
 
 template<class Provider, class... Options>
@@ -551,25 +952,140 @@ inline void HttpLogic<Provider, Options...>::afterHeaderValue()
 template<class Provider, class... Options>
 inline void HttpLogic<Provider, Options...>::afterHeaders()
 {
+	/*
+	 * The access rights are checked before touching the resource,
+	 * so that the request can be refused before the body arrives.
+	 */
+	checkAccess();
+
+	if(davLockCount && authState != AuthStatus::Failed && !isError(status) && isLockProtected())
+		status = HTTP_STATUS_LOCKED;
+
 	if(authState != AuthStatus::Failed && !isError(status)) {
 		switch(HttpRequestParser<HttpLogic>::getMethod()) {
 			case HttpRequestParser<HttpLogic>::Method::HTTP_PUT:
 			case HttpRequestParser<HttpLogic>::Method::HTTP_POST:
-				status = ((Provider*)this)->arrangeReceiveInto(tempString.data(), tempString.length());
+				if(jsonBody)
+					status = arrangeJsonBody();
+				else
+					status = ((Provider*)this)->arrangeReceiveInto(tempString.data(), tempString.length());
 				break;
 			case HttpRequestParser<HttpLogic>::Method::HTTP_PROPFIND:
 				davReqParser.reset();
 				break;
+			case HttpRequestParser<HttpLogic>::Method::HTTP_LOCK:
+				davLockParser.reset();
+				break;
 			default:;
 		}
 	}
+
+	if(isError(status)) {
+		if(expectation || earlyReject != RejectPolicy::Wait)
+			rejectEarly();
+	} else if(expectation) {
+		((Provider*)this)->send(continueResponse, strlen(continueResponse));
+		((Provider*)this)->flush();
+	}
 }
 
 template<class Provider, class... Options>
-inline void HttpLogic<Provider, Options...>::beforeBody() {}
+inline void HttpLogic<Provider, Options...>::beforeBody() {
+	switch(HttpRequestParser<HttpLogic>::getMethod()) {
+		case HttpRequestParser<HttpLogic>::Method::HTTP_PUT:
+		case HttpRequestParser<HttpLogic>::Method::HTTP_POST:
+			if(!jsonBody)
+				bodyBuffer.clear();
+			break;
+		default:;
+	}
+}
 
 template<class Provider, class... Options>
-inline void HttpLogic<Provider, Options...>::afterBody() {}
+inline void HttpLogic<Provider, Options...>::afterBody() {
+	switch(HttpRequestParser<HttpLogic>::getMethod()) {
+		case HttpRequestParser<HttpLogic>::Method::HTTP_PUT:
+		case HttpRequestParser<HttpLogic>::Method::HTTP_POST:
+			if(jsonBody)
+				finishJsonBody();
+			else if(bodyBufferSize && bodyBuffer.length() && authState != AuthStatus::Failed && !isError(status))
+				status = ((Provider*)this)->writeContent(bodyBuffer.data(), bodyBuffer.length());
+			break;
+		default:;
+	}
+}
+
+/*
+ * Passes the uploaded content to the provider. If batching is enabled
+ * the fragments that are smaller than the buffer are collected (ie. the
+ * short chunks of a chunked body), the bigger ones are passed directly
+ * if there is nothing collected before them.
+ */
+template<class Provider, class... Options>
+inline void HttpLogic<Provider, Options...>::writeBody(const char *at, uint32_t length) {
+	if(bodyBufferSize && length < bodyBufferSize - bodyBuffer.length()) {
+		bodyBuffer.save(at, length);
+		return;
+	}
+
+	if(bodyBufferSize && bodyBuffer.length()) {
+		const uint32_t rest = bodyBufferSize - bodyBuffer.length();
+		bodyBuffer.save(at, rest);
+		at += rest;
+		length -= rest;
+
+		status = ((Provider*)this)->writeContent(bodyBuffer.data(), bodyBuffer.length());
+		bodyBuffer.clear();
+
+		if(isError(status))
+			return;
+
+		if(length < bodyBufferSize) {
+			bodyBuffer.save(at, length);
+			return;
+		}
+	}
+
+	status = ((Provider*)this)->writeContent(at, length);
+}
+
+/*
+ * The filters that process the JSON body are selected by the provider,
+ * the parser is (re)constructed for every request as it shares memory
+ * with the other parsers.
+ */
+template<class Provider, class... Options>
+inline HttpStatus HttpLogic<Provider, Options...>::arrangeJsonBody() {
+	EntityFilter* filter = nullptr;
+	HttpStatus ret = ((Provider*)this)->arrangeJsonReceive(tempString.data(), tempString.length(), filter);
+
+	if(!isError(ret)) {
+		if(!filter)
+			return HTTP_STATUS_INTERNAL_SERVER_ERROR;
+
+		new(jsonParserStorage) JsonBodyParser();
+		jsonParser().reset(filter);
+	}
+
+	return ret;
+}
+
+template<class Provider, class... Options>
+inline typename HttpLogic<Provider, Options...>::JsonBodyParser& HttpLogic<Provider, Options...>::jsonParser() {
+	return *reinterpret_cast<JsonBodyParser*>(jsonParserStorage);
+}
+
+/*
+ * The outcome of the JSON parsing is latched into the status as soon as
+ * the body ends, nothing refers to the parser storage after that.
+ */
+template<class Provider, class... Options>
+inline void HttpLogic<Provider, Options...>::finishJsonBody() {
+	if(authState != AuthStatus::Failed && !isError(status) && (!jsonParser().done() || !jsonParser().isValid()))
+		status = HTTP_STATUS_BAD_REQUEST;
+
+	jsonBody = false;
+}
 
 template<class Provider, class... Options>
 inline int HttpLogic<Provider, Options...>::onBody(const char *at, size_t length) {
@@ -577,14 +1093,26 @@ inline int HttpLogic<Provider, Options...>::onBody(const char *at, size_t length
 		switch(HttpRequestParser<HttpLogic>::getMethod()) {
 			case HttpRequestParser<HttpLogic>::Method::HTTP_PUT:
 			case HttpRequestParser<HttpLogic>::Method::HTTP_POST:
-				status = ((Provider*)this)->writeContent(at, length);
+				if(!jsonBody)
+					writeBody(at, length);
+				else if(!jsonParser().parse(at, length) || !jsonParser().isValid())
+					status = HTTP_STATUS_BAD_REQUEST;
+
+				contentDigest.update(at, length);
 				break;
 			case HttpRequestParser<HttpLogic>::Method::HTTP_PROPFIND:
 				if(!davReqParser.parseDavRequest(at, length))
 					status = HTTP_STATUS_BAD_REQUEST;
 				break;
+			case HttpRequestParser<HttpLogic>::Method::HTTP_LOCK:
+				if(!davLockParser.parseLockRequest(at, length))
+					status = HTTP_STATUS_BAD_REQUEST;
+				break;
 			default:;
 		}
+
+		if(isError(status) && earlyReject != RejectPolicy::Wait)
+			rejectEarly();
 	}
 
 	return 0;
@@ -743,15 +1271,183 @@ inline bool HttpLogic<Provider, Options...>::generatePropfindResponse(bool file,
 	return !error;
 }
 
+template<class Provider, class... Options>
+inline bool HttpLogic<Provider, Options...>::isLockProtected()
+{
+	const uint32_t now = ((Provider*)this)->currentTime();
+
+	switch(HttpRequestParser<HttpLogic>::getMethod()) {
+		case HttpRequestParser<HttpLogic>::Method::HTTP_PUT:
+		case HttpRequestParser<HttpLogic>::Method::HTTP_POST:
+		case HttpRequestParser<HttpLogic>::Method::HTTP_MKCOL:
+			return !lockTable.permits(urlLockPath, lockTokens, now);
+		case HttpRequestParser<HttpLogic>::Method::HTTP_DELETE:
+			return !lockTable.permitsRemoval(urlLockPath, lockTokens, now);
+		case HttpRequestParser<HttpLogic>::Method::HTTP_MOVE:
+			if(!lockTable.permitsRemoval(urlLockPath, lockTokens, now))
+				return true;
+
+			/* no break */
+		case HttpRequestParser<HttpLogic>::Method::HTTP_COPY:
+			return !lockTable.permitsRemoval(lockPath, lockTokens, now);
+		default:
+			return false;
+	}
+}
+
+template<class Provider, class... Options>
+inline HttpStatus HttpLogic<Provider, Options...>::processLock(const typename LockTable::Lock* &lock)
+{
+	const uint32_t now = ((Provider*)this)->currentTime();
+
+	if(!davLockParser.done())
+		return HTTP_STATUS_BAD_REQUEST;
+
+	if(davLockParser.isRefresh()) {
+		if(!lockTokens.getCount())
+			return HTTP_STATUS_BAD_REQUEST;
+
+		lock = lockTable.refresh(lockTokens.getToken(0), urlLockPath, lockTimeout, now);
+		return lock ? HTTP_STATUS_OK : HTTP_STATUS_PRECONDITION_FAILED;
+	}
+
+	if(depth == Depth::Directory)
+		return HTTP_STATUS_BAD_REQUEST;
+
+	switch(lockTable.acquire(urlLockPath, davLockParser.isExclusiveLock(),
+			depth == Depth::Traverse, lockTimeout, now, lock)) {
+		case LockTable::Result::Conflict:
+			return HTTP_STATUS_LOCKED;
+		case LockTable::Result::Full:
+			return HTTP_STATUS_SERVICE_UNAVAILABLE;
+		default:;
+	}
+
+	HttpStatus ret = ((Provider*)this)->lockResource(tempString.data(), tempString.length());
+
+	if(isError(ret))
+		lockTable.release(lock->token, urlLockPath, now);
+
+	return ret;
+}
+
+template<class Provider, class... Options>
+inline HttpStatus HttpLogic<Provider, Options...>::processUnlock()
+{
+	if(!lockTokens.getCount())
+		return HTTP_STATUS_BAD_REQUEST;
+
+	if(!lockTable.release(lockTokens.getToken(0), urlLockPath, ((Provider*)this)->currentTime()))
+		return HTTP_STATUS_CONFLICT;
+
+	return HTTP_STATUS_NO_CONTENT;
+}
+
+template<class Provider, class... Options>
+inline void HttpLogic<Provider, Options...>::generateLockResponse(const typename LockTable::Lock* lock)
+{
+	char temp[12];
+
+	sendChunk(xmlLockHeader);
+	sendChunk(lock->exclusive ? xmlLockExclusive : xmlLockShared);
+	sendChunk(lock->deep ? "infinity" : "0");
+	sendChunk(xmlLockTimeout);
+	pet::Str::utoa<10>(lock->timeout, temp, sizeof(temp));
+	sendChunk(temp);
+	sendChunk(xmlLockToken);
+	pet::Str::utoa<16>(lock->token, temp, sizeof(temp));
+	sendChunk(temp);
+	sendChunk(xmlLockTrailer);
+	startChunk(0);
+	finishChunk();
+}
+
+template<class Provider, class... Options>
+inline void HttpLogic<Provider, Options...>::checkAccess()
+{
+	sourceAccess = ((Provider*)this)->sourceAccessible(authState == AuthStatus::Ok);
+
+	if(sourceAccess == DavAccess::AuthNeeded && authState != AuthStatus::Ok)
+		status = (authState == AuthStatus::None || staleNonce) ? HTTP_STATUS_UNAUTHORIZED : HTTP_STATUS_FORBIDDEN;
+}
+
+/*
+ * Send the error response before the body of the request is received.
+ *
+ * If the client is waiting for an interim response (ie. 'Expect: 100-continue'),
+ * it is up to the client whether it still sends the body or not, so the
+ * connection is marked to be closed. The rest of the body is ignored either way,
+ * or the processing is stopped altogether if the policy says so.
+ */
+template<class Provider, class... Options>
+inline void HttpLogic<Provider, Options...>::rejectEarly()
+{
+	beginHeaders();
+
+	if(expectation || earlyReject == RejectPolicy::Close)
+		((Provider*)this)->send(closeHeader, strlen(closeHeader));
+
+	finishErrorResponse();
+	((Provider*)this)->flush();
+	responseSent = true;
+
+	if(earlyReject == RejectPolicy::Close) {
+		this->stop();
+		((Provider*)this)->closeConnection();
+	}
+}
+
+/*
+ * Only instantiated if there is a realm, so that the string functions
+ * are not called with a null pointer even in dead code.
+ */
+template<class Provider, class... Options>
+inline void HttpLogic<Provider, Options...>::sendRealm(std::true_type)
+{
+	((Provider*)this)->send(AuthParams::realm, strlen(AuthParams::realm));
+}
+
+template<class Provider, class... Options>
+inline void HttpLogic<Provider, Options...>::finishErrorResponse()
+{
+	if(status == HTTP_STATUS_UNAUTHORIZED && AuthParams::HasRealm::value && ((uint8_t)AuthParams::schemes & (uint8_t)AuthScheme::Digest)) {
+		char nonce[DigestNonce::length];
+		DigestNonce::generate(AuthParams::nonceKey, ((Provider*)this)->currentTime(), ++nonceSerial, nonce);
+
+		const char* algorithm = AuthParams::Hash::name();
+		((Provider*)this)->send(challengeHeader, strlen(challengeHeader));
+		sendRealm(typename AuthParams::HasRealm());
+		((Provider*)this)->send(challengeNonce, strlen(challengeNonce));
+		((Provider*)this)->send(nonce, sizeof(nonce));
+		((Provider*)this)->send(challengeAlgorithm, strlen(challengeAlgorithm));
+		((Provider*)this)->send(algorithm, strlen(algorithm));
+
+		if(staleNonce)
+			((Provider*)this)->send(challengeStale, strlen(challengeStale));
+
+		((Provider*)this)->send(crLf, strlen(crLf));
+	}
+
+	if(status == HTTP_STATUS_UNAUTHORIZED && AuthParams::HasRealm::value && ((uint8_t)AuthParams::schemes & (uint8_t)AuthScheme::Basic)) {
+		((Provider*)this)->send(basicChallengeHeader, strlen(basicChallengeHeader));
+		sendRealm(typename AuthParams::HasRealm());
+		((Provider*)this)->send(basicChallengeCharset, strlen(basicChallengeCharset));
+		((Provider*)this)->send(crLf, strlen(crLf));
+	}
+
+	((Provider*)this)->send(emptyBodyHeader, strlen(emptyBodyHeader));
+	((Provider*)this)->send(crLf, strlen(crLf));
+}
 
 template<class Provider, class... Options>
 inline void HttpLogic<Provider, Options...>::afterRequest() {
 	uint32_t length;
+	const typename LockTable::Lock* lock = nullptr;
 
-	DavAccess access = ((Provider*)this)->sourceAccessible(authState == AuthStatus::Ok);
-
-	if(access == DavAccess::AuthNeeded && authState != AuthStatus::Ok)
-		status = (authState == AuthStatus::None) ? HTTP_STATUS_UNAUTHORIZED : HTTP_STATUS_FORBIDDEN;
+	if(responseSent) {
+		newRequest();
+		return;
+	}
 
 	if(!isError(status)) {
 		switch(HttpRequestParser<HttpLogic>::getMethod()) {
@@ -766,32 +1462,44 @@ inline void HttpLogic<Provider, Options...>::afterRequest() {
 
 			case HttpRequestParser<HttpLogic>::Method::HTTP_PUT:
 			case HttpRequestParser<HttpLogic>::Method::HTTP_POST:
-				status = ((Provider*)this)->contentWritten();
+				// The content is only finalized if it is not corrupted,
+				// otherwise the provider is given a chance to roll it back.
+				if(jsonBody)
+					finishJsonBody();
+
+				if(!isError(status)) {
+					if(contentDigest.matches()) {
+						status = ((Provider*)this)->contentWritten();
+					} else {
+						((Provider*)this)->contentDiscarded();
+						status = HTTP_STATUS_BAD_REQUEST;
+					}
+				}
 				break;
 
 			case HttpRequestParser<HttpLogic>::Method::HTTP_COPY:
-				if(access == DavAccess::NoDav)
+				if(sourceAccess == DavAccess::NoDav)
 					status = HTTP_STATUS_METHOD_NOT_ALLOWED;
 				else
 				status = ((Provider*)this)->copy(tempString.data(), tempString.length(), overwrite);
 				break;
 
 			case HttpRequestParser<HttpLogic>::Method::HTTP_MKCOL:
-				if(access == DavAccess::NoDav)
+				if(sourceAccess == DavAccess::NoDav)
 					status = HTTP_STATUS_METHOD_NOT_ALLOWED;
 				else
 				status = ((Provider*)this)->createDirectory(tempString.data(), tempString.length());
 				break;
 
 			case HttpRequestParser<HttpLogic>::Method::HTTP_MOVE:
-				if(access == DavAccess::NoDav)
+				if(sourceAccess == DavAccess::NoDav)
 					status = HTTP_STATUS_METHOD_NOT_ALLOWED;
 				else
 					status = ((Provider*)this)->move(tempString.data(), tempString.length(), overwrite);
 				break;
 
 			case HttpRequestParser<HttpLogic>::Method::HTTP_PROPFIND:
-				if(access == DavAccess::NoDav)
+				if(sourceAccess == DavAccess::NoDav)
 					status = HTTP_STATUS_METHOD_NOT_ALLOWED;
 				else if(!davReqParser.done())
 					status = HTTP_STATUS_BAD_REQUEST;
@@ -808,6 +1516,20 @@ inline void HttpLogic<Provider, Options...>::afterRequest() {
 				}
 				break;
 
+			case HttpRequestParser<HttpLogic>::Method::HTTP_LOCK:
+				if(sourceAccess == DavAccess::NoDav || !davLockCount)
+					status = HTTP_STATUS_METHOD_NOT_ALLOWED;
+				else
+					status = processLock(lock);
+				break;
+
+			case HttpRequestParser<HttpLogic>::Method::HTTP_UNLOCK:
+				if(sourceAccess == DavAccess::NoDav || !davLockCount)
+					status = HTTP_STATUS_METHOD_NOT_ALLOWED;
+				else
+					status = processUnlock();
+				break;
+
 			case HttpRequestParser<HttpLogic>::Method::HTTP_OPTIONS:
 				status = HTTP_STATUS_OK;
 				break;
@@ -838,10 +1560,27 @@ inline void HttpLogic<Provider, Options...>::afterRequest() {
 				break;
 			}
 
+			case HttpRequestParser<HttpLogic>::Method::HTTP_LOCK: {
+				if(!davLockParser.isRefresh()) {
+					char temp[12];
+					((Provider*)this)->send(lockTokenHeader, strlen(lockTokenHeader));
+					pet::Str::utoa<16>(lock->token, temp, sizeof(temp));
+					((Provider*)this)->send(temp, strlen(temp));
+					((Provider*)this)->send(lockTokenTrailer, strlen(lockTokenTrailer));
+				}
+
+				((Provider*)this)->send(xmlContentTypeHeader, strlen(xmlContentTypeHeader));
+				((Provider*)this)->send(chunkedHeader, strlen(chunkedHeader));
+				break;
+			}
+
 			case HttpRequestParser<HttpLogic>::Method::HTTP_OPTIONS:
-				if(access == DavAccess::NoDav)
+				if(sourceAccess == DavAccess::NoDav)
 					((Provider*)this)->send(allowStrNoDav, strlen(allowStrNoDav));
-				else {
+				else if(davLockCount) {
+					((Provider*)this)->send(allowStrDavLock, strlen(allowStrDavLock));
+					((Provider*)this)->send(davLockHeader, strlen(davLockHeader));
+				} else {
 					((Provider*)this)->send(allowStrDav, strlen(allowStrDav));
 					((Provider*)this)->send(davHeader, strlen(davHeader));
 				}
@@ -895,6 +1634,9 @@ inline void HttpLogic<Provider, Options...>::afterRequest() {
 				startChunk(0);
 				finishChunk();
 
+				break;
+			case HttpRequestParser<HttpLogic>::Method::HTTP_LOCK:
+				generateLockResponse(lock);
 				break;
 			default:;
 		}
@@ -903,14 +1645,8 @@ inline void HttpLogic<Provider, Options...>::afterRequest() {
 			status = HTTP_STATUS_INTERNAL_SERVER_ERROR;
 			// closeConnection();
 		}
-	} else {
-		if(status == HTTP_STATUS_UNAUTHORIZED) {
-			// TODO send WWW-Authenticate header
-		}
-
-		((Provider*)this)->send(emptyBodyHeader, strlen(emptyBodyHeader));
-		((Provider*)this)->send(crLf, strlen(crLf));
-	}
+	} else
+		finishErrorResponse();
 
 	((Provider*)this)->flush();
 
@@ -923,6 +1659,12 @@ inline HttpStatus HttpLogic<Provider, Options...>::getStatus()
 	return status;
 }
 
+template<class Provider, class... Options>
+inline void HttpLogic<Provider, Options...>::resetLocks(uint32_t seed)
+{
+	lockTable.reset(seed);
+}
+
 template<class Provider, class... Options>
 typename HttpLogic<Provider, Options...>::AuthStatus
 inline HttpLogic<Provider, Options...>::getAuthStatus()
@@ -930,6 +1672,12 @@ inline HttpLogic<Provider, Options...>::getAuthStatus()
 	return authState;
 }
 
+template<class Provider, class... Options>
+inline const char* HttpLogic<Provider, Options...>::getAuthUser()
+{
+	return authUser;
+}
+
 #define XX(num, name, string) case HTTP_STATUS_##name: return "HTTP/1.1 " #num " " #string "\r\n";
 
 template<class Provider, class... Options>
@@ -957,8 +1705,24 @@ HttpLogic<Provider, Options...>::headerKeywords({
 	typename HeaderKeywords::Keyword("Overwrite", &HttpLogic<Provider, Options...>::parseOverwrite),
 	typename HeaderKeywords::Keyword("Destination", &HttpLogic<Provider, Options...>::parseDestination),
 	typename HeaderKeywords::Keyword("Authorization", &HttpLogic<Provider, Options...>::parseAuthorization),
+	typename HeaderKeywords::Keyword("If", &HttpLogic<Provider, Options...>::parseLockToken),
+	typename HeaderKeywords::Keyword("Lock-Token", &HttpLogic<Provider, Options...>::parseLockToken),
+	typename HeaderKeywords::Keyword("Timeout", &HttpLogic<Provider, Options...>::parseTimeout),
+	typename HeaderKeywords::Keyword("Expect", &HttpLogic<Provider, Options...>::parseExpect),
+	typename HeaderKeywords::Keyword("Content-MD5", &HttpLogic<Provider, Options...>::parseContentMd5),
+	typename HeaderKeywords::Keyword("Digest", &HttpLogic<Provider, Options...>::parseDigest),
+	typename HeaderKeywords::Keyword("Content-Type", &HttpLogic<Provider, Options...>::parseContentType),
 });
 
+template<class Provider, class... Options>
+typename HttpLogic<Provider, Options...>::LockTable HttpLogic<Provider, Options...>::lockTable;
+
+template<class Provider, class... Options>
+typename HttpLogic<Provider, Options...>::NonceCounter HttpLogic<Provider, Options...>::nonceCounter;
+
+template<class Provider, class... Options>
+uint32_t HttpLogic<Provider, Options...>::nonceSerial;
+
 template<class Provider, class... Options>
 const typename HttpLogic<Provider, Options...>::DepthKeywords
 HttpLogic<Provider, Options...>::depthKeywords({
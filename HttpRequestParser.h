@@ -33,7 +33,7 @@ class HttpRequestParser: http_parser {
 	static int onNgnixMessageComplete(http_parser*);
 
 	enum class State: uint8_t {
-		Initial, Url, HeaderName, HeaderValue, Body, Done
+		Initial, Url, HeaderName, HeaderValue, Headers, Body, Trailer, Done
 	};
 
 	State hState;
@@ -64,6 +64,7 @@ protected:
 	inline void newRequest();
 
 	inline bool shouldKeepAlive();
+	inline void stop();
 public:
 	typedef http_method Method;
 	inline Method getMethod() {return (Method)method;}
@@ -90,6 +91,11 @@ inline bool HttpRequestParser<Child>::shouldKeepAlive() {
 	return http_should_keep_alive(this);
 }
 
+template<class Child>
+inline void HttpRequestParser<Child>::stop() {
+	http_parser_pause(this, 1);
+}
+
 template<class Child>
 inline void HttpRequestParser<Child>::reset()
 {
@@ -136,6 +142,20 @@ int HttpRequestParser<Child>::onNgnixHeaderField(http_parser* self, const char *
 	HttpRequestParser* me = (HttpRequestParser*)self;
 	Child* child = (Child*) me;
 
+	/*
+	 * The fields after the headers are the trailer section of a chunked
+	 * body, these are not merged into the header (RFC 9110 section 6.5.1)
+	 * so they are skipped, only the end of the body is signaled on the
+	 * first one, before the child could reuse anything it holds for it.
+	 */
+	if(me->hState == State::Headers || me->hState == State::Body || me->hState == State::Trailer) {
+		if(me->hState == State::Body)
+			child->afterBody();
+
+		me->hState = State::Trailer;
+		return 0;
+	}
+
 	if(me->hState != State::HeaderName) {
 		if(me->hState == State::Url)
 			child->afterUrl();
@@ -157,6 +177,9 @@ int HttpRequestParser<Child>::onNgnixHeaderValue(http_parser* self, const char *
 	HttpRequestParser* me = (HttpRequestParser*)self;
 	Child* child = (Child*) me;
 
+	if(me->hState == State::Trailer)
+		return 0;
+
 	if(me->hState != State::HeaderValue) {
 		if(me->hState == State::HeaderName)
 			child->afterHeaderName();
@@ -181,6 +204,7 @@ int HttpRequestParser<Child>::onNgnixHeadersComplete(http_parser* self)
 	else if(me->hState == State::HeaderValue)
 		child->afterHeaderValue();
 
+	me->hState = State::Headers;
 	child->afterHeaders();
 
 	return 0;
@@ -105,10 +105,19 @@ private:
 	virtual void onNull() {}
 	virtual void onBoolean(bool) {}
 	virtual void onNumber(int32_t value) {}
+	virtual void onDouble(double value) {}
 	virtual void onString(const char *at, size_t length) {}
 	virtual void afterValue(JsonValueType) {}
+
+	/// Called when the parent object moves past the member that has triggered this filter.
 	virtual void onParentLeave() {}
 
+	/// Integers are passed on as _onNumber_ if they fit.
+	virtual void onInteger(int64_t value) {
+		if(INT32_MIN <= value && value <= INT32_MAX)
+			onNumber((int32_t)value);
+	}
+
 public:
 	/**
 	 * Reset function, to be called before processing a new document.
@@ -220,12 +229,15 @@ class ObjectFilter: public EntityFilter {
 
 public:
 	/**
-	 * _Keywords_ matecher based on the specified names.
+	 * Hashed _Keywords_ matcher based on the specified names.
 	 */
-	typedef Keywords<EntityFilter*, n> Kw;
+	typedef HashedKeywords<EntityFilter*, n> Kw;
 	typename Kw::Matcher matcher;
 	Kw kw;
 
+	/// The child entered for the current member (if any).
+	EntityFilter* active;
+
 	template<class... T>
 	inline ObjectFilter(T... t): kw{typename Kw::Keyword(t.name, t.child)...} {}
 	inline virtual ~ObjectFilter() {}
@@ -234,6 +246,7 @@ protected:
 	/// Reset the common parser state, also reset children.
 	inline virtual void reset(EntityFilter* parent) override {
 		EntityFilter::reset(parent);
+		active = nullptr;
 
 		for(auto e: kw)
 			e.getValue()->reset(this);
@@ -251,22 +264,31 @@ protected:
 			matcher.progress(kw, at, length);
 	}
 
-	/// Check for a keyword match, enter children if needed.
+	/// Notify the previous child, check for a keyword match, enter child if needed.
 	inline virtual void beforeValue(Parser* parser, JsonValueType type) override {
 		if(getDepth() == 1) {
+			leaveActive();
+
 			if(const typename Kw::Keyword* result = matcher.match(kw)) {
-				EntityFilter* child = result->getValue();
-				parser->enter(child);
-				child->beforeValue(parser, type);
+				active = result->getValue();
+				parser->enter(active);
+				active->beforeValue(parser, type);
 			}
 		}
 	}
 
+	/// Notify the last child at the end of the object.
 	inline virtual void afterValue(JsonValueType) override
 	{
-		if(getDepth() == 1) {
-			for(const auto &k : kw)
-				k.getValue()->onParentLeave();
+		if(getDepth() == 1)
+			leaveActive();
+	}
+
+private:
+	inline void leaveActive() {
+		if(active) {
+			active->onParentLeave();
+			active = nullptr;
 		}
 	}
 };
@@ -284,6 +306,24 @@ public:
 	inline NumberExtractor(int &result): result(result) {}
 };
 
+/// Leaf filter to extract numeric value with fraction or exponent.
+class DoubleExtractor: public EntityFilter {
+	/// Reference to the output storage.
+	double &result;
+
+	/// Write output when number is received.
+	inline virtual void onDouble(double value) override {
+		result = value;
+	}
+
+	/// Integers are also accepted.
+	inline virtual void onInteger(int64_t value) override {
+		result = (double)value;
+	}
+public:
+	inline DoubleExtractor(double &result): result(result) {}
+};
+
 /// Leaf filter to extract boolean value.
 class BoolExtractor: public EntityFilter {
 	/// Reference to the output storage.
@@ -321,7 +361,7 @@ class StringExtractor: public EntityFilter {
 
 	/// Copy data to the end of the output.
 	inline virtual void onString(const char *at, size_t length) override {
-		while(offset < n-1)
+		while(length-- && offset < n-1)
 			result[offset++] = *at++;
 	}
 
@@ -384,9 +424,14 @@ class JsonParser: public UJson<JsonParser<maxDepth>, maxDepth>, public EntityFil
                 filter->onBoolean(x);
         }
 
-        inline void onNumber(int32_t value) {
+        inline void onInteger(int64_t value) {
+            if(!error)
+                filter->onInteger(value);
+        }
+
+        inline void onDouble(double value) {
             if(!error)
-                filter->onNumber(value);
+                filter->onDouble(value);
         }
 
         inline void onString(const char *at, size_t length) {
@@ -421,6 +466,11 @@ class JsonParser: public UJson<JsonParser<maxDepth>, maxDepth>, public EntityFil
             this->filter->reset(nullptr);
         }
 
+        /// Returns true if no error was encountered so far.
+        inline bool isValid() {
+            return !error;
+        }
+
         inline virtual ~JsonParser(){}
 };
 
@@ -212,4 +212,256 @@ public:
 	};
 };
 
+/**
+ * Argument independent mutable hashed keyword matcher state.
+ *
+ * Accumulates the FNV-1a hash and the length of arbitrarily fragmented
+ * input, the cost of processing is constant per character.
+ */
+struct KeywordHash {
+	static constexpr uint32_t offsetBasis = 2166136261u;
+	static constexpr uint32_t prime = 16777619u;
+
+	/// Hash of the input processed so far.
+	uint32_t hash;
+
+	/// Length of the input processed so far.
+	uint32_t length;
+
+	/// Compile-time capable hash of a zero-terminated string.
+	static constexpr uint32_t of(const char* str, uint32_t hash = offsetBasis) {
+		return *str ? of(str + 1, (hash ^ (uint8_t)*str) * prime) : hash;
+	}
+
+	/// Compile-time capable hash of the first _n_ characters of a string.
+	static constexpr uint32_t prefixOf(const char* str, uint32_t n, uint32_t hash = offsetBasis) {
+		return n ? prefixOf(str + 1, n - 1, (hash ^ (uint8_t)*str) * prime) : hash;
+	}
+
+	/// Compile-time capable length of a zero-terminated string.
+	static constexpr uint32_t lengthOf(const char* str, uint32_t length = 0) {
+		return *str ? lengthOf(str + 1, length + 1) : length;
+	}
+
+	/// Compile-time capable length of the common prefix of two strings.
+	static constexpr uint32_t commonPrefix(const char* a, const char* b, uint32_t n = 0) {
+		return (a[n] && a[n] == b[n]) ? commonPrefix(a, b, n + 1) : n;
+	}
+
+	/// Initialize internal state.
+	inline void reset() {
+		hash = offsetBasis;
+		length = 0;
+	}
+
+	/// Process a block of input data.
+	inline void progress(const char* str, uint32_t len) {
+		uint32_t h = hash;
+		length += len;
+
+		while(len--)
+			h = (h ^ (uint8_t)*str++) * prime;
+
+		hash = h;
+	}
+
+	/// Process a single character.
+	inline void progress(char c) {
+		hash = (hash ^ (uint8_t)c) * prime;
+		length++;
+	}
+};
+
+/**
+ * Hashed keyword set descriptor.
+ *
+ * Same as the _Keywords_ but the lookups are done in open addressed hash
+ * tables, so the cost of matching does not depend on the number of keywords.
+ *
+ * The input is not stored, instead it is compared to a candidate keyword as
+ * it arrives: the first one (in the order of definition) that starts with
+ * the input processed so far. When the input departs from the candidate, the
+ * next one is the first keyword that has the same prefix up to and including
+ * the new character. These branching points are looked up by the hash of the
+ * prefix, and a hit is confirmed by comparing the keys, so a colliding input
+ * can not be matched as a different keyword.
+ */
+template<class T, unsigned int N>
+class HashedKeywords {
+	static_assert(N > 0 && N < 0xff, "Invalid number of keywords");
+
+public:
+	/// Number of slots of the hash tables, at most half of them are used.
+	static constexpr unsigned int tableSize = (N <= 2) ? 4 : (N <= 4) ? 8 : (N <= 8) ? 16 : (N <= 16) ? 32 :
+			(N <= 32) ? 64 : (N <= 64) ? 128 : (N <= 128) ? 256 : 512;
+
+	/// Index of no keyword.
+	static constexpr uint8_t none = 0xff;
+
+	/**
+	 * Keyword entry.
+	 *
+	 * The key and its hash and length paired with the associated value.
+	 */
+	class Keyword {
+		friend HashedKeywords;
+		const char* key;
+		uint32_t hash;
+		uint32_t length;
+
+		/// Hash and length of the shortest prefix not shared with the preceding keys (zero length if none).
+		uint32_t branchHash;
+		uint32_t branchLength;
+		T value;
+	public:
+		/// Argument forwarding constructor.
+		template<class... V>
+		explicit constexpr Keyword(const char* key, const V&... args):
+			key(key), hash(KeywordHash::of(key)), length(KeywordHash::lengthOf(key)),
+			branchHash(0), branchLength(0), value(args...) {}
+
+		/// Read only key accessor.
+		inline const char* getKey() const {
+			return key;
+		}
+
+		/// Read only value accessor.
+		inline const T getValue() const {
+			return value;
+		}
+	};
+
+private:
+	/// Storage of the mappings.
+	Keyword words[N];
+
+	/// Hash tables, one plus the index of the mapping or zero for an empty slot.
+	uint8_t slots[tableSize], branches[tableSize];
+
+	static inline void insert(uint8_t* table, uint32_t hash, unsigned int i) {
+		unsigned int idx = hash & (tableSize - 1);
+
+		while(table[idx])
+			idx = (idx + 1) & (tableSize - 1);
+
+		table[idx] = (uint8_t)(i + 1);
+	}
+
+	/*
+	 * The first keyword needs no branch entry, as it is the initial candidate,
+	 * the ones that are prefixes of a preceding one are never branched to.
+	 */
+	inline void setBranch(unsigned int i) {
+		uint32_t shared = 0;
+
+		for(unsigned int j = 0; j < i; j++) {
+			const uint32_t common = KeywordHash::commonPrefix(words[i].key, words[j].key);
+
+			if(common > shared)
+				shared = common;
+		}
+
+		if(i && shared < words[i].length) {
+			words[i].branchLength = shared + 1;
+			words[i].branchHash = KeywordHash::prefixOf(words[i].key, shared + 1);
+			insert(branches, words[i].branchHash, i);
+		}
+	}
+
+public:
+	template<class... V>
+	inline HashedKeywords(V... args): words{args...}, slots{0,}, branches{0,} {
+		for(unsigned int i = 0; i < N; i++) {
+			insert(slots, words[i].hash, i);
+			setBranch(i);
+		}
+	}
+
+	/// STL compatible accessor for iterating over the stored mappings.
+	const Keyword* begin() {
+		return words;
+	}
+
+	/// STL compatible accessor for iterating over the stored mappings.
+	const Keyword* end() {
+		return words + N;
+	}
+
+	/// Matcher object, the candidate is followed as the input arrives.
+	class Matcher: KeywordHash {
+		/// Index of the candidate keyword or _none_ if no keyword starts with the input.
+		uint8_t candidate;
+
+	public:
+		inline void reset() {
+			KeywordHash::reset();
+			candidate = 0;
+		}
+
+		/**
+		 * Process a block of input data.
+		 *
+		 * The candidate is checked one character at a time, the
+		 * hash table is only consulted when the input departs.
+		 */
+		inline void progress(const HashedKeywords& kw, const char* str, uint32_t len) {
+			for(; len && candidate != none; len--) {
+				const char c = *str++;
+				const Keyword* current = &kw.words[candidate];
+				const uint32_t l = length;
+
+				KeywordHash::progress(c);
+
+				if(l < current->length && current->key[l] == c)
+					continue;
+
+				candidate = none;
+
+				for(unsigned int idx = hash & (tableSize - 1); kw.branches[idx]; idx = (idx + 1) & (tableSize - 1)) {
+					const Keyword* next = &kw.words[kw.branches[idx] - 1];
+
+					if(next->branchHash == hash && next->branchLength == length && next->key[l] == c &&
+							strncmp(next->key, current->key, l) == 0) {
+						candidate = (uint8_t)(kw.branches[idx] - 1);
+						break;
+					}
+				}
+			}
+		}
+
+		inline void progress(const HashedKeywords& kw, const char* str) {
+			progress(kw, str, strlen(str));
+		}
+
+		/**
+		 * Look up the input processed so far.
+		 *
+		 * If it is not the whole candidate, it can only be a shorter key
+		 * that is the prefix of the candidate, which is confirmed the same
+		 * way as the branches.
+		 *
+		 * @return Returns the matched result (the first one of the
+		 * same keys), or null if there is none.
+		 */
+		inline const Keyword* match(const HashedKeywords& kw) const {
+			if(candidate == none)
+				return 0;
+
+			const Keyword* current = &kw.words[candidate];
+
+			if(current->length == length)
+				return current;
+
+			for(unsigned int idx = hash & (tableSize - 1); kw.slots[idx]; idx = (idx + 1) & (tableSize - 1)) {
+				const Keyword* result = &kw.words[kw.slots[idx] - 1];
+
+				if(result->hash == hash && result->length == length && strncmp(result->key, current->key, length) == 0)
+					return result;
+			}
+
+			return 0;
+		}
+	};
+};
+
 #endif /* KEYWORDS_H_ */
@@ -0,0 +1,392 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2017 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+#ifndef MULTIPARTPARSER_H_
+#define MULTIPARTPARSER_H_
+
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * Non-buffering, zero-copy multipart (RFC 2046) parser, for processing
+ * multipart/form-data (RFC 7578) request bodies, as sent by browsers for
+ * file uploads.
+ *
+ * The part headers and bodies are passed to the user supplied CRTP
+ * related Child class's callbacks directly from the input, so the data
+ * can be arbitrarily sliced. Part header values are not interpreted
+ * (for example the Content-Disposition field can be processed with
+ * the Splitter and the KvParser).
+ *
+ * The boundary is either specified explicitly (as taken from the
+ * Content-Type header field), or it is learned from the first line of
+ * the body, which works if there is no preamble (browsers do not send
+ * any). The boundary can not contain CR characters (a stricter limit
+ * is imposed by the standard), so a partial match of the delimiter can
+ * only restart at the CR that starts it. Thus the delimiter is searched
+ * for with memchr (that is usually vectorized), and no skip table is
+ * needed. If a partial match at the end of a block turns out to be part
+ * of the content, the matched prefix is fed from the stored delimiter.
+ *
+ * It is non-validating in the sense that the part headers are not
+ * checked, but a missing close delimiter is detected.
+ */
+template<class Child, unsigned int maxBoundary = 70>
+class MultipartParser {
+	static_assert(maxBoundary < 0xff - 4, "The boundary can not be that long");
+
+	/// The dashes and the line break before the boundary.
+	static constexpr const char* delimiterStart() { return "\r\n--"; }
+
+	/// Input processing state.
+	enum class State: uint8_t {
+		LearnDashes,
+		LearnBoundary,
+		Preamble,
+		AfterDelimiter,
+		DelimiterLf,
+		CloseDash,
+		HeaderStart,
+		HeaderName,
+		HeaderSpace,
+		HeaderValue,
+		HeaderLf,
+		HeadersLf,
+		Body,
+		Epilogue,
+		Error
+	};
+
+	/// Main input processing state.
+	State state;
+
+	/// Number of characters of the delimiter matched (or dashes read when learning).
+	uint8_t matched;
+
+	/// Length of the boundary.
+	uint8_t boundaryLength;
+
+	/// Storage of the boundary (without the leading dashes).
+	char boundary[maxBoundary];
+
+	inline char delimiterChar(uint8_t idx);
+	inline bool searchDelimiter(const char* &buff, const char* end, bool content);
+
+protected:
+	/*
+	 * Callbacks, to be overridden by the user.
+	 */
+	inline void onPartStart() {}
+	inline void onHeaderName(const char* buff, uint32_t length) {}
+	inline void onHeaderNameEnd() {}
+	inline void onHeaderValue(const char* buff, uint32_t length) {}
+	inline void onHeaderValueEnd() {}
+	inline void onPartBody(const char* buff, uint32_t length) {}
+	inline void onPartEnd() {}
+
+public:
+	inline void reset();
+	inline bool reset(const char* boundary, uint32_t length);
+	inline bool parseMultipart(const char* buff, uint32_t length);
+	inline bool done();
+};
+
+/*
+ * Returns the character of the delimiter at the specified index.
+ */
+template<class Child, unsigned int maxBoundary>
+inline char MultipartParser<Child, maxBoundary>::delimiterChar(uint8_t idx)
+{
+	return (idx < 4) ? delimiterStart()[idx] : boundary[idx - 4];
+}
+
+/*
+ * Looks for the delimiter, the content before it is passed to the
+ * user if the _content_ flag is set. Returns true if the delimiter
+ * is found, in that case the data pointer is moved after it.
+ */
+template<class Child, unsigned int maxBoundary>
+inline bool MultipartParser<Child, maxBoundary>::searchDelimiter(const char* &buff, const char* end, bool content)
+{
+	while(buff != end) {
+		if(matched) {
+			if(*buff == delimiterChar(matched)) {
+				buff++;
+
+				if(++matched == boundaryLength + 4) {
+					matched = 0;
+					return true;
+				}
+
+				continue;
+			}
+
+			/*
+			 * Mismatch, the matched part is content and the current
+			 * character is not processed yet, it may be a CR.
+			 */
+			if(content) {
+				((Child*)this)->onPartBody(delimiterStart(), matched < 4 ? matched : 4);
+
+				if(matched > 4)
+					((Child*)this)->onPartBody(boundary, matched - 4);
+			}
+
+			matched = 0;
+		}
+
+		const char* cr = (const char*)memchr(buff, '\r', end - buff);
+		const char* next = cr ? cr : end;
+
+		if(content && next != buff)
+			((Child*)this)->onPartBody(buff, next - buff);
+
+		if(!cr) {
+			buff = end;
+			break;
+		}
+
+		buff = cr + 1;
+		matched = 1;
+	}
+
+	return false;
+}
+
+/*
+ * Resets the internal state to initial values, the boundary
+ * is learned from the first line of the body.
+ */
+template<class Child, unsigned int maxBoundary>
+inline void MultipartParser<Child, maxBoundary>::reset()
+{
+	state = State::LearnDashes;
+	matched = 0;
+	boundaryLength = 0;
+}
+
+/*
+ * Resets the internal state to initial values, with the boundary
+ * specified explicitly. Returns false if it is too long or invalid.
+ */
+template<class Child, unsigned int maxBoundary>
+inline bool MultipartParser<Child, maxBoundary>::reset(const char* boundary, uint32_t length)
+{
+	if(!length || length > maxBoundary || memchr(boundary, '\r', length)) {
+		state = State::Error;
+		return false;
+	}
+
+	memcpy(this->boundary, boundary, length);
+	boundaryLength = length;
+
+	/*
+	 * The first delimiter may be at the very beginning of the
+	 * body, so the line break before it is considered matched.
+	 */
+	state = State::Preamble;
+	matched = 2;
+	return true;
+}
+
+/*
+ * Parses a block of input, it can be arbitrarily segmented.
+ */
+template<class Child, unsigned int maxBoundary>
+inline bool MultipartParser<Child, maxBoundary>::parseMultipart(const char* buff, uint32_t length)
+{
+	const char* const end = buff + length;
+	const char* start;
+
+	while(buff != end) {
+		switch(state) {
+		case State::LearnDashes:
+			if(*buff++ != '-') {
+				state = State::Error;
+				return false;
+			}
+
+			if(++matched == 2) {
+				matched = 0;
+				state = State::LearnBoundary;
+			}
+			break;
+
+		case State::LearnBoundary:
+			if(*buff == '\r' || *buff == ' ' || *buff == '\t') {
+				if(!boundaryLength) {
+					state = State::Error;
+					return false;
+				}
+
+				state = State::AfterDelimiter;
+				break;
+			}
+
+			if(boundaryLength == maxBoundary) {
+				state = State::Error;
+				return false;
+			}
+
+			boundary[boundaryLength++] = *buff++;
+			break;
+
+		case State::Preamble:
+			if(searchDelimiter(buff, end, false))
+				state = State::AfterDelimiter;
+			break;
+
+		/*
+		 * After a delimiter either a line break or two dashes
+		 * (for the close delimiter) is expected, optionally
+		 * preceded by whitespace (transport padding).
+		 */
+		case State::AfterDelimiter:
+			if(*buff == ' ' || *buff == '\t') {
+				buff++;
+			} else if(*buff == '\r') {
+				buff++;
+				state = State::DelimiterLf;
+			} else if(*buff == '-') {
+				buff++;
+				state = State::CloseDash;
+			} else {
+				state = State::Error;
+				return false;
+			}
+			break;
+
+		case State::DelimiterLf:
+			if(*buff++ != '\n') {
+				state = State::Error;
+				return false;
+			}
+
+			((Child*)this)->onPartStart();
+			state = State::HeaderStart;
+			break;
+
+		case State::CloseDash:
+			if(*buff++ != '-') {
+				state = State::Error;
+				return false;
+			}
+
+			state = State::Epilogue;
+			break;
+
+		/*
+		 * Either a header field or the empty line before the body.
+		 */
+		case State::HeaderStart:
+			if(*buff == '\r') {
+				buff++;
+				state = State::HeadersLf;
+				break;
+			}
+
+			state = State::HeaderName;
+
+		/*
+		 * There is no break, to allow fall-through in the common case.
+		 */
+		case State::HeaderName:
+			start = buff;
+			while(buff != end && *buff != ':' && *buff != '\r')
+				buff++;
+
+			if(buff != start)
+				((Child*)this)->onHeaderName(start, buff - start);
+
+			if(buff == end)
+				return true;
+
+			if(*buff++ != ':') {
+				state = State::Error;
+				return false;
+			}
+
+			((Child*)this)->onHeaderNameEnd();
+			state = State::HeaderSpace;
+			break;
+
+		case State::HeaderSpace:
+			if(*buff == ' ' || *buff == '\t') {
+				buff++;
+				break;
+			}
+
+			state = State::HeaderValue;
+
+		/*
+		 * There is no break, to allow fall-through in the common case.
+		 */
+		case State::HeaderValue:
+			start = buff;
+			while(buff != end && *buff != '\r')
+				buff++;
+
+			if(buff != start)
+				((Child*)this)->onHeaderValue(start, buff - start);
+
+			if(buff == end)
+				return true;
+
+			buff++;
+			((Child*)this)->onHeaderValueEnd();
+			state = State::HeaderLf;
+			break;
+
+		case State::HeaderLf:
+		case State::HeadersLf:
+			if(*buff++ != '\n') {
+				state = State::Error;
+				return false;
+			}
+
+			state = (state == State::HeaderLf) ? State::HeaderStart : State::Body;
+			break;
+
+		case State::Body:
+			if(searchDelimiter(buff, end, true)) {
+				((Child*)this)->onPartEnd();
+				state = State::AfterDelimiter;
+			}
+			break;
+
+		case State::Epilogue:
+			return true;
+
+		default:
+			return false;
+		}
+	}
+
+	return state != State::Error;
+}
+
+/*
+ * Finalizes parsing, returns true if the close delimiter has been found.
+ */
+template<class Child, unsigned int maxBoundary>
+inline bool MultipartParser<Child, maxBoundary>::done()
+{
+	return state == State::Epilogue;
+}
+
+#endif /* MULTIPARTPARSER_H_ */
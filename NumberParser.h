@@ -0,0 +1,233 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2017 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#ifndef NUMBERPARSER_H_
+#define NUMBERPARSER_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * Non-buffered parser for numbers in the JSON format (RFC8259).
+ *
+ * The significant digits are accumulated in a 64-bit mantissa as they
+ * are received, along with the decimal exponent, so the internal state
+ * is the same few bytes regardless of the length of the number or the
+ * fragmentation of the input.
+ *
+ * Numbers without fraction and exponent that fit are provided as 64-bit
+ * integers, everything else is converted to double. The conversion is
+ * exact (and cheap) if the mantissa and the power of ten are both exactly
+ * representable as a double (Clinger's fast path), which covers the usual
+ * measured values with a few decimal digits. Otherwise it falls back to
+ * the correctly rounding _strtod_ on the canonical form of the number.
+ * Digits after the nineteenth significant one are only taken into account
+ * as a non-zero tail, so the conversion of such numbers may be off by an
+ * ulp in rare halfway cases.
+ */
+class NumberParser {
+    /// Accumulated significant digits.
+    uint64_t mantissa;
+
+    /// Decimal exponent implied by the position of the decimal point.
+    int32_t pointExponent;
+
+    /// Value of the explicit exponent (saturated).
+    uint16_t exponent;
+
+    /// Number of significant digits in the mantissa.
+    uint8_t digits;
+
+    enum class State: uint8_t {
+        Start, Minus, Zero, Integer, Point, Fraction, E, ExponentSign, Exponent, Invalid
+    } state;
+
+    bool negative, negativeExponent, truncated;
+
+    static constexpr uint8_t maxDigits = 19;
+    static constexpr uint16_t maxExponent = 9999;
+
+    static inline bool isDigit(char c) {
+        return '0' <= c && c <= '9';
+    }
+
+    inline void addDigit(char c, bool fractional) {
+        const uint8_t d = c - '0';
+
+        if(digits < maxDigits) {
+            mantissa = mantissa * 10 + d;
+
+            if(mantissa)
+                digits++;
+
+            if(fractional)
+                pointExponent--;
+        } else {
+            if(!fractional)
+                pointExponent++;
+
+            if(d)
+                truncated = true;
+        }
+    }
+
+    inline int32_t decimalExponent() {
+        return pointExponent + (negativeExponent ? -(int32_t)exponent : (int32_t)exponent);
+    }
+
+    static inline double pow10(int32_t exp) {
+        static constexpr double powers[] = {
+            1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+        };
+
+        return powers[exp];
+    }
+
+public:
+    inline void reset() {
+        mantissa = 0;
+        pointExponent = 0;
+        exponent = 0;
+        digits = 0;
+        state = State::Start;
+        negative = negativeExponent = truncated = false;
+    }
+
+    /**
+     * Process a fragment of the number, returns false if it is
+     * found to be invalid (then all further input is ignored).
+     */
+    inline bool parse(const char *at, uint32_t length)
+    {
+        for(; length--; at++) {
+            const char c = *at;
+
+            switch(state) {
+                case State::Start:
+                    if(c == '-') {
+                        negative = true;
+                        state = State::Minus;
+                        break;
+                    }
+
+                    /* no break */
+                case State::Minus:
+                    if(c == '0')
+                        state = State::Zero;
+                    else if(isDigit(c)) {
+                        addDigit(c, false);
+                        state = State::Integer;
+                    } else
+                        state = State::Invalid;
+
+                    break;
+                case State::Integer:
+                    if(isDigit(c)) {
+                        addDigit(c, false);
+                        break;
+                    }
+
+                    /* no break */
+                case State::Zero:
+                    if(c == '.')
+                        state = State::Point;
+                    else if(c == 'e' || c == 'E')
+                        state = State::E;
+                    else
+                        state = State::Invalid;
+
+                    break;
+                case State::Point:
+                case State::Fraction:
+                    if(isDigit(c)) {
+                        addDigit(c, true);
+                        state = State::Fraction;
+                    } else if(state == State::Fraction && (c == 'e' || c == 'E'))
+                        state = State::E;
+                    else
+                        state = State::Invalid;
+
+                    break;
+                case State::E:
+                    if(c == '-' || c == '+') {
+                        negativeExponent = c == '-';
+                        state = State::ExponentSign;
+                        break;
+                    }
+
+                    /* no break */
+                case State::ExponentSign:
+                case State::Exponent:
+                    if(isDigit(c)) {
+                        const uint32_t value = exponent * 10u + (c - '0');
+                        exponent = (value < maxExponent) ? value : maxExponent;
+
+                        state = State::Exponent;
+                    } else
+                        state = State::Invalid;
+
+                    break;
+                case State::Invalid:
+                    return false;
+            }
+        }
+
+        return state != State::Invalid;
+    }
+
+    /// Returns true if a complete, valid number has been received.
+    inline bool done() {
+        return state == State::Zero || state == State::Integer
+                || state == State::Fraction || state == State::Exponent;
+    }
+
+    /// Returns true if the number can be retrieved by _getInteger_ without loss.
+    inline bool isInteger() {
+        return (state == State::Zero || state == State::Integer) && !pointExponent
+                && mantissa <= (negative ? (uint64_t)INT64_MAX + 1 : (uint64_t)INT64_MAX);
+    }
+
+    inline int64_t getInteger() {
+        return negative ? (int64_t)(0 - mantissa) : (int64_t)mantissa;
+    }
+
+    inline double getDouble()
+    {
+        const int32_t exp = decimalExponent();
+        double ret;
+
+        if(!mantissa)
+            ret = 0.0;
+        else if(!truncated && mantissa <= (1ull << 53) && -22 <= exp && exp <= 22)
+            ret = (exp < 0) ? (double)mantissa / pow10(-exp) : (double)mantissa * pow10(exp);
+        else {
+            // Canonical form, with a non-zero digit standing for the dropped ones.
+            char str[32];
+            snprintf(str, sizeof(str), truncated ? "%llu1e%ld" : "%llue%ld",
+                    (unsigned long long)mantissa, (long)(truncated ? exp - 1 : exp));
+            ret = strtod(str, nullptr);
+        }
+
+        return negative ? -ret : ret;
+    }
+};
+
+#endif /* NUMBERPARSER_H_ */
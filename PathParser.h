@@ -19,9 +19,46 @@
 #ifndef PATHPARSER_H_
 #define PATHPARSER_H_
 
+#include "HexParser.h"
+
+#include <stdint.h>
+
+/**
+ * Path parser (CRTP)
+ *
+ * Splits the path into elements and decodes the percent encoded
+ * characters in them, even if an escape sequence is fragmented.
+ * The runs of plain characters are passed on from the input buffer,
+ * the decoded ones one by one, so no copy is made.
+ *
+ * Malformed escape sequences and encoded slashes or null characters
+ * are dropped and make the path invalid, the user can check it after
+ * the _done_ method is called.
+ *
+ * The client is required to provide the following methods:
+ *
+ *  - void beforeElement() {}
+ *  - void parseElement(const char* at, unsigned int length) {}
+ *  - void elementDone() {}
+ */
 template<class Child>
 class PathParser {
     bool hasData;
+    bool valid;
+    PercentEscape escape;
+
+    void element(const char* buff, unsigned int length)
+    {
+        if(!length)
+            return;
+
+        if(!hasData) {
+            hasData = true;
+            ((Child*)this)->beforeElement();
+        }
+
+        ((Child*)this)->parseElement(buff, length);
+    }
 
 public:
     void parsePath(const char* buff, unsigned int length)
@@ -30,39 +67,60 @@ public:
             return;
 
         const char* start = buff;
-        bool hadData = hasData;
         while(length--) {
             const char c = *buff++;
 
-            if(c == '/') {
-                if(hasData) {
-                	if(!hadData)
-                		((Child*)this)->beforeElement();
+            if(escape.isActive()) {
+                switch(escape.feed(c)) {
+                    case PercentEscape::Result::Invalid:
+                        valid = false;
+                        break;
+                    case PercentEscape::Result::Done:
+                        if(*escape.value() == '/' || *escape.value() == '\0')
+                            valid = false;
+                        else
+                            element(escape.value(), 1);
+                        break;
+                    default:;
+                }
 
-                	hadData = hasData = false;
-                    ((Child*)this)->parseElement(start, buff-start-1);
+                start = buff;
+            } else if(c == '%') {
+                element(start, buff-start-1);
+                escape.start();
+            } else if(c == '/') {
+                element(start, buff-start-1);
+
+                if(hasData) {
+                    hasData = false;
                     ((Child*)this)->elementDone();
                 }
+
                 start = buff;
-            } else {
-                hasData = true;
             }
         }
 
-        if(hasData) {
-        	if(!hadData)
-        		((Child*)this)->beforeElement();
-
-            ((Child*)this)->parseElement(start, buff-start);
-        }
+        if(!escape.isActive())
+            element(start, buff-start);
     }
+
     void done() {
+        if(escape.isActive())
+            valid = false;
+
     	if(hasData)
     		((Child*)this)->elementDone();
     }
 
     void reset() {
     	hasData = false;
+    	valid = true;
+    	escape.reset();
+    }
+
+    /// False if the path contained a malformed or forbidden escape sequence.
+    bool isValid() {
+        return valid;
     }
 };
 
@@ -0,0 +1,216 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2017 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+#ifndef QUERYPARSER_H_
+#define QUERYPARSER_H_
+
+#include "HexParser.h"
+#include "Keywords.h"
+
+#include <stdint.h>
+
+/**
+ * Query string parser.
+ *
+ * Splits the query component of the URL (without the leading question mark)
+ * into key-value pairs of the form: <key>=<value>&<key>=<value>... The keys
+ * and values are percent-decoded and the plus sign is replaced with a space
+ * (as in HTML form submission), the decoded characters are passed one by one,
+ * everything else is passed directly from the input without copying.
+ *
+ * Calls the user supplied CRTP related Child class's relevant methods in
+ * the same order as KvParser: parseKey, keyDone, parseValue, valueDone. A key
+ * without the equals sign is reported with an empty value, empty pairs (ie.
+ * consecutive ampersands) are skipped.
+ */
+template <class Child>
+class QueryParser {
+	enum class State: uint8_t {
+		Empty, Key, Value
+	};
+
+	State state;
+	bool valid;
+	PercentEscape escape;
+
+	inline void emit(const char* buff, unsigned int length) {
+		if(!length)
+			return;
+
+		if(state == State::Value) {
+			((Child*)this)->parseValue(buff, length);
+		} else {
+			state = State::Key;
+			((Child*)this)->parseKey(buff, length);
+		}
+	}
+
+	inline void pairDone() {
+		if(state == State::Key)
+			((Child*)this)->keyDone();
+
+		if(state != State::Empty)
+			((Child*)this)->valueDone();
+
+		state = State::Empty;
+	}
+
+protected:
+	/*
+	 * Callbacks, to be overridden by the user.
+	 */
+	inline void parseKey(const char * buff, unsigned int len) {}
+	inline void keyDone() {}
+	inline void parseValue(const char * buff, unsigned int len) {}
+	inline void valueDone() {}
+
+public:
+	/**
+	 * Initialize internal state.
+	 */
+	inline void reset() {
+		state = State::Empty;
+		valid = true;
+		escape.reset();
+	}
+
+	/**
+	 * Parse a block of data.
+	 */
+	inline void parseQuery(const char* buff, unsigned int length)
+	{
+		const char* start = buff;
+		while(length--) {
+			const char c = *buff++;
+
+			if(escape.isActive()) {
+				switch(escape.feed(c)) {
+					case PercentEscape::Result::Invalid:
+						valid = false;
+						break;
+					case PercentEscape::Result::Done:
+						emit(escape.value(), 1);
+						break;
+					default:;
+				}
+
+				start = buff;
+			} else if(c == '%' || c == '+' || c == '&' || (c == '=' && state != State::Value)) {
+				emit(start, buff-start-1);
+				start = buff;
+
+				if(c == '%') {
+					escape.start();
+				} else if(c == '+') {
+					emit(" ", 1);
+				} else if(c == '&') {
+					pairDone();
+				} else {
+					((Child*)this)->keyDone();
+					state = State::Value;
+				}
+			}
+		}
+
+		if(!escape.isActive())
+			emit(start, buff-start);
+	}
+
+	/**
+	 * Finalize parsing.
+	 *
+	 * Must be called upon reached end-of-input.
+	 */
+	inline void done() {
+		if(escape.isActive())
+			valid = false;
+
+		escape.reset();
+		pairDone();
+	}
+
+	/**
+	 * Check for malformed escape sequences.
+	 */
+	inline bool isValid() {
+		return valid;
+	}
+};
+
+/**
+ * Dispatcher of the known query parameters.
+ *
+ * The keys are matched against the _keywords_ table of the _Params_ class,
+ * that has to be a _Keywords_ instance (of any value type). The value of a
+ * recognized parameter is passed to the Child's onParameter method (possibly
+ * in several fragments), then its parameterDone method is called, both with
+ * the associated value from the table. Unknown parameters are ignored.
+ *
+ * If _Params_ is void no parsing is done at all.
+ */
+template <class Child, class Params>
+class QueryDispatcher: public QueryParser<QueryDispatcher<Child, Params> > {
+	friend QueryParser<QueryDispatcher>;
+
+	template<class T, unsigned int N>
+	static Keywords<T, N> table(const Keywords<T, N>&);
+
+	typedef decltype(table(Params::keywords)) Table;
+
+	typename Table::Matcher matcher;
+	const typename Table::Keyword* key;
+
+	inline void parseKey(const char * buff, unsigned int len) {
+		matcher.progress(Params::keywords, buff, len);
+	}
+
+	inline void keyDone() {
+		key = matcher.match(Params::keywords);
+		matcher.reset();
+	}
+
+	inline void parseValue(const char * buff, unsigned int len) {
+		if(key)
+			((Child*)this)->onParameter(key->getValue(), buff, len);
+	}
+
+	inline void valueDone() {
+		if(key)
+			((Child*)this)->parameterDone(key->getValue());
+	}
+
+public:
+	/**
+	 * Initialize internal state.
+	 */
+	inline void reset() {
+		QueryParser<QueryDispatcher>::reset();
+		matcher.reset();
+	}
+};
+
+template <class Child>
+class QueryDispatcher<Child, void> {
+public:
+	inline void reset() {}
+	inline void parseQuery(const char* buff, unsigned int length) {}
+	inline void done() {}
+	inline bool isValid() { return true; }
+};
+
+#endif /* QUERYPARSER_H_ */
@@ -0,0 +1,645 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2017 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#ifndef STATICJSONPARSER_H_
+#define STATICJSONPARSER_H_
+
+/*
+ * Compile-time composed variant of the filters of JsonParser.h.
+ *
+ * The filter tree is described by types instead of objects linked
+ * by pointers, for example:
+ *
+ * 		ObjectFilterT<
+ * 			Member<idKey, NumberExtractorT>,
+ * 			Member<toppingKey, ArrayFilterT<
+ * 				Element<1, ObjectFilterT<Member<typeKey, StringExtractorT<16>>>>
+ * 			>>
+ * 		>
+ *
+ * where the keys are null-terminated strings with static storage (as
+ * string literals can not be template arguments). The whole tree is a
+ * single object, the extracted values are stored in the leaves and are
+ * reached through the _get_ methods of the containers.
+ *
+ * The events of the parser are passed on to the filters by plain (and
+ * mostly inlined) calls, there is no virtual dispatch involved. Every
+ * container keeps track of which of its children is active and its own
+ * nesting depth, the call to the active child is selected by comparing
+ * the index against each of the compile-time known candidates.
+ */
+
+#include "UJson.h"
+#include "Keywords.h"
+
+#include "meta/Sequence.h"
+
+namespace detail {
+	/*
+	 * Event forwarders, used to apply the same event to the active child.
+	 */
+
+	struct FilterReset {
+		template<class F> inline void operator()(F& f) const { f.reset(); }
+	};
+
+	struct FilterBeforeKey {
+		template<class F> inline void operator()(F& f) const { f.beforeKey(); }
+	};
+
+	struct FilterOnKey {
+		const char *at;
+		size_t length;
+		template<class F> inline void operator()(F& f) const { f.onKey(at, length); }
+	};
+
+	struct FilterAfterKey {
+		template<class F> inline void operator()(F& f) const { f.afterKey(); }
+	};
+
+	struct FilterBeforeValue {
+		JsonValueType type;
+		template<class F> inline void operator()(F& f) const { f.beforeValue(type); }
+	};
+
+	struct FilterOnNull {
+		template<class F> inline void operator()(F& f) const { f.onNull(); }
+	};
+
+	struct FilterOnBoolean {
+		bool value;
+		template<class F> inline void operator()(F& f) const { f.onBoolean(value); }
+	};
+
+	struct FilterOnInteger {
+		int64_t value;
+		template<class F> inline void operator()(F& f) const { f.onInteger(value); }
+	};
+
+	struct FilterOnDouble {
+		double value;
+		template<class F> inline void operator()(F& f) const { f.onDouble(value); }
+	};
+
+	struct FilterOnString {
+		const char *at;
+		size_t length;
+		template<class F> inline void operator()(F& f) const { f.onString(at, length); }
+	};
+
+	struct FilterAfterValue {
+		JsonValueType type;
+		template<class F> inline void operator()(F& f) const { f.afterValue(type); }
+	};
+
+	/// Storage of a child filter, indexed to allow multiple ones of the same type.
+	template<int i, class Filter>
+	struct FilterSlot {
+		Filter filter;
+	};
+
+	/**
+	 * Common part of the containers: storage of the children, the
+	 * index of the active one and the nesting depth counter.
+	 *
+	 * The depth is one while processing the immediate contents of the
+	 * value the container is assigned to, the child selected for the
+	 * current element (if any) is the active one, which receives all
+	 * the events until the end of that element.
+	 */
+	template<class Seq, class... Filters> class FilterSet;
+
+	template<int... i, class... Filters>
+	class FilterSet<pet::Sequence<i...>, Filters...>: FilterSlot<i, Filters>... {
+		template<int k, class F>
+		static inline F& slot(FilterSlot<k, F>& s) {
+			return s.filter;
+		}
+
+	protected:
+		static constexpr uint8_t none = 0xff;
+
+		uint16_t depth;
+		uint8_t active;
+
+		/// Apply the operation to the active child (no-op if there is none).
+		template<class Op>
+		inline void forward(const Op& op) {
+			int dummy[] = {0, (active == i ? (op(slot<i>(*this)), 0) : 0)...};
+			(void) dummy;
+		}
+
+		inline void resetChildren() {
+			const FilterReset op{};
+			int dummy[] = {0, (op(slot<i>(*this)), 0)...};
+			(void) dummy;
+			depth = 0;
+			active = none;
+		}
+
+	public:
+		/// Access the child filter at the _k_-th position.
+		template<int k>
+		inline auto get() -> decltype(slot<k>(*this)) {
+			return slot<k>(*this);
+		}
+	};
+
+	/// Length of the longest common prefix of the key and any of the others.
+	constexpr uint32_t sharedPrefix(const char*) {
+		return 0;
+	}
+
+	template<class... Rest>
+	constexpr uint32_t sharedPrefix(const char* key, const char* other, Rest... rest) {
+		return (KeywordHash::commonPrefix(key, other) > sharedPrefix(key, rest...)) ?
+				KeywordHash::commonPrefix(key, other) : sharedPrefix(key, rest...);
+	}
+
+	/// The member entries preceding the one being looked at.
+	template<class... Members> struct MemberList {};
+
+	/*
+	 * Lookup of the object filter member entries (unrolled comparisons), it
+	 * follows the scheme of HashedKeywords: the branching prefix of a member
+	 * is the shortest one that it does not share with the preceding members.
+	 */
+	template<class Preceding, class... Members>
+	struct MemberLookup {
+		static inline uint8_t find(uint32_t, uint32_t, const char*) {
+			return 0xff;
+		}
+
+		static inline uint8_t branch(uint32_t, uint32_t, const char*, char, const char* &key) {
+			key = nullptr;
+			return 0xff;
+		}
+	};
+
+	template<class... Preceding, class First, class... Rest>
+	struct MemberLookup<MemberList<Preceding...>, First, Rest...> {
+		typedef MemberLookup<MemberList<Preceding..., First>, Rest...> Next;
+
+		static constexpr uint8_t pos = sizeof...(Preceding);
+		static constexpr uint32_t hash = KeywordHash::of(First::key);
+		static constexpr uint32_t length = KeywordHash::lengthOf(First::key);
+		static constexpr uint32_t shared = sharedPrefix(First::key, Preceding::key...);
+		static constexpr uint32_t branchLength = (pos && shared < length) ? shared + 1 : 0;
+		static constexpr uint32_t branchHash = KeywordHash::prefixOf(First::key, branchLength);
+
+		/// Position of the member with the key, which is known to be a prefix of the _candidate_.
+		static inline uint8_t find(uint32_t h, uint32_t l, const char* candidate) {
+			return (h == hash && l == length && strncmp(First::key, candidate, l) == 0) ?
+					pos : Next::find(h, l, candidate);
+		}
+
+		/// Position (and key) of the first member that starts with the prefix of the _candidate_ and _c_.
+		static inline uint8_t branch(uint32_t h, uint32_t l, const char* candidate, char c, const char* &key) {
+			if(branchLength && h == branchHash && l == branchLength && First::key[l - 1] == c &&
+					strncmp(First::key, candidate, l - 1) == 0) {
+				key = First::key;
+				return pos;
+			}
+
+			return Next::branch(h, l, candidate, c, key);
+		}
+	};
+
+	/// Key of the first object filter member entry (null if there is none).
+	template<class... Members>
+	struct FirstMember {
+		static constexpr const char* key = nullptr;
+	};
+
+	template<class First, class... Rest>
+	struct FirstMember<First, Rest...> {
+		static constexpr const char* key = First::key;
+	};
+
+	/// Position of the array filter element entry for the index (unrolled comparisons).
+	template<class... Elements>
+	struct ElementLookup {
+		static constexpr uint8_t find(uint32_t, uint8_t) {
+			return 0xff;
+		}
+	};
+
+	template<class First, class... Rest>
+	struct ElementLookup<First, Rest...> {
+		static constexpr uint8_t find(uint32_t idx, uint8_t pos = 0) {
+			return (First::index == idx) ? pos : ElementLookup<Rest...>::find(idx, pos + 1);
+		}
+	};
+}
+
+/**
+ * Object filter entry, the _Filter_ is applied to the value
+ * of the member with the _name_ name (null-terminated string).
+ */
+template<const char* name, class Filter>
+struct Member {
+	static constexpr const char* key = name;
+	typedef Filter Type;
+};
+
+/**
+ * Array filter entry, the _Filter_ is applied to the element
+ * at the _idx_ (zero-based) position.
+ */
+template<uint32_t idx, class Filter>
+struct Element {
+	static constexpr uint32_t index = idx;
+	typedef Filter Type;
+};
+
+/**
+ * Base of the leaf filters, ignores all events.
+ */
+struct LeafFilterT {
+	inline void reset() {}
+	inline void beforeKey() {}
+	inline void onKey(const char*, size_t) {}
+	inline void afterKey() {}
+	inline void beforeValue(JsonValueType) {}
+	inline void onNull() {}
+	inline void onBoolean(bool) {}
+	inline void onInteger(int64_t) {}
+	inline void onDouble(double) {}
+	inline void onString(const char*, size_t) {}
+	inline void afterValue(JsonValueType) {}
+};
+
+/**
+ * Filter for selecting members of an object identified by their names.
+ *
+ * The names are compared to a candidate member as they arrive, the next
+ * candidate is looked up by the hash of the prefix computed at compile-time
+ * for the members (see _HashedKeywords_ for the details).
+ *
+ * The _Members_ are the _Member_ entries describing the selected ones.
+ */
+template<class... Members>
+class ObjectFilterT: public detail::FilterSet<pet::sequence<0, sizeof...(Members)>, typename Members::Type...> {
+	static_assert(sizeof...(Members) > 0, "Object filter without members");
+	static_assert(sizeof...(Members) < 0xff, "Too many members");
+
+	typedef detail::FilterSet<pet::sequence<0, sizeof...(Members)>, typename Members::Type...> Base;
+	typedef detail::MemberLookup<detail::MemberList<>, Members...> Lookup;
+
+	/// Hash of the name of the current member.
+	KeywordHash matcher;
+
+	/// Key of the first member that starts with the name so far (null if there is none) and its position.
+	const char* candidate;
+	uint8_t position;
+
+	/// Set if the value is actually an object.
+	bool isObject;
+
+public:
+	inline void reset() {
+		this->resetChildren();
+	}
+
+	inline void beforeKey() {
+		if(this->depth == 1) {
+			matcher.reset();
+			candidate = detail::FirstMember<Members...>::key;
+			position = 0;
+		} else
+			this->forward(detail::FilterBeforeKey{});
+	}
+
+	inline void onKey(const char *at, size_t length) {
+		if(this->depth == 1) {
+			for(; length && candidate; length--) {
+				const char c = *at++;
+				const uint32_t l = matcher.length;
+				matcher.progress(c);
+
+				if(candidate[l] && candidate[l] == c)
+					continue;
+
+				position = Lookup::branch(matcher.hash, matcher.length, candidate, c, candidate);
+			}
+		} else
+			this->forward(detail::FilterOnKey{at, length});
+	}
+
+	inline void afterKey() {
+		if(this->depth != 1)
+			this->forward(detail::FilterAfterKey{});
+	}
+
+	/// Check for a keyword match, enter child if needed.
+	inline void beforeValue(JsonValueType type) {
+		if(this->depth == 0) {
+			isObject = type == JsonValueType::Object;
+		} else {
+			if(this->depth == 1) {
+				if(!isObject || !candidate)
+					this->active = Base::none;
+				else if(!candidate[matcher.length])
+					this->active = position;
+				else
+					this->active = Lookup::find(matcher.hash, matcher.length, candidate);
+			}
+
+			this->forward(detail::FilterBeforeValue{type});
+		}
+
+		this->depth++;
+	}
+
+	inline void onNull() {
+		this->forward(detail::FilterOnNull{});
+	}
+
+	inline void onBoolean(bool value) {
+		this->forward(detail::FilterOnBoolean{value});
+	}
+
+	inline void onInteger(int64_t value) {
+		this->forward(detail::FilterOnInteger{value});
+	}
+
+	inline void onDouble(double value) {
+		this->forward(detail::FilterOnDouble{value});
+	}
+
+	inline void onString(const char *at, size_t length) {
+		this->forward(detail::FilterOnString{at, length});
+	}
+
+	/// Leave the child at the end of the member value.
+	inline void afterValue(JsonValueType type) {
+		if(--this->depth) {
+			this->forward(detail::FilterAfterValue{type});
+
+			if(this->depth == 1)
+				this->active = Base::none;
+		}
+	}
+};
+
+/**
+ * Filter for selecting elements of an array identified by their indices.
+ *
+ * The _Elements_ are the _Element_ entries describing the selected ones.
+ */
+template<class... Elements>
+class ArrayFilterT: public detail::FilterSet<pet::sequence<0, sizeof...(Elements)>, typename Elements::Type...> {
+	static_assert(sizeof...(Elements) < 0xff, "Too many elements");
+
+	typedef detail::FilterSet<pet::sequence<0, sizeof...(Elements)>, typename Elements::Type...> Base;
+
+	/// Index of the next element.
+	uint32_t idx;
+
+	/// Set if the value is actually an array.
+	bool isArray;
+
+public:
+	inline void reset() {
+		this->resetChildren();
+	}
+
+	inline void beforeKey() {
+		this->forward(detail::FilterBeforeKey{});
+	}
+
+	inline void onKey(const char *at, size_t length) {
+		this->forward(detail::FilterOnKey{at, length});
+	}
+
+	inline void afterKey() {
+		this->forward(detail::FilterAfterKey{});
+	}
+
+	/// Keep track of the current element index, enter child on match.
+	inline void beforeValue(JsonValueType type) {
+		if(this->depth == 0) {
+			isArray = type == JsonValueType::Array;
+			idx = 0;
+		} else {
+			if(this->depth == 1)
+				this->active = isArray ? detail::ElementLookup<Elements...>::find(idx++) : Base::none;
+
+			this->forward(detail::FilterBeforeValue{type});
+		}
+
+		this->depth++;
+	}
+
+	inline void onNull() {
+		this->forward(detail::FilterOnNull{});
+	}
+
+	inline void onBoolean(bool value) {
+		this->forward(detail::FilterOnBoolean{value});
+	}
+
+	inline void onInteger(int64_t value) {
+		this->forward(detail::FilterOnInteger{value});
+	}
+
+	inline void onDouble(double value) {
+		this->forward(detail::FilterOnDouble{value});
+	}
+
+	inline void onString(const char *at, size_t length) {
+		this->forward(detail::FilterOnString{at, length});
+	}
+
+	/// Leave the child at the end of the element.
+	inline void afterValue(JsonValueType type) {
+		if(--this->depth) {
+			this->forward(detail::FilterAfterValue{type});
+
+			if(this->depth == 1)
+				this->active = Base::none;
+		}
+	}
+};
+
+/// Leaf filter to extract numeric value (zero if not found).
+struct NumberExtractorT: LeafFilterT {
+	int value;
+
+	inline void reset() {
+		value = 0;
+	}
+
+	inline void onInteger(int64_t value) {
+		if(INT32_MIN <= value && value <= INT32_MAX)
+			this->value = (int)value;
+	}
+};
+
+/// Leaf filter to extract numeric value with fraction or exponent (zero if not found).
+struct DoubleExtractorT: LeafFilterT {
+	double value;
+
+	inline void reset() {
+		value = 0;
+	}
+
+	inline void onInteger(int64_t value) {
+		this->value = (double)value;
+	}
+
+	inline void onDouble(double value) {
+		this->value = value;
+	}
+};
+
+/// Leaf filter to extract boolean value (false if not found).
+struct BoolExtractorT: LeafFilterT {
+	bool value;
+
+	inline void reset() {
+		value = false;
+	}
+
+	inline void onBoolean(bool value) {
+		this->value = value;
+	}
+};
+
+/**
+ * Leaf filter to extract string value (empty if not found).
+ *
+ * The _n_ parameter is the size of the storage, including the terminator,
+ * longer values are truncated.
+ */
+template<size_t n>
+struct StringExtractorT: LeafFilterT {
+	char value[n];
+
+	/// Offset of the next free byte into the output storage.
+	size_t offset;
+
+	inline void reset() {
+		value[0] = '\0';
+		offset = 0;
+	}
+
+	inline void beforeValue(JsonValueType) {
+		offset = 0;
+	}
+
+	inline void onString(const char *at, size_t length) {
+		while(length-- && offset < n - 1)
+			value[offset++] = *at++;
+	}
+
+	inline void afterValue(JsonValueType) {
+		value[offset] = '\0';
+	}
+};
+
+/**
+ * Main filter executor for compile-time composed filters.
+ *
+ * Forwards the events to the _Root_ filter, until a lower
+ * level (_UJson_) parse error is encountered.
+ */
+template<uint16_t maxDepth, class Root>
+class StaticJsonParser: public UJson<StaticJsonParser<maxDepth, Root>, maxDepth>
+{
+        typedef UJson<StaticJsonParser, maxDepth> Parent;
+        friend Parent;
+
+        Root root;
+        bool error;
+
+        inline void beforeKey() {
+            if(!error)
+                root.beforeKey();
+        }
+
+        inline void onKey(const char *at, size_t length) {
+            if(!error)
+                root.onKey(at, length);
+        }
+
+        inline void afterKey() {
+            if(!error)
+                root.afterKey();
+        }
+
+        inline void beforeValue(JsonValueType type) {
+            if(!error)
+                root.beforeValue(type);
+        }
+
+        inline void onNull() {
+            if(!error)
+                root.onNull();
+        }
+
+        inline void onBoolean(bool x) {
+            if(!error)
+                root.onBoolean(x);
+        }
+
+        inline void onInteger(int64_t value) {
+            if(!error)
+                root.onInteger(value);
+        }
+
+        inline void onDouble(double value) {
+            if(!error)
+                root.onDouble(value);
+        }
+
+        inline void onString(const char *at, size_t length) {
+            if(!error)
+                root.onString(at, length);
+        }
+
+        inline void afterValue(JsonValueType type) {
+            if(!error)
+                root.afterValue(type);
+        }
+
+        inline void onKeyError() {error = true;}
+        inline void onValueError() {error = true;}
+        inline void onStructureError() {error = true;}
+        inline void onResourceError() {error = true;}
+
+    public:
+        void reset() {
+            Parent::reset();
+            error = false;
+            root.reset();
+        }
+
+        /// Root of the filter tree, to access the extracted values.
+        inline Root& filter() {
+            return root;
+        }
+
+        /// Returns true if no error was encountered so far.
+        inline bool isValid() {
+            return !error;
+        }
+};
+
+#endif /* STATICJSONPARSER_H_ */
@@ -21,12 +21,279 @@
 #define UJSON_H_
 
 #include <stddef.h>
+#include <string.h>
 
-#include <IntParser.h>
+#include <NumberParser.h>
+#include <HexParser.h>
 #include <Keywords.h>
 
+#if defined(__SSE2__) && defined(__GNUC__) && !defined(UJSON_NO_SIMD)
+#define UJSON_SSE2
+#include <emmintrin.h>
+#endif
+
 enum class JsonValueType { Null, String, Number, Boolean, Array, Object };
 
+namespace detail {
+    /**
+     * Scanners for the long runs of uninteresting characters: the
+     * contents of strings and the whitespace between the tokens.
+     *
+     * Both of them return a pointer to the first character that
+     * the parser needs to look at (or _end_), they have no state
+     * so they do not affect the resumability of the parser.
+     *
+     * The vectorized versions compare sixteen characters at a time
+     * against all the interesting ones and find the first hit in the
+     * bitmask of the results (as in simdjson). They are only compiled
+     * in if SSE2 is available (unless UJSON_NO_SIMD is defined). The
+     * portable versions check a machine word at a time for the
+     * presence of the special characters (using the usual zero byte
+     * detection bit trick) and only go through the bytes of the word
+     * if there is one.
+     *
+     * A template only to allow defining the selector in the header
+     * without violating the one definition rule.
+     */
+    template<class = void>
+    struct JsonScanner {
+        /// Set if the vectorized scanners are in use.
+        static bool vectorized;
+
+        typedef size_t Word;
+
+        static constexpr Word ones = (Word)-1 / 0xff;
+        static constexpr Word highs = ones * 0x80;
+        static constexpr Word lows = ones * 0x7f;
+
+        /// The high bit of each byte is set if the byte is zero (exactly, no false positives).
+        static inline Word hasZeroByte(Word w) {
+            return ~(((w & lows) + lows) | w | lows);
+        }
+
+        static inline Word hasByte(Word w, char c) {
+            return hasZeroByte(w ^ (ones * (unsigned char)c));
+        }
+
+        static inline Word load(const char* p) {
+            Word ret;
+            memcpy(&ret, p, sizeof(ret));
+            return ret;
+        }
+
+        static inline bool isStringSpecial(char c) {
+            return c == '\"' || c == '\\';
+        }
+
+        static inline bool isWs(char c) {
+            return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+        }
+
+        static inline const char* stringPortable(const char* p, const char* end) {
+            for(; end - p >= (ptrdiff_t)sizeof(Word); p += sizeof(Word)) {
+                const Word w = load(p);
+
+                if(hasByte(w, '\"') | hasByte(w, '\\'))
+                    break;
+            }
+
+            while(p != end && !isStringSpecial(*p))
+                p++;
+
+            return p;
+        }
+
+        static inline const char* asciiPortable(const char* p, const char* end) {
+            for(; end - p >= (ptrdiff_t)sizeof(Word); p += sizeof(Word)) {
+                if(load(p) & highs)
+                    break;
+            }
+
+            while(p != end && !(*p & 0x80))
+                p++;
+
+            return p;
+        }
+
+        static inline const char* whitespacePortable(const char* p, const char* end) {
+            for(; end - p >= (ptrdiff_t)sizeof(Word); p += sizeof(Word)) {
+                const Word w = load(p);
+
+                // Set where the byte is none of the whitespace characters.
+                const Word other = ~(hasByte(w, ' ') | hasByte(w, '\t') | hasByte(w, '\r') | hasByte(w, '\n')) & highs;
+
+                if(other)
+                    break;
+            }
+
+            while(p != end && isWs(*p))
+                p++;
+
+            return p;
+        }
+
+#ifdef UJSON_SSE2
+        static inline const char* stringSse2(const char* p, const char* end) {
+            const __m128i quote = _mm_set1_epi8('\"');
+            const __m128i backslash = _mm_set1_epi8('\\');
+
+            for(; end - p >= 16; p += 16) {
+                const __m128i in = _mm_loadu_si128((const __m128i*)p);
+                const unsigned int mask = _mm_movemask_epi8(
+                        _mm_or_si128(_mm_cmpeq_epi8(in, quote), _mm_cmpeq_epi8(in, backslash)));
+
+                if(mask)
+                    return p + __builtin_ctz(mask);
+            }
+
+            return p;
+        }
+
+        static inline const char* asciiSse2(const char* p, const char* end) {
+            for(; end - p >= 16; p += 16) {
+                const unsigned int mask = _mm_movemask_epi8(_mm_loadu_si128((const __m128i*)p));
+
+                if(mask)
+                    return p + __builtin_ctz(mask);
+            }
+
+            return p;
+        }
+
+        static inline const char* whitespaceSse2(const char* p, const char* end) {
+            for(; end - p >= 16; p += 16) {
+                const __m128i in = _mm_loadu_si128((const __m128i*)p);
+                const __m128i ws = _mm_or_si128(
+                        _mm_or_si128(_mm_cmpeq_epi8(in, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(in, _mm_set1_epi8('\t'))),
+                        _mm_or_si128(_mm_cmpeq_epi8(in, _mm_set1_epi8('\r')), _mm_cmpeq_epi8(in, _mm_set1_epi8('\n'))));
+                const unsigned int mask = ~_mm_movemask_epi8(ws) & 0xffff;
+
+                if(mask)
+                    return p + __builtin_ctz(mask);
+            }
+
+            return p;
+        }
+
+        static inline bool supported() {
+            return true;
+        }
+#else
+        static inline bool supported() {
+            return false;
+        }
+#endif
+
+        static inline bool accelerate(bool enable) {
+            return vectorized = enable && supported();
+        }
+
+        /// Finds the first quote or backslash.
+        static inline const char* string(const char* p, const char* end) {
+#ifdef UJSON_SSE2
+            if(vectorized)
+                p = stringSse2(p, end);
+#endif
+            return stringPortable(p, end);
+        }
+
+        /// Finds the first non-ASCII character.
+        static inline const char* ascii(const char* p, const char* end) {
+#ifdef UJSON_SSE2
+            if(vectorized)
+                p = asciiSse2(p, end);
+#endif
+            return asciiPortable(p, end);
+        }
+
+        /// Finds the first non-whitespace character.
+        static inline const char* whitespace(const char* p, const char* end) {
+            // Most tokens are separated by a single space or none at all.
+            if(p == end || !isWs(*p))
+                return p;
+
+#ifdef UJSON_SSE2
+            if(vectorized)
+                p = whitespaceSse2(p, end);
+#endif
+            return whitespacePortable(p, end);
+        }
+    };
+
+    template<class Dummy>
+    bool JsonScanner<Dummy>::vectorized = JsonScanner<Dummy>::supported();
+
+    /**
+     * Streaming UTF-8 validator (RFC3629), rejects overlong forms, surrogates
+     * and code points above U+10FFFF. The state is the number of continuation
+     * bytes still needed and the valid range of the next one. Runs of ASCII
+     * characters are skipped using the scanner.
+     *
+     * Once an error is found (and failed is called) the rest of the input
+     * is accepted, so that an error is reported only once.
+     */
+    struct Utf8Validator {
+        static constexpr uint8_t failed = 0xff;
+        uint8_t remaining, lo, hi;
+
+        inline void reset() {
+            remaining = 0;
+        }
+
+        inline void fail() {
+            remaining = failed;
+        }
+
+        /// Returns true if not in the middle of a multi-byte sequence.
+        inline bool isComplete() {
+            return !remaining || remaining == failed;
+        }
+
+        inline bool validate(const char* p, const char* end)
+        {
+            if(remaining == failed)
+                return true;
+
+            while(p != end) {
+                if(!remaining) {
+                    if((p = JsonScanner<>::ascii(p, end)) == end)
+                        break;
+
+                    const uint8_t c = *p++;
+                    lo = 0x80;
+                    hi = 0xbf;
+
+                    if(c < 0xc2)
+                        return false;
+                    else if(c < 0xe0)
+                        remaining = 1;
+                    else if(c < 0xf0) {
+                        remaining = 2;
+                        lo = (c == 0xe0) ? 0xa0 : 0x80;
+                        hi = (c == 0xed) ? 0x9f : 0xbf;
+                    } else if(c < 0xf5) {
+                        remaining = 3;
+                        lo = (c == 0xf0) ? 0x90 : 0x80;
+                        hi = (c == 0xf4) ? 0x8f : 0xbf;
+                    } else
+                        return false;
+                } else {
+                    const uint8_t c = *p++;
+
+                    if(c < lo || hi < c)
+                        return false;
+
+                    remaining--;
+                    lo = 0x80;
+                    hi = 0xbf;
+                }
+            }
+
+            return true;
+        }
+    };
+}
+
 template<class Child, uint16_t maxDepth>
 class UJson {
         class BitStack {
@@ -63,12 +330,15 @@ class UJson {
                 }
         };
 
+        typedef detail::JsonScanner<> Scanner;
+
         BitStack stack;
 
         enum class State: uint8_t {
             BeforeValue,
             InString,
             InStringQuote,
+            InStringUnicode,
             InNumber,
             InLiteral,
             AfterValue,
@@ -87,9 +357,36 @@ class UJson {
             typename LiteralKeywords::Keyword("false", Literal::False),
         };
 
+        /**
+         * String decoding state.
+         *
+         * The characters produced by escape sequences are collected in the
+         * buffer and passed on together, before the next unescaped part of
+         * the string or at its end, so that runs of escapes do not result in
+         * a separate callback for every one of them.
+         */
+        struct StringState {
+            /// Value of the unicode escape being decoded.
+            uint16_t value;
+
+            /// First half of a surrogate pair, waiting for the second one.
+            uint16_t highSurrogate;
+
+            /// Number of hexadecimal digits of the unicode escape processed.
+            uint8_t digits;
+
+            /// Number of bytes in the buffer.
+            uint8_t staged;
+
+            detail::Utf8Validator utf8;
+
+            char buffer[16];
+        };
+
         union {
-                IntParser intParser;
+                NumberParser numberParser;
                 typename LiteralKeywords::Matcher literalMatcher;
+                StringState str;
         };
 
         enum class EntityType {
@@ -110,6 +407,20 @@ class UJson {
         inline void onNull() {}
         inline void onBoolean(bool) {}
         inline void onNumber(int32_t value) {}
+
+        /// Integer without fraction and exponent, forwarded to _onNumber_ by default if it fits.
+        inline void onInteger(int64_t value) {
+            if(INT32_MIN <= value && value <= INT32_MAX)
+                ((Child*)this)->onNumber((int32_t)value);
+            else
+                ((Child*)this)->onValueError();
+        }
+
+        /// Any other number, not accepted by default.
+        inline void onDouble(double value) {
+            ((Child*)this)->onValueError();
+        }
+
         inline void onString(const char *at, size_t length) {}
         inline void onValueError() {}
         inline void afterValue(JsonValueType) {}
@@ -117,6 +428,9 @@ class UJson {
         inline void onStructureError() {}
         inline void onResourceError() {}
 
+        /// Set to true in the child to check that strings and keys are valid UTF-8.
+        static constexpr bool validateUtf8 = false;
+
         /*
          * Internal helpers.
          */
@@ -138,10 +452,134 @@ class UJson {
         }
 
         inline void flushNumber() {
-            ((Child*)this)->onNumber(intParser.getData());
+            if(!numberParser.done())
+                ((Child*)this)->onValueError();
+            else if(numberParser.isInteger())
+                ((Child*)this)->onInteger(numberParser.getInteger());
+            else
+                ((Child*)this)->onDouble(numberParser.getDouble());
+
             ((Child*)this)->afterValue(JsonValueType::Number);
         }
 
+        inline void emit(const char* at, size_t length) {
+            auto self = static_cast<Child*>(this);
+            (self->*(inObjKey ? &Child::onKey : &Child::onString))(at, length);
+        }
+
+        inline void stringError() {
+            auto self = static_cast<Child*>(this);
+            (self->*(inObjKey ? &Child::onKeyError : &Child::onValueError))();
+        }
+
+        inline void beginString() {
+            str.highSurrogate = 0;
+            str.staged = 0;
+            str.utf8.reset();
+        }
+
+        inline void flushStaged() {
+            if(str.staged) {
+                emit(str.buffer, str.staged);
+                str.staged = 0;
+            }
+        }
+
+        /// Append the UTF-8 encoding of a decoded character to the buffer.
+        inline void stage(uint32_t c) {
+            char temp[4];
+            uint8_t length;
+
+            if(Child::validateUtf8 && !str.utf8.isComplete()) {
+                stringError();
+                str.utf8.fail();
+            }
+
+            if(c < 0x80) {
+                temp[0] = c;
+                length = 1;
+            } else if(c < 0x800) {
+                temp[0] = 0xc0 | c >> 6;
+                temp[1] = 0x80 | (c & 0x3f);
+                length = 2;
+            } else if(c < 0x10000) {
+                temp[0] = 0xe0 | c >> 12;
+                temp[1] = 0x80 | (c >> 6 & 0x3f);
+                temp[2] = 0x80 | (c & 0x3f);
+                length = 3;
+            } else {
+                temp[0] = 0xf0 | c >> 18;
+                temp[1] = 0x80 | (c >> 12 & 0x3f);
+                temp[2] = 0x80 | (c >> 6 & 0x3f);
+                temp[3] = 0x80 | (c & 0x3f);
+                length = 4;
+            }
+
+            if(str.staged + length > sizeof(str.buffer))
+                flushStaged();
+
+            memcpy(str.buffer + str.staged, temp, length);
+            str.staged += length;
+        }
+
+        /// Unpaired surrogates are replaced with U+FFFD.
+        inline void dropSurrogate() {
+            if(str.highSurrogate) {
+                str.highSurrogate = 0;
+                stage(0xfffd);
+            }
+        }
+
+        inline void codeUnit(uint16_t u) {
+            if(0xdc00 <= u && u < 0xe000 && str.highSurrogate) {
+                stage(0x10000 + ((uint32_t)(str.highSurrogate - 0xd800) << 10) + (u - 0xdc00));
+                str.highSurrogate = 0;
+                return;
+            }
+
+            dropSurrogate();
+
+            if(0xd800 <= u && u < 0xdc00)
+                str.highSurrogate = u;
+            else
+                stage((0xdc00 <= u && u < 0xe000) ? 0xfffd : u);
+        }
+
+        /// Pass on a part of the string that contains no escapes.
+        inline void stringContent(const char* at, size_t length) {
+            dropSurrogate();
+            flushStaged();
+
+            if(Child::validateUtf8 && !str.utf8.validate(at, at + length)) {
+                stringError();
+                str.utf8.fail();
+            }
+
+            emit(at, length);
+        }
+
+        inline void endString() {
+            dropSurrogate();
+            flushStaged();
+
+            if(Child::validateUtf8 && !str.utf8.isComplete())
+                stringError();
+        }
+
+        static inline char unescape(char c) {
+            switch(c) {
+                case '\"': return '\"';
+                case '\\': return '\\';
+                case '/': return '/';
+                case 'b': return '\b';
+                case 'f': return '\f';
+                case 'n': return '\n';
+                case 'r': return '\r';
+                case 't': return '\t';
+                default: return '\0';
+            }
+        }
+
         inline void flushObject() {
             if(currentEntity() != EntityType::Object)
                 ((Child*)this)->onStructureError();
@@ -194,7 +632,20 @@ class UJson {
             return '0' <= c && c <= '9';
         }
 
+        static inline bool isNumberChar(char c) {
+            return isDigit(c) || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+        }
+
     public:
+        /**
+         * Enables or disables the vectorized scanning of strings and whitespace,
+         * returns true if they are in use. By default they are used if available,
+         * only needed for testing and benchmarking.
+         */
+        static inline bool accelerate(bool enable) {
+            return Scanner::accelerate(enable);
+        }
+
         inline void reset() {
             stack.reset();
             state = State::BeforeValue;
@@ -202,25 +653,22 @@ class UJson {
         }
 
         inline bool parse(const char* buff, uint32_t length) {
-            auto self = static_cast<Child*>(this);
             const char* const end = buff + length;
             const char* start;
 
             while(buff != end) {
                 switch(state) {
                     case State::BeforeValue:
-                        while(buff != end) {
-                            if(isWs(*buff)) {
-                                buff++;
-                                continue;
-                            }
+                        buff = Scanner::whitespace(buff, end);
 
+                        if(buff != end) {
                             if(*buff == '-' || isDigit(*buff)) {
                                 state = State::InNumber;
                                 ((Child*)this)->beforeValue(JsonValueType::Number);
-                                intParser.reset();
+                                numberParser.reset();
                             } else if(*buff == '\"'){
                                 state = State::InString;
+                                beginString();
                                 ((Child*)this)->beforeValue(JsonValueType::String);
                                 buff++;
                             } else if(*buff == '['){
@@ -248,70 +696,76 @@ class UJson {
                                 literalMatcher.reset();
                                 state = State::InLiteral;
                             }
-
-                            break;
                         }
 
                         break;
                     case State::InString:
                         start = buff;
-                        while(buff != end) {
+                        buff = Scanner::string(buff, end);
+
+                        if(buff != start)
+                            stringContent(start, buff - start);
+
+                        if(buff != end) {
                             if(*buff == '\"') {
-                                state = (inObjKey) ? State::BeforeObjColon : State::AfterValue;
-                            } else if(*buff == '\\')
+                                endString();
+
+                                if(inObjKey) {
+                                    state = State::BeforeObjColon;
+                                    ((Child*)this)->afterKey();
+                                    inObjKey = false;
+                                } else {
+                                    state = State::AfterValue;
+                                    ((Child*)this)->afterValue(JsonValueType::String);
+                                }
+                            } else
                                 state = State::InStringQuote;
 
-                            if(state != State::InString)
-                                break;
-
                             buff++;
                         }
 
-                        (self->*(inObjKey ? &Child::onKey : &Child::onString))(start, buff - start);
+                        break;
+                    case State::InStringQuote:
+                        state = State::InString;
 
-                        if(state == State::AfterValue || state == State::BeforeObjColon) {
-                            buff++;
+                        if(*buff == 'u') {
+                            state = State::InStringUnicode;
+                            str.value = 0;
+                            str.digits = 0;
+                        } else if(const char c = unescape(*buff)) {
+                            dropSurrogate();
+                            stage(c);
+                        } else
+                            stringError();
 
+                        buff++;
+                        break;
+                    case State::InStringUnicode:
+                        for(int8_t digit; buff != end && (digit = HexDigit::value(*buff)) >= 0;) {
+                            str.value = str.value << 4 | digit;
+                            buff++;
 
-                            if(inObjKey) {
-                                ((Child*)this)->afterKey();
-                                inObjKey = false;
-                            } else
-                                ((Child*)this)->afterValue(JsonValueType::String);
-                        }else if(state == State::InStringQuote)
-                        	buff++;
+                            if(++str.digits == 4) {
+                                codeUnit(str.value);
+                                state = State::InString;
+                                break;
+                            }
+                        }
 
-                        break;
-                    case State::InStringQuote:
-                        switch(*buff) {
-                            static constexpr const char backSlash = '\\';
-                            static constexpr const char slash = '/';
-                            static constexpr const char backSpace = '\b';
-                            static constexpr const char formFeed = '\f';
-                            static constexpr const char newLine = '\n';
-                            static constexpr const char carriageReturn = '\r';
-                            static constexpr const char tab = '\t';
-
-                            case '\\': (self->*(inObjKey ? &Child::onKey : &Child::onString))(&backSlash, 1); break;
-                            case '/': (self->*(inObjKey ? &Child::onKey : &Child::onString))(&slash, 1); break;
-                            case 'b': (self->*(inObjKey ? &Child::onKey : &Child::onString))(&backSpace, 1); break;
-                            case 'f': (self->*(inObjKey ? &Child::onKey : &Child::onString))(&formFeed, 1); break;
-                            case 'n': (self->*(inObjKey ? &Child::onKey : &Child::onString))(&newLine, 1); break;
-                            case 'r': (self->*(inObjKey ? &Child::onKey : &Child::onString))(&carriageReturn, 1); break;
-                            case 't': (self->*(inObjKey ? &Child::onKey : &Child::onString))(&tab, 1); break;
-                            default: (self->*(inObjKey ? &Child::onKeyError : &Child::onValueError))(); break;
+                        // The invalid character is processed as part of the string.
+                        if(state == State::InStringUnicode && buff != end) {
+                            stringError();
+                            state = State::InString;
                         }
 
-                        state = State::InString;
-                        buff++;
                         break;
                     case State::InNumber:
                         start = buff;
 
-                        while(buff != end && (*buff == '-' || isDigit(*buff)))
+                        while(buff != end && isNumberChar(*buff))
                             buff++;
 
-                        intParser.parseInt(start, buff - start);
+                        numberParser.parse(start, buff - start);
 
                         if(buff != end) {
                         	flushNumber();
@@ -338,25 +792,22 @@ class UJson {
 
                         break;
                     case State::AfterValue:
-                        while(buff != end) {
-                            if(!isWs(*buff)) {
-                                if(*buff == ','){
-                                	if(currentEntity() == EntityType::Object)
-                                		state = State::BeforeObjKey;
-                                	else {
-                                		if(currentEntity() == EntityType::Root)
-                                			((Child*)this)->onStructureError();
-
-                                		state = State::BeforeValue;
-                                	}
-                                } else if(*buff == ']'){
-                                	flushArray();
-                                } else if(*buff == '}'){
-                                	flushObject();
-                                }
+                        buff = Scanner::whitespace(buff, end);
 
-                                buff++;
-                                break;
+                        if(buff != end) {
+                            if(*buff == ','){
+                            	if(currentEntity() == EntityType::Object)
+                            		state = State::BeforeObjKey;
+                            	else {
+                            		if(currentEntity() == EntityType::Root)
+                            			((Child*)this)->onStructureError();
+
+                            		state = State::BeforeValue;
+                            	}
+                            } else if(*buff == ']'){
+                            	flushArray();
+                            } else if(*buff == '}'){
+                            	flushObject();
                             }
 
                             buff++;
@@ -364,39 +815,36 @@ class UJson {
 
                         break;
                     case State::BeforeObjKey:
-                        while(buff != end) {
-                            if(!isWs(*buff)) {
-                                if(*buff == '\"'){
-                                    inObjKey = true;
-                                    state = State::InString;
-                                    ((Child*)this)->beforeKey();
-                                    buff++;
-                                    break;
-                                } else if(*buff == '}') {
-                                	flushObject();
-                                	buff++;
-                                	break;
-                                } else
-                                    ((Child*)this)->onKeyError();
-                            }
+                        while((buff = Scanner::whitespace(buff, end)) != end) {
+                            if(*buff == '\"'){
+                                inObjKey = true;
+                                state = State::InString;
+                                beginString();
+                                ((Child*)this)->beforeKey();
+                                buff++;
+                                break;
+                            } else if(*buff == '}') {
+                            	flushObject();
+                            	buff++;
+                            	break;
+                            } else
+                                ((Child*)this)->onKeyError();
 
                             buff++;
                         }
                         break;
                     case State::BeforeObjColon:
-                        while(buff != end) {
-                            if(!isWs(*buff)) {
-                                if(*buff == ':'){
-                                    state = State::BeforeValue;
-                                    buff++;
-                                    break;
-                                } else if(*buff == '}') {
-                                	flushObject();
-                                	buff++;
-                                	break;
-                                } else
-                                    ((Child*)this)->onKeyError();
-                            }
+                        while((buff = Scanner::whitespace(buff, end)) != end) {
+                            if(*buff == ':'){
+                                state = State::BeforeValue;
+                                buff++;
+                                break;
+                            } else if(*buff == '}') {
+                            	flushObject();
+                            	buff++;
+                            	break;
+                            } else
+                                ((Child*)this)->onKeyError();
 
                             buff++;
                         }
@@ -410,14 +858,11 @@ class UJson {
 
         inline bool done() {
             switch(state) {
-                case State::InNumber:
-                	flushNumber();
-                	break;
-                case State::InLiteral:
-                	flushLiteral();
-                	break;
                 case State::InStringQuote:
+                case State::InStringUnicode:
                 case State::InString:
+                	dropSurrogate();
+                	flushStaged();
                 	((Child*)this)->afterValue(JsonValueType::String);
                 	((Child*)this)->onStructureError();
                 	break;
@@ -426,8 +871,18 @@ class UJson {
                 case State::BeforeObjKey:
                 	((Child*)this)->onStructureError();
                 	break;
+                case State::InNumber:
+                case State::InLiteral:
+                	if(state == State::InNumber)
+                		flushNumber();
+                	else
+                		flushLiteral();
 
+                	/* no break */
                 case State::AfterValue:
+                	// The value is complete, but not the containers around it.
+                	if(!stack.isEmpty())
+                		((Child*)this)->onStructureError();
                 	break;
             }
 
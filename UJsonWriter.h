@@ -0,0 +1,406 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2017 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#ifndef UJSONWRITER_H_
+#define UJSONWRITER_H_
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+/*
+ * Streaming JSON serializer, the counterpart of the UJson parser.
+ *
+ * The output is staged in a fixed size buffer, that is handed to the user
+ * (for example to be passed on to _HttpLogic::sendChunk_) when it is full
+ * and at the end of the document. There is no dynamic allocation involved
+ * and the amount of memory used is independent of the size of the document.
+ *
+ * The structure of the document is built through scope objects returned by
+ * the writer (for the root container) and by the enclosing container scopes
+ * (for the nested ones), for example:
+ *
+ * 		auto root = writer.object();
+ * 		root.string("name", "foo");
+ *
+ * 		auto list = root.array("values");
+ * 		for(int i = 0; i < 3; i++)
+ * 			list.integer(i);
+ * 		list.end();
+ *
+ * 		root.end();
+ * 		writer.done();
+ *
+ * The nesting depth is part of the type of the scopes, so exceeding the
+ * allowed depth is a compile-time error and there is no need for a runtime
+ * stack. On the other hand there is no runtime checking either, the scopes
+ * need to be closed in the reverse order of opening and the enclosing ones
+ * must not be written while a nested one is open.
+ *
+ * The user (_Child_) is required to implement the
+ *
+ * 		void sendJson(const char* data, uint32_t length);
+ *
+ * method, that is called with at most _bufferSize_ bytes of output at a time.
+ */
+
+namespace detail {
+	/// Two digit decimal representations of the numbers below one hundred.
+	template<class = void>
+	struct JsonDigits {
+		static constexpr const char pairs[201] =
+			"00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+			"40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+			"8081828384858687888990919293949596979899";
+	};
+
+	template<class T>
+	constexpr const char JsonDigits<T>::pairs[201];
+
+	template<class Writer, uint16_t depth> class JsonArrayScope;
+	template<class Writer, uint16_t depth> class JsonObjectScope;
+
+	/**
+	 * Common part of the scopes, keeps track of the need for separators.
+	 */
+	template<class Writer, uint16_t depth>
+	class JsonScope {
+		static_assert(depth <= Writer::maxDepth, "JSON nesting too deep");
+
+	protected:
+		Writer &writer;
+
+		/// Set until the first element is written.
+		bool first;
+
+		inline JsonScope(Writer &writer, char open): writer(writer), first(true) {
+			writer.put(open);
+		}
+
+		inline void separate() {
+			if(!first)
+				writer.put(',');
+
+			first = false;
+		}
+	};
+
+	/**
+	 * Array scope, the elements are written by the value methods.
+	 */
+	template<class Writer, uint16_t depth>
+	class JsonArrayScope: JsonScope<Writer, depth> {
+		friend Writer;
+		template<class, uint16_t> friend class JsonArrayScope;
+		template<class, uint16_t> friend class JsonObjectScope;
+
+		inline JsonArrayScope(Writer &writer): JsonScope<Writer, depth>(writer, '[') {}
+
+	public:
+		inline void null() {
+			this->separate();
+			this->writer.literal("null");
+		}
+
+		inline void boolean(bool value) {
+			this->separate();
+			this->writer.literal(value ? "true" : "false");
+		}
+
+		inline void integer(int64_t value) {
+			this->separate();
+			this->writer.integer(value);
+		}
+
+		inline void real(double value) {
+			this->separate();
+			this->writer.real(value);
+		}
+
+		inline void string(const char* value, uint32_t length) {
+			this->separate();
+			this->writer.string(value, length);
+		}
+
+		inline void string(const char* value) {
+			string(value, strlen(value));
+		}
+
+		/// Start a nested array, needs to be ended before writing this one again.
+		inline JsonArrayScope<Writer, depth + 1> array() {
+			this->separate();
+			return JsonArrayScope<Writer, depth + 1>(this->writer);
+		}
+
+		/// Start a nested object, needs to be ended before writing this one again.
+		inline JsonObjectScope<Writer, depth + 1> object() {
+			this->separate();
+			return JsonObjectScope<Writer, depth + 1>(this->writer);
+		}
+
+		inline void end() {
+			this->writer.put(']');
+		}
+	};
+
+	/**
+	 * Object scope, the members are written by the value methods,
+	 * the first argument is the name of the member.
+	 */
+	template<class Writer, uint16_t depth>
+	class JsonObjectScope: JsonScope<Writer, depth> {
+		friend Writer;
+		template<class, uint16_t> friend class JsonArrayScope;
+		template<class, uint16_t> friend class JsonObjectScope;
+
+		inline JsonObjectScope(Writer &writer): JsonScope<Writer, depth>(writer, '{') {}
+
+		inline void key(const char* name) {
+			this->separate();
+			this->writer.string(name, strlen(name));
+			this->writer.put(':');
+		}
+
+	public:
+		inline void null(const char* name) {
+			key(name);
+			this->writer.literal("null");
+		}
+
+		inline void boolean(const char* name, bool value) {
+			key(name);
+			this->writer.literal(value ? "true" : "false");
+		}
+
+		inline void integer(const char* name, int64_t value) {
+			key(name);
+			this->writer.integer(value);
+		}
+
+		inline void real(const char* name, double value) {
+			key(name);
+			this->writer.real(value);
+		}
+
+		inline void string(const char* name, const char* value, uint32_t length) {
+			key(name);
+			this->writer.string(value, length);
+		}
+
+		inline void string(const char* name, const char* value) {
+			string(name, value, strlen(value));
+		}
+
+		/// Start a nested array, needs to be ended before writing this one again.
+		inline JsonArrayScope<Writer, depth + 1> array(const char* name) {
+			key(name);
+			return JsonArrayScope<Writer, depth + 1>(this->writer);
+		}
+
+		/// Start a nested object, needs to be ended before writing this one again.
+		inline JsonObjectScope<Writer, depth + 1> object(const char* name) {
+			key(name);
+			return JsonObjectScope<Writer, depth + 1>(this->writer);
+		}
+
+		inline void end() {
+			this->writer.put('}');
+		}
+	};
+}
+
+template<class Child, uint32_t bufferSize = 64, uint16_t maxDepthParam = 8>
+class UJsonWriter {
+	static_assert(bufferSize >= 1, "JSON output buffer is too small");
+
+	template<class, uint16_t> friend class detail::JsonScope;
+	template<class, uint16_t> friend class detail::JsonArrayScope;
+	template<class, uint16_t> friend class detail::JsonObjectScope;
+
+	/// Staging buffer of the output.
+	char buffer[bufferSize];
+
+	/// Number of bytes used in the staging buffer.
+	uint32_t used;
+
+	inline void put(char c) {
+		if(used == bufferSize)
+			flush();
+
+		buffer[used++] = c;
+	}
+
+	inline void write(const char* data, uint32_t length) {
+		while(length) {
+			if(used == bufferSize)
+				flush();
+
+			uint32_t n = bufferSize - used;
+
+			if(n > length)
+				n = length;
+
+			memcpy(buffer + used, data, n);
+			used += n;
+			data += n;
+			length -= n;
+		}
+	}
+
+	inline void literal(const char* str) {
+		write(str, strlen(str));
+	}
+
+	/// Quoted string, with the control characters, quotes and backslashes escaped.
+	inline void string(const char* str, uint32_t length) {
+		static constexpr const char* hex = "0123456789abcdef";
+		const char* const end = str + length;
+
+		put('"');
+
+		while(str != end) {
+			const char* run = str;
+
+			while(str != end && (uint8_t)*str >= 0x20 && *str != '"' && *str != '\\')
+				str++;
+
+			write(run, str - run);
+
+			if(str == end)
+				break;
+
+			const uint8_t c = (uint8_t)*str++;
+			char escape[6] = {'\\', 0,};
+			uint32_t n = 2;
+
+			switch(c) {
+				case '"': escape[1] = '"'; break;
+				case '\\': escape[1] = '\\'; break;
+				case '\b': escape[1] = 'b'; break;
+				case '\f': escape[1] = 'f'; break;
+				case '\n': escape[1] = 'n'; break;
+				case '\r': escape[1] = 'r'; break;
+				case '\t': escape[1] = 't'; break;
+				default:
+					escape[1] = 'u';
+					escape[2] = '0';
+					escape[3] = '0';
+					escape[4] = hex[c >> 4];
+					escape[5] = hex[c & 0xf];
+					n = 6;
+			}
+
+			write(escape, n);
+		}
+
+		put('"');
+	}
+
+	/// Decimal integer, two digits at a time.
+	inline void integer(int64_t value) {
+		char temp[20];
+		char* p = temp + sizeof(temp);
+		uint64_t v = (value < 0) ? (0 - (uint64_t)value) : (uint64_t)value;
+
+		while(v >= 100) {
+			const uint32_t r = (uint32_t)(v % 100);
+			v /= 100;
+			p -= 2;
+			memcpy(p, detail::JsonDigits<>::pairs + 2 * r, 2);
+		}
+
+		if(v >= 10) {
+			p -= 2;
+			memcpy(p, detail::JsonDigits<>::pairs + 2 * v, 2);
+		} else
+			*--p = (char)('0' + v);
+
+		if(value < 0)
+			*--p = '-';
+
+		write(p, (uint32_t)(temp + sizeof(temp) - p));
+	}
+
+	/**
+	 * Floating point number.
+	 *
+	 * Integral values (that are exactly representable) go through the
+	 * integer formatter, the rest is printed with the shortest of 15 or
+	 * 17 significant digits that reads back as the same value. There are
+	 * no infinities and NaN in JSON, those are written as null.
+	 */
+	inline void real(double value) {
+		if(value != value || value - value != 0) {
+			literal("null");
+			return;
+		}
+
+		if(-9007199254740992.0 <= value && value <= 9007199254740992.0 && value == (double)(int64_t)value) {
+			integer((int64_t)value);
+			return;
+		}
+
+		char temp[32];
+		int n = snprintf(temp, sizeof(temp), "%.15g", value);
+
+		if(strtod(temp, nullptr) != value)
+			n = snprintf(temp, sizeof(temp), "%.17g", value);
+
+		// The decimal separator depends on the locale.
+		for(int i = 0; i < n; i++)
+			if(temp[i] == ',')
+				temp[i] = '.';
+
+		write(temp, (uint32_t)n);
+	}
+
+public:
+	static constexpr uint16_t maxDepth = maxDepthParam;
+
+	/// Reset the writer before starting a new document.
+	inline void reset() {
+		used = 0;
+	}
+
+	/// Start a root array, needs to be ended before calling _done_.
+	inline detail::JsonArrayScope<UJsonWriter, 1> array() {
+		return detail::JsonArrayScope<UJsonWriter, 1>(*this);
+	}
+
+	/// Start a root object, needs to be ended before calling _done_.
+	inline detail::JsonObjectScope<UJsonWriter, 1> object() {
+		return detail::JsonObjectScope<UJsonWriter, 1>(*this);
+	}
+
+	/// Hand over the contents of the staging buffer.
+	inline void flush() {
+		if(used) {
+			((Child*)this)->sendJson(buffer, used);
+			used = 0;
+		}
+	}
+
+	/// Finish the document, flushes the remaining output.
+	inline void done() {
+		flush();
+	}
+};
+
+#endif /* UJSONWRITER_H_ */
@@ -0,0 +1,291 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2017 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+/*
+ * SHA-256 (FIPS 180-4) with an OpenSSL-compatible interface.
+ *
+ * Whole blocks are processed by one of two kernels: a portable one, that
+ * works on any target with a 16 word rolling message schedule, and one
+ * that uses the x86 SHA extensions (SHA-NI). The latter is only compiled
+ * in for x86 targets with a GCC compatible compiler (unless SHA256_NO_SHANI
+ * is defined) and it is selected at runtime if the CPU supports it.
+ */
+
+#ifndef HAVE_OPENSSL
+
+#include <string.h>
+
+#include "sha256.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__) && !defined(SHA256_NO_SHANI)
+#define SHA256_SHANI
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+typedef void (*SHA256_kernel)(uint32_t *state, const unsigned char *data, unsigned long blocks);
+
+static const uint32_t K[64] = {
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+	0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+	0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+	0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+	0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+#define ROR(x, n)		(((x) >> (n)) | ((x) << (32 - (n))))
+#define CH(x, y, z)		((z) ^ ((x) & ((y) ^ (z))))
+#define MAJ(x, y, z)	(((x) & (y)) | ((z) & ((x) | (y))))
+#define SIGMA0(x)		(ROR(x, 2) ^ ROR(x, 13) ^ ROR(x, 22))
+#define SIGMA1(x)		(ROR(x, 6) ^ ROR(x, 11) ^ ROR(x, 25))
+#define GAMMA0(x)		(ROR(x, 7) ^ ROR(x, 18) ^ ((x) >> 3))
+#define GAMMA1(x)		(ROR(x, 17) ^ ROR(x, 19) ^ ((x) >> 10))
+
+#define LOAD(p) ( \
+	(uint32_t)(p)[0] << 24 | (uint32_t)(p)[1] << 16 | \
+	(uint32_t)(p)[2] << 8 | (uint32_t)(p)[3])
+
+#define STORE(p, v) do { \
+	(p)[0] = (unsigned char)((v) >> 24); \
+	(p)[1] = (unsigned char)((v) >> 16); \
+	(p)[2] = (unsigned char)((v) >> 8); \
+	(p)[3] = (unsigned char)(v); \
+} while(0)
+
+/*
+ * The first 16 rounds use the input words directly, the rest extend
+ * the schedule in place, so that only 16 words need to be stored.
+ */
+#define W(i) ((i) < 16 ? (w[i] = LOAD(data + 4 * (i))) : \
+	(w[(i) & 15] += GAMMA1(w[((i) - 2) & 15]) + w[((i) - 7) & 15] + GAMMA0(w[((i) - 15) & 15])))
+
+/*
+ * The working variables are rotated by renaming instead of moving them.
+ */
+#define ROUND(a, b, c, d, e, f, g, h, i) do { \
+	uint32_t t = h + SIGMA1(e) + CH(e, f, g) + K[i] + W(i); \
+	d += t; \
+	h = t + SIGMA0(a) + MAJ(a, b, c); \
+} while(0)
+
+static void SHA256_portable(uint32_t *state, const unsigned char *data, unsigned long blocks)
+{
+	uint32_t w[16];
+
+	for(; blocks; blocks--, data += 64) {
+		uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+		uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+		int i;
+
+		for(i = 0; i < 64; i += 8) {
+			ROUND(a, b, c, d, e, f, g, h, i + 0);
+			ROUND(h, a, b, c, d, e, f, g, i + 1);
+			ROUND(g, h, a, b, c, d, e, f, i + 2);
+			ROUND(f, g, h, a, b, c, d, e, i + 3);
+			ROUND(e, f, g, h, a, b, c, d, i + 4);
+			ROUND(d, e, f, g, h, a, b, c, i + 5);
+			ROUND(c, d, e, f, g, h, a, b, i + 6);
+			ROUND(b, c, d, e, f, g, h, a, i + 7);
+		}
+
+		state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+		state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+	}
+}
+
+#ifdef SHA256_SHANI
+
+/*
+ * The SHA-NI instructions work on the state in the ABEF/CDGH
+ * arrangement and do two rounds at a time, the message schedule
+ * is kept in four vectors (of four words each).
+ */
+__attribute__((target("sha,sse4.1")))
+static void SHA256_shani(uint32_t *state, const unsigned char *data, unsigned long blocks)
+{
+	const __m128i mask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+	__m128i state0, state1, msg, tmp, w[4];
+
+	tmp = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)&state[0]), 0xb1);
+	state1 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)&state[4]), 0x1b);
+	state0 = _mm_alignr_epi8(tmp, state1, 8);
+	state1 = _mm_blend_epi16(state1, tmp, 0xf0);
+
+	for(; blocks; blocks--, data += 64) {
+		const __m128i abef = state0, cdgh = state1;
+		int i;
+
+		for(i = 0; i < 16; i++) {
+			if(i < 4)
+				w[i] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(data + 16 * i)), mask);
+
+			msg = _mm_add_epi32(w[i & 3], _mm_loadu_si128((const __m128i *)&K[4 * i]));
+			state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+
+			if(3 <= i && i <= 14) {
+				tmp = _mm_alignr_epi8(w[i & 3], w[(i - 1) & 3], 4);
+				w[(i + 1) & 3] = _mm_add_epi32(w[(i + 1) & 3], tmp);
+				w[(i + 1) & 3] = _mm_sha256msg2_epu32(w[(i + 1) & 3], w[i & 3]);
+			}
+
+			msg = _mm_shuffle_epi32(msg, 0x0e);
+			state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+
+			if(1 <= i && i <= 12)
+				w[(i - 1) & 3] = _mm_sha256msg1_epu32(w[(i - 1) & 3], w[i & 3]);
+		}
+
+		state0 = _mm_add_epi32(state0, abef);
+		state1 = _mm_add_epi32(state1, cdgh);
+	}
+
+	tmp = _mm_shuffle_epi32(state0, 0x1b);
+	state1 = _mm_shuffle_epi32(state1, 0xb1);
+	state0 = _mm_blend_epi16(tmp, state1, 0xf0);
+	state1 = _mm_alignr_epi8(state1, tmp, 8);
+
+	_mm_storeu_si128((__m128i *)&state[0], state0);
+	_mm_storeu_si128((__m128i *)&state[4], state1);
+}
+
+static int SHA256_shaniSupported(void)
+{
+	unsigned int a, b, c, d;
+
+	if(__get_cpuid_max(0, 0) < 7)
+		return 0;
+
+	__cpuid(1, a, b, c, d);
+
+	if(!(c & (1 << 19)))	/* SSE4.1 */
+		return 0;
+
+	__cpuid_count(7, 0, a, b, c, d);
+	return (b & (1 << 29)) != 0;	/* SHA */
+}
+
+#endif
+
+static void SHA256_select(uint32_t *state, const unsigned char *data, unsigned long blocks);
+
+/*
+ * The first call selects the best kernel, the pointer is only ever written
+ * with the same value, so concurrent first use is harmless.
+ */
+static SHA256_kernel SHA256_blocks = &SHA256_select;
+
+static void SHA256_select(uint32_t *state, const unsigned char *data, unsigned long blocks)
+{
+	SHA256_Accelerate(1);
+	SHA256_blocks(state, data, blocks);
+}
+
+int SHA256_Accelerate(int enable)
+{
+	SHA256_blocks = &SHA256_portable;
+
+#ifdef SHA256_SHANI
+	if(enable && SHA256_shaniSupported()) {
+		SHA256_blocks = &SHA256_shani;
+		return 1;
+	}
+#else
+	(void)enable;
+#endif
+
+	return 0;
+}
+
+void SHA256_Init(SHA256_CTX *ctx)
+{
+	ctx->state[0] = 0x6a09e667;
+	ctx->state[1] = 0xbb67ae85;
+	ctx->state[2] = 0x3c6ef372;
+	ctx->state[3] = 0xa54ff53a;
+	ctx->state[4] = 0x510e527f;
+	ctx->state[5] = 0x9b05688c;
+	ctx->state[6] = 0x1f83d9ab;
+	ctx->state[7] = 0x5be0cd19;
+
+	ctx->lo = 0;
+	ctx->hi = 0;
+}
+
+void SHA256_Update(SHA256_CTX *ctx, const void *data, unsigned long size)
+{
+	const unsigned char *in = (const unsigned char *)data;
+	uint32_t used = ctx->lo & 0x3f;
+	uint32_t saved_lo = ctx->lo;
+
+	if((ctx->lo = (saved_lo + size) & 0x1fffffff) < saved_lo)
+		ctx->hi++;
+	ctx->hi += size >> 29;
+
+	if(used) {
+		uint32_t available = 64 - used;
+
+		if(size < available) {
+			memcpy(&ctx->buffer[used], in, size);
+			return;
+		}
+
+		memcpy(&ctx->buffer[used], in, available);
+		in += available;
+		size -= available;
+		SHA256_blocks(ctx->state, ctx->buffer, 1);
+	}
+
+	if(size >= 64) {
+		SHA256_blocks(ctx->state, in, size / 64);
+		in += size & ~0x3ful;
+		size &= 0x3f;
+	}
+
+	memcpy(ctx->buffer, in, size);
+}
+
+void SHA256_Final(unsigned char *result, SHA256_CTX *ctx)
+{
+	uint32_t used = ctx->lo & 0x3f;
+	int i;
+
+	ctx->buffer[used++] = 0x80;
+
+	if(used > 56) {
+		memset(&ctx->buffer[used], 0, 64 - used);
+		SHA256_blocks(ctx->state, ctx->buffer, 1);
+		used = 0;
+	}
+
+	memset(&ctx->buffer[used], 0, 56 - used);
+
+	STORE(&ctx->buffer[56], ctx->hi);
+	STORE(&ctx->buffer[60], ctx->lo << 3);
+	SHA256_blocks(ctx->state, ctx->buffer, 1);
+
+	for(i = 0; i < 8; i++)
+		STORE(&result[4 * i], ctx->state[i]);
+
+	memset(ctx, 0, sizeof(*ctx));
+}
+
+#endif
@@ -0,0 +1,60 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2017 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+/*
+ * OpenSSL-compatible interface of the SHA-256 hash (FIPS 180-4), see
+ * sha256.c for the implementation details.
+ */
+
+#ifdef HAVE_OPENSSL
+#include <openssl/sha.h>
+#elif !defined(_SHA256_H)
+#define _SHA256_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+	uint32_t state[8];
+	uint32_t lo, hi;
+	unsigned char buffer[64];
+} SHA256_CTX;
+
+extern void SHA256_Init(SHA256_CTX *ctx);
+extern void SHA256_Update(SHA256_CTX *ctx, const void *data, unsigned long size);
+extern void SHA256_Final(unsigned char *result, SHA256_CTX *ctx);
+
+/*
+ * Selects the block processing kernel: the portable one if zero is passed,
+ * the hardware accelerated one (x86 SHA extensions) otherwise if the CPU
+ * supports it. Returns non-zero if the accelerated kernel is in use.
+ *
+ * Not part of the OpenSSL interface, only needed for testing and benchmarking,
+ * by default the best available kernel is selected automatically.
+ */
+extern int SHA256_Accelerate(int enable);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
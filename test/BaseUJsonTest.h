@@ -15,6 +15,7 @@
 
 #include <string>
 #include <string.h>
+#include <stdio.h>
 
 // TODO test root value without object.
 
@@ -55,6 +56,11 @@ TEST_GROUP(UJson) {
 		inline void onNull() {MOCK(ujson)::CALL(null);}
 		inline void onBoolean(bool x) {MOCK(ujson)::CALL(boolean).withParam(x);}
 		inline void onNumber(int32_t value) {MOCK(ujson)::CALL(number).withParam(value);}
+		inline void onDouble(double value) {
+			char str[32];
+			snprintf(str, sizeof(str), "%g", value);
+			MOCK(ujson)::CALL(real).withStringParam(str);
+		}
 		inline void onString(const char *at, size_t length) {
 			value += std::string(at, length);
 
@@ -95,6 +101,10 @@ TEST_GROUP(UJson) {
 		MOCK(ujson)::EXPECT(number).withParam(value);
 	}
 
+	void expectDouble(const char* value) {
+		MOCK(ujson)::EXPECT(real).withStringParam(value);
+	}
+
 	void expectNull() {
 		MOCK(ujson)::EXPECT(null);
 	}
@@ -30,6 +30,7 @@ namespace {
 	static constexpr const char username[] = "foo";
 	static constexpr const char realm[] = "bar";
 	static constexpr const char RFC2069_A1[] = "d65f52b42a2605dd84ef29a88bd75e1d";
+	static constexpr const char nonceKey[] = "secret";
 
 	struct DavProperties {
 		static constexpr const DavProperty properties[] {
@@ -41,6 +42,7 @@ namespace {
 		HttpConfig::AuthUser<username>,
 		HttpConfig::AuthRealm<realm>,
 		HttpConfig::AuthPasswdHash<RFC2069_A1>,
+		HttpConfig::AuthNonceKey<nonceKey>,
 		HttpConfig::DavStackSize<192>,
 		HttpConfig::DavProperties<DavProperties>
 	> {
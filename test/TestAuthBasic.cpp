@@ -0,0 +1,109 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2017 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#include "1test/Test.h"
+
+#include "AuthBasic.h"
+#include "AuthDigest.h"
+
+#include <string>
+#include <algorithm>
+
+TEST_GROUP(AuthBasic) {
+	struct AuthProvider {
+		static constexpr const char* username = "Aladdin";
+		static constexpr const char* password = "open sesame";
+		static constexpr const char* realm = "test";
+		static constexpr const char* RFC2069_A1 = "aeeebbfd75d1499d24388f5b9b10e0ef";
+	};
+
+	typedef AuthBasic<AuthProvider> Uut;
+
+	union {
+		Uut uut;
+	};
+
+	bool check(const std::string &field, unsigned int fragment = 1024) {
+		uut.reset("GET");
+
+		for(unsigned int i = 0; i < field.length(); i += fragment)
+			uut.parseAuthField(field.data() + i, std::min<unsigned int>(fragment, field.length() - i));
+
+		uut.authFieldDone();
+		return uut.isAuthorized();
+	}
+};
+
+TEST(AuthBasic, Happy) {
+	CHECK(check("Basic QWxhZGRpbjpvcGVuIHNlc2FtZQ=="));
+	CHECK(strcmp(uut.getUsername(), "Aladdin") == 0);
+	CHECK(!uut.isStale());
+	CHECK(!uut.hasNonceCount());
+}
+
+TEST(AuthBasic, Segmented) {
+	for(unsigned int i = 1; i < 8; i++)
+		CHECK(check("Basic  QWxhZGRpbjpvcGVuIHNlc2FtZQ==", i));
+}
+
+TEST(AuthBasic, SchemeCase) {
+	CHECK(check("basic QWxhZGRpbjpvcGVuIHNlc2FtZQ=="));
+	CHECK(check("BASIC QWxhZGRpbjpvcGVuIHNlc2FtZQ=="));
+}
+
+TEST(AuthBasic, WrongScheme) {
+	CHECK(!check("Basil QWxhZGRpbjpvcGVuIHNlc2FtZQ=="));
+	CHECK(!check("BasicQWxhZGRpbjpvcGVuIHNlc2FtZQ=="));
+	CHECK(!check("Digest QWxhZGRpbjpvcGVuIHNlc2FtZQ=="));
+	CHECK(!check("Basic"));
+	CHECK(!check(""));
+}
+
+TEST(AuthBasic, WrongCredentials) {
+	CHECK(!check("Basic QWxhZGRpbjpvcGVuIHNlc2FtZg=="));	// Aladdin:open sesamf
+	CHECK(!check("Basic QWxhZGRpbjpvcGVuIHNlc2Ft"));		// Aladdin:open sesam
+	CHECK(!check("Basic QWxhZGRpbjpvcGVuIHNlc2FtZXM="));	// Aladdin:open sesames
+	CHECK(!check("Basic QWxhZGRpbjo="));					// Aladdin:
+	CHECK(!check("Basic YWxhZGRpbjpvcGVuIHNlc2FtZQ=="));	// aladdin:open sesame
+}
+
+TEST(AuthBasic, Invalid) {
+	CHECK(!check("Basic QWxhZGRpbjpvcGVuIHNlc2FtZQ"));
+	CHECK(!check("Basic QWxhZGRpbjpvcGVuI*Nlc2FtZQ=="));
+}
+
+TEST(AuthBasic, Either) {
+	union {
+		AuthEither<AuthDigest<AuthProvider>, Uut> either;
+	};
+
+	const char *basic = "Basic QWxhZGRpbjpvcGVuIHNlc2FtZQ==";
+	either.reset("GET");
+	either.parseAuthField(basic, strlen(basic));
+	either.authFieldDone();
+	CHECK(either.isAuthorized());
+	CHECK(!either.hasNonceCount());
+	CHECK(strcmp(either.getUsername(), "Aladdin") == 0);
+
+	const char *wrong = "Basic QWxhZGRpbjpvcGVuIHNlc2FtZg==";
+	either.reset("GET");
+	either.parseAuthField(wrong, strlen(wrong));
+	either.authFieldDone();
+	CHECK(!either.isAuthorized());
+}
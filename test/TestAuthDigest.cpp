@@ -21,6 +21,8 @@
 
 #include "AuthDigest.h"
 
+#include <string>
+
 TEST_GROUP(AuthDigest) {
 	struct AuthProvider {
 		static constexpr const char* username = "test";
@@ -357,3 +359,483 @@ TEST(AuthDigest, SemiBullshit) {
 
 	CHECK(!uut.isAuthorized());
 }
+
+TEST_GROUP(DigestNonce) {
+	static constexpr const char* key = "secret";
+};
+
+TEST(DigestNonce, Valid) {
+	char nonce[DigestNonce::length];
+	DigestNonce::generate(key, 0x12345678, 1, nonce);
+	CHECK(strncmp(nonce, "12345678", 8) == 0);
+	CHECK(DigestNonce::check(key, nonce, sizeof(nonce), 0x12345678, 10) == DigestNonce::Result::Valid);
+	CHECK(DigestNonce::check(key, nonce, sizeof(nonce), 0x12345678 + 10, 10) == DigestNonce::Result::Valid);
+	CHECK(DigestNonce::check(key, nonce, sizeof(nonce), 0x12345678 + 11, 10) == DigestNonce::Result::Stale);
+}
+
+TEST(DigestNonce, Invalid) {
+	char nonce[DigestNonce::length];
+	DigestNonce::generate(key, 0x12345678, 1, nonce);
+	CHECK(DigestNonce::check("other", nonce, sizeof(nonce), 0x12345678, 10) == DigestNonce::Result::Invalid);
+	CHECK(DigestNonce::check(key, nonce, sizeof(nonce) - 1, 0x12345678, 10) == DigestNonce::Result::Invalid);
+
+	nonce[7] = '9';
+	CHECK(DigestNonce::check(key, nonce, sizeof(nonce), 0x12345679, 10) == DigestNonce::Result::Invalid);
+}
+
+TEST(DigestNonce, Serial) {
+	char a[DigestNonce::length], b[DigestNonce::length];
+	DigestNonce::generate(key, 0x12345678, 1, a);
+	DigestNonce::generate(key, 0x12345678, 2, b);
+	CHECK(memcmp(a, b, sizeof(a)) != 0);
+	CHECK(DigestNonce::check(key, a, sizeof(a), 0x12345678, 10) == DigestNonce::Result::Valid);
+	CHECK(DigestNonce::check(key, b, sizeof(b), 0x12345678, 10) == DigestNonce::Result::Valid);
+
+	b[15] = a[15];
+	CHECK(DigestNonce::check(key, b, sizeof(b), 0x12345678, 10) == DigestNonce::Result::Invalid);
+}
+
+TEST(DigestNonce, LongKey) {
+	static constexpr const char* longKey =
+			"0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef";
+
+	char a[DigestNonce::length], b[DigestNonce::length];
+	DigestNonce::generate(longKey, 1, 1, a);
+	DigestNonce::generate(longKey + 1, 1, 1, b);
+	CHECK(memcmp(a, b, sizeof(a)) != 0);
+	CHECK(DigestNonce::check(longKey, a, sizeof(a), 1, 10) == DigestNonce::Result::Valid);
+}
+
+TEST_GROUP(AuthDigestNonce) {
+	struct AuthProvider {
+		static constexpr const char* username = "test";
+		static constexpr const char* realm = "test";
+		static constexpr const char* RFC2069_A1 = "aeeebbfd75d1499d24388f5b9b10e0ef";
+		static constexpr const char* nonceKey = "secret";
+		static constexpr uint32_t nonceLifetime = 60;
+	};
+
+	typedef AuthDigest<AuthProvider> Uut;
+
+	union {
+		Uut uut;
+	};
+
+	static void md5Hex(const std::string& in, char* out) {
+		static const char hex[] = "0123456789abcdef";
+		unsigned char temp[16];
+		MD5_CTX ctx;
+		MD5_Init(&ctx);
+		MD5_Update(&ctx, in.data(), in.length());
+		MD5_Final(temp, &ctx);
+
+		for(int i = 0; i < 16; i++) {
+			out[2 * i] = hex[temp[i] >> 4];
+			out[2 * i + 1] = hex[temp[i] & 0xf];
+		}
+
+		out[32] = '\0';
+	}
+
+	static std::string nonce(uint32_t time) {
+		char ret[DigestNonce::length];
+		DigestNonce::generate(AuthProvider::nonceKey, time, 1, ret);
+		return std::string(ret, sizeof(ret));
+	}
+
+	std::string authField(const std::string& nonce) {
+		char ha2[33], response[33];
+		md5Hex("GET:/", ha2);
+		md5Hex(std::string(AuthProvider::RFC2069_A1) + ":" + nonce + ":" + ha2, response);
+
+		return std::string("Digest username=\"test\", realm=\"test\", nonce=\"") + nonce +
+				"\", uri=\"/\", response=\"" + response + "\"";
+	}
+
+	void process(const std::string& field, uint32_t now) {
+		uut.reset("GET", now);
+		uut.parseAuthField(field.data(), field.length());
+		uut.authFieldDone();
+	}
+};
+
+TEST(AuthDigestNonce, Fresh) {
+	process(authField(nonce(1000)), 1030);
+	CHECK(uut.isAuthorized());
+	CHECK(!uut.isStale());
+}
+
+TEST(AuthDigestNonce, Stale) {
+	process(authField(nonce(1000)), 1061);
+	CHECK(!uut.isAuthorized());
+	CHECK(uut.isStale());
+}
+
+TEST(AuthDigestNonce, Forged) {
+	process(authField(nonce(1000).replace(0, 8, "000003f0")), 1000);
+	CHECK(!uut.isAuthorized());
+	CHECK(!uut.isStale());
+}
+
+TEST(AuthDigestNonce, Foreign) {
+	const char *testString = "Digest "
+			"username=\"test\", "
+			"realm=\"test\", "
+			"nonce=\"verysecurenonce\", "
+			"uri=\"/\", "
+			"response=\"d20d272dd6ec2d9f135a6c109e71415b\", ";
+
+	process(testString, 0);
+	CHECK(!uut.isAuthorized());
+	CHECK(!uut.isStale());
+}
+
+TEST_GROUP(AuthDigestQop) {
+	struct AuthProvider {
+		static constexpr const char* username = "Mufasa";
+		static constexpr const char* realm = "testrealm@host.com";
+		static constexpr const char* RFC2069_A1 = "939e7578ed9e3c518a452acee763bce9";
+	};
+
+	typedef AuthDigest<AuthProvider> Uut;
+
+	union {
+		Uut uut;
+	};
+
+	bool process(const char* field) {
+		uut.reset("GET");
+		uut.parseAuthField(field, strlen(field));
+		uut.authFieldDone();
+		return uut.isAuthorized();
+	}
+};
+
+TEST(AuthDigestQop, Rfc2617Example) {
+	const char *testString = "Digest username=\"Mufasa\", "
+			"realm=\"testrealm@host.com\", "
+			"nonce=\"dcd98b7102dd2f0e8b11d0f600bfb0c093\", "
+			"uri=\"/dir/index.html\", "
+			"qop=auth, "
+			"nc=00000001, "
+			"cnonce=\"0a4f113b\", "
+			"response=\"6629fae49393a05397450978507c4ef1\", "
+			"opaque=\"5ccc069c403ebaf9f0171e9517f40e41\"";
+
+	for(unsigned int i=0; i<strlen(testString); i++) {
+		uut.reset("GET");
+		uut.parseAuthField(testString, i);
+		uut.parseAuthField(testString + i, strlen(testString) - i);
+		uut.authFieldDone();
+
+		CHECK(uut.isAuthorized());
+		CHECK(uut.hasNonceCount());
+		CHECK(uut.getNonceCount() == 1);
+		CHECK(uut.getNonceLength() == strlen("dcd98b7102dd2f0e8b11d0f600bfb0c093"));
+	}
+}
+
+TEST(AuthDigestQop, Wrong) {
+	CHECK(!process("Digest username=\"Mufasa\", realm=\"testrealm@host.com\", "
+			"nonce=\"dcd98b7102dd2f0e8b11d0f600bfb0c093\", uri=\"/dir/index.html\", "
+			"qop=auth, nc=00000002, cnonce=\"0a4f113b\", "
+			"response=\"6629fae49393a05397450978507c4ef1\""));
+
+	CHECK(!process("Digest username=\"Mufasa\", realm=\"testrealm@host.com\", "
+			"nonce=\"dcd98b7102dd2f0e8b11d0f600bfb0c093\", uri=\"/dir/index.html\", "
+			"qop=auth-int, nc=00000001, cnonce=\"0a4f113b\", "
+			"response=\"6629fae49393a05397450978507c4ef1\""));
+
+	CHECK(!process("Digest username=\"Mufasa\", realm=\"testrealm@host.com\", "
+			"nonce=\"dcd98b7102dd2f0e8b11d0f600bfb0c093\", uri=\"/dir/index.html\", "
+			"qop=auth, nc=00000001, "
+			"response=\"6629fae49393a05397450978507c4ef1\""));
+
+	CHECK(!process("Digest username=\"Mufasa\", realm=\"testrealm@host.com\", "
+			"nonce=\"dcd98b7102dd2f0e8b11d0f600bfb0c093\", uri=\"/dir/index.html\", "
+			"qop=auth, nc=0000001x, cnonce=\"0a4f113b\", "
+			"response=\"6629fae49393a05397450978507c4ef1\""));
+}
+
+TEST_GROUP(DigestNonceCounter) {
+	DigestNonceCounter<2> uut;
+
+	TEST_SETUP() {
+		uut.reset();
+	}
+
+	bool accept(const char* nonce, uint32_t count) {
+		return uut.accept(nonce, strlen(nonce), count);
+	}
+};
+
+TEST(DigestNonceCounter, Increasing) {
+	CHECK(!accept("a", 2));
+	CHECK(accept("a", 1));
+	CHECK(!accept("a", 1));
+	CHECK(accept("a", 3));
+	CHECK(!accept("a", 2));
+	CHECK(accept("a", 4));
+}
+
+TEST(DigestNonceCounter, Eviction) {
+	CHECK(accept("a", 1));
+	CHECK(accept("b", 1));
+	CHECK(accept("a", 2));
+	CHECK(accept("c", 1));
+	CHECK(accept("a", 3));
+	CHECK(!accept("b", 2));
+	CHECK(accept("c", 2));
+}
+
+TEST_GROUP(AuthDigestSha256) {
+	struct AuthProvider {
+		static constexpr const char* username = "Mufasa";
+		static constexpr const char* realm = "http-auth@example.org";
+		static constexpr const char* RFC2069_A1 = "7987c64c30e25f1b74be53f966b49b90f2808aa92faf9a00262392d7b4794232";
+	};
+
+	typedef AuthDigest<AuthProvider, DigestSha256> Uut;
+
+	union {
+		Uut uut;
+	};
+
+	bool process(const char* field) {
+		uut.reset("GET");
+		uut.parseAuthField(field, strlen(field));
+		uut.authFieldDone();
+		return uut.isAuthorized();
+	}
+};
+
+TEST(AuthDigestSha256, Qop) {
+	const char *testString = "Digest username=\"Mufasa\", "
+			"realm=\"http-auth@example.org\", "
+			"uri=\"/dir/index.html\", "
+			"algorithm=SHA-256, "
+			"nonce=\"7ypf/xlj9XXwfDPEoM4URrv/xwf94BcC\", "
+			"nc=00000001, "
+			"cnonce=\"f2/wE4q74E6zIJEtWaHKaf5wv/H5Qzzp\", "
+			"qop=auth, "
+			"response=\"232f884cfd73b5407d03b8bbbdac93821d7ea8b4a8e041213d0246edc6517f7f\"";
+
+	for(unsigned int i=0; i<strlen(testString); i++) {
+		uut.reset("GET");
+		uut.parseAuthField(testString, i);
+		uut.parseAuthField(testString + i, strlen(testString) - i);
+		uut.authFieldDone();
+
+		CHECK(uut.isAuthorized());
+	}
+}
+
+TEST(AuthDigestSha256, NoQop) {
+	CHECK(process("Digest username=\"Mufasa\", realm=\"http-auth@example.org\", "
+			"uri=\"/dir/index.html\", nonce=\"7ypf/xlj9XXwfDPEoM4URrv/xwf94BcC\", "
+			"response=\"e2eb4622d72d2e1331892dec3a91973cd40dfa53f6cd3cadfda54897bde3e5b7\""));
+}
+
+TEST(AuthDigestSha256, Wrong) {
+	CHECK(!process("Digest username=\"Mufasa\", realm=\"http-auth@example.org\", "
+			"uri=\"/dir/index.html\", algorithm=MD5, nonce=\"7ypf/xlj9XXwfDPEoM4URrv/xwf94BcC\", "
+			"response=\"e2eb4622d72d2e1331892dec3a91973cd40dfa53f6cd3cadfda54897bde3e5b7\""));
+
+	CHECK(!process("Digest username=\"Mufasa\", realm=\"http-auth@example.org\", "
+			"uri=\"/dir/index.html\", nonce=\"7ypf/xlj9XXwfDPEoM4URrv/xwf94BcC\", "
+			"response=\"e2eb4622d72d2e1331892dec3a91973cd40dfa53f6cd3cadfda54897bde3e5b8\""));
+
+	CHECK(!process("Digest username=\"Mufasa\", realm=\"http-auth@example.org\", "
+			"uri=\"/dir/index.html\", nonce=\"7ypf/xlj9XXwfDPEoM4URrv/xwf94BcC\", "
+			"response=\"98cdbfa8c53c6b0e07c68a117b414a98\""));
+}
+
+namespace {
+	struct DigestUsers {
+		static constexpr DigestCredential credentials[] = {
+			DigestCredential("Mufasa", "939e7578ed9e3c518a452acee763bce9"),
+			DigestCredential("Simba", "00000000000000000000000000000000")
+		};
+	};
+
+	constexpr DigestCredential DigestUsers::credentials[];
+}
+
+TEST_GROUP(AuthDigestCredentials) {
+	struct AuthProvider {
+		static constexpr const char* realm = "testrealm@host.com";
+		typedef StaticCredentials<DigestUsers> Credentials;
+	};
+
+	typedef AuthDigest<AuthProvider> Uut;
+
+	union {
+		Uut uut;
+	};
+
+	bool process(const char* field) {
+		uut.reset("GET");
+		uut.parseAuthField(field, strlen(field));
+		uut.authFieldDone();
+		return uut.isAuthorized();
+	}
+};
+
+TEST(AuthDigestCredentials, Known) {
+	CHECK(process("Digest username=\"Mufasa\", realm=\"testrealm@host.com\", "
+			"nonce=\"dcd98b7102dd2f0e8b11d0f600bfb0c093\", uri=\"/dir/index.html\", "
+			"qop=auth, nc=00000001, cnonce=\"0a4f113b\", "
+			"response=\"6629fae49393a05397450978507c4ef1\""));
+
+	CHECK(strcmp(uut.getUsername(), "Mufasa") == 0);
+}
+
+TEST(AuthDigestCredentials, Wrong) {
+	CHECK(!process("Digest username=\"Simba\", realm=\"testrealm@host.com\", "
+			"nonce=\"dcd98b7102dd2f0e8b11d0f600bfb0c093\", uri=\"/dir/index.html\", "
+			"qop=auth, nc=00000001, cnonce=\"0a4f113b\", "
+			"response=\"6629fae49393a05397450978507c4ef1\""));
+
+	CHECK(!process("Digest username=\"Nala\", realm=\"testrealm@host.com\", "
+			"nonce=\"dcd98b7102dd2f0e8b11d0f600bfb0c093\", uri=\"/dir/index.html\", "
+			"qop=auth, nc=00000001, cnonce=\"0a4f113b\", "
+			"response=\"6629fae49393a05397450978507c4ef1\""));
+
+	CHECK(!process("Digest realm=\"testrealm@host.com\", "
+			"nonce=\"dcd98b7102dd2f0e8b11d0f600bfb0c093\", uri=\"/dir/index.html\", "
+			"qop=auth, nc=00000001, cnonce=\"0a4f113b\", "
+			"response=\"6629fae49393a05397450978507c4ef1\""));
+}
+
+namespace {
+	struct CountingMd5: DigestMd5 {
+		static uint32_t finals;
+
+		static inline void final(unsigned char* result, Context* ctx) {
+			finals++;
+			DigestMd5::final(result, ctx);
+		}
+	};
+
+	uint32_t CountingMd5::finals;
+}
+
+TEST_GROUP(AuthDigestCache) {
+	struct AuthProvider {
+		static constexpr const char* username = "test";
+		static constexpr const char* realm = "test";
+		static constexpr const char* RFC2069_A1 = "aeeebbfd75d1499d24388f5b9b10e0ef";
+	};
+
+	struct QopAuthProvider {
+		static constexpr const char* username = "Mufasa";
+		static constexpr const char* realm = "testrealm@host.com";
+		static constexpr const char* RFC2069_A1 = "939e7578ed9e3c518a452acee763bce9";
+	};
+
+	typedef AuthDigest<AuthProvider, CountingMd5> Uut;
+	typedef AuthDigest<QopAuthProvider, CountingMd5> QopUut;
+
+	union {
+		Uut uut;
+		QopUut qopUut;
+	};
+
+	AuthDigestCache<Uut, true> cache;
+	AuthDigestCache<QopUut, true> qopCache;
+
+	TEST_SETUP() {
+		cache.clear();
+		qopCache.clear();
+	}
+
+	uint32_t process(const char* field, bool &ok) {
+		CountingMd5::finals = 0;
+		uut.reset("GET", 0, cache.get());
+		uut.parseAuthField(field, strlen(field));
+		uut.authFieldDone();
+		ok = uut.isAuthorized();
+		return CountingMd5::finals;
+	}
+
+	uint32_t processQop(const char* field, bool &ok) {
+		CountingMd5::finals = 0;
+		qopUut.reset("GET", 0, qopCache.get());
+		qopUut.parseAuthField(field, strlen(field));
+		qopUut.authFieldDone();
+		ok = qopUut.isAuthorized();
+		return CountingMd5::finals;
+	}
+};
+
+static constexpr const char* cacheRoot = "Digest username=\"test\", realm=\"test\", "
+		"nonce=\"verysecurenonce\", uri=\"/\", "
+		"response=\"d20d272dd6ec2d9f135a6c109e71415b\"";
+
+static constexpr const char* cacheOther = "Digest username=\"test\", realm=\"test\", "
+		"nonce=\"verysecurenonce\", uri=\"/x\", "
+		"response=\"5f478fae8539214326433835c8d8d7c3\"";
+
+TEST(AuthDigestCache, Repeated) {
+	bool ok;
+	CHECK(process(cacheRoot, ok) == 2 && ok);
+	CHECK(process(cacheRoot, ok) == 1 && ok);
+	CHECK(process(cacheRoot, ok) == 1 && ok);
+}
+
+TEST(AuthDigestCache, Changed) {
+	bool ok;
+	CHECK(process(cacheRoot, ok) == 2 && ok);
+	CHECK(process(cacheOther, ok) == 2 && ok);
+	CHECK(process(cacheOther, ok) == 1 && ok);
+
+	CHECK(process("Digest username=\"test\", realm=\"test\", "
+			"nonce=\"verysecurenonce\", uri=\"/\", "
+			"response=\"5f478fae8539214326433835c8d8d7c3\"", ok) == 2 && !ok);
+
+	CHECK(process("Digest username=\"test\", realm=\"test\", "
+			"nonce=\"othernonce\", uri=\"/x\", "
+			"response=\"5f478fae8539214326433835c8d8d7c3\"", ok) == 2 && !ok);
+
+	CHECK(process("Digest username=\"test\", realm=\"test\", "
+			"nonce=\"verysecurenonce\", uri=\"/x\", "
+			"response=\"5f478fae8539214326433835c8d8d7c4\"", ok) == 2 && !ok);
+
+	CHECK(process("Digest username=\"test\", realm=\"test\", "
+			"nonce=\"verysecurenonce\", "
+			"response=\"5f478fae8539214326433835c8d8d7c3\"", ok) == 0 && !ok);
+
+	CHECK(process(cacheOther, ok) == 1 && ok);
+}
+
+TEST(AuthDigestCache, Cleared) {
+	bool ok;
+	CHECK(process(cacheRoot, ok) == 2 && ok);
+	cache.clear();
+	CHECK(process(cacheRoot, ok) == 2 && ok);
+	CHECK(process(cacheRoot, ok) == 1 && ok);
+}
+
+TEST(AuthDigestCache, Failed) {
+	bool ok;
+	CHECK(process("Digest username=\"test\", realm=\"test\", "
+			"nonce=\"verysecurenonce\", uri=\"/\", "
+			"response=\"d20d272dd6ec2d9f135a6c109e71415c\"", ok) == 2 && !ok);
+
+	CHECK(process("Digest username=\"test\", realm=\"test\", "
+			"nonce=\"verysecurenonce\", uri=\"/\", "
+			"response=\"d20d272dd6ec2d9f135a6c109e71415c\"", ok) == 2 && !ok);
+}
+
+TEST(AuthDigestCache, QopNotCached) {
+	const char *testString = "Digest username=\"Mufasa\", "
+			"realm=\"testrealm@host.com\", "
+			"nonce=\"dcd98b7102dd2f0e8b11d0f600bfb0c093\", "
+			"uri=\"/dir/index.html\", "
+			"qop=auth, nc=00000001, cnonce=\"0a4f113b\", "
+			"response=\"6629fae49393a05397450978507c4ef1\"";
+
+	bool ok;
+	CHECK(processQop(testString, ok) == 2 && ok);
+	CHECK(processQop(testString, ok) == 2 && ok);
+}
@@ -159,3 +159,139 @@ TEST(Base64, Back2back) {
 		CHECK(cross.result == std::string(temp, i));
 	}
 }
+
+TEST(Base64, Kernels) {
+	const bool vectorized = Base64::accelerate(true);
+
+	for(int accelerated = 0; accelerated < 2; accelerated++) {
+		Base64::accelerate(accelerated);
+
+		for(unsigned int i = 0; i < 300; i++) {
+			std::string data;
+			for(unsigned int j = 0; j < i; j++)
+				data += (char)(j * 167 + i * 13);
+
+			fut.reset();
+			fut.format(data.data(), data.length());
+			fut.done();
+			CHECK(fut.output.length() == (i + 2) / 3 * 4);
+
+			for(unsigned int j = 0; j < fut.output.length(); j += 7) {
+				put.reset();
+				CHECK(put.parse(fut.output.data(), j));
+				CHECK(put.parse(fut.output.data() + j, fut.output.length() - j));
+				CHECK(put.done());
+				CHECK(put.output == data);
+			}
+		}
+	}
+
+	Base64::accelerate(vectorized);
+}
+
+TEST(Base64, KernelsInvalid) {
+	static constexpr const char* invalid = "@[`{ \r\n\x80\xff";
+	const bool vectorized = Base64::accelerate(true);
+
+	for(int accelerated = 0; accelerated < 2; accelerated++) {
+		Base64::accelerate(accelerated);
+
+		for(unsigned int i = 0; i < 64; i++) {
+			for(const char* c = invalid; *c; c++) {
+				std::string input(64, 'A');
+				input[i] = *c;
+
+				put.reset();
+				CHECK(!put.parse(input.data(), input.length()));
+			}
+		}
+	}
+
+	Base64::accelerate(vectorized);
+}
+
+TEST(Base64, Blocks) {
+	struct Bput: public Base64::Parser<Bput> {
+		std::string output;
+		unsigned int calls = 0;
+
+		inline void bytesDecoded(const char* buff, uint32_t length) {
+			output += std::string(buff, length);
+			calls++;
+		}
+	} bput;
+
+	struct Bfut: public Base64::Formater<Bfut> {
+		std::string output;
+		unsigned int calls = 0;
+
+		inline void bytesEncoded(const char* buff, uint32_t length) {
+			output += std::string(buff, length);
+			calls++;
+		}
+	} bfut;
+
+	const std::string data(1000, 'x');
+
+	bfut.reset();
+	bfut.format(data.data(), data.length());
+	bfut.done();
+	CHECK(bfut.calls < 20);
+
+	bput.reset();
+	CHECK(bput.parse(bfut.output.data(), bfut.output.length()));
+	CHECK(bput.done());
+	CHECK(bput.output == data);
+	CHECK(bput.calls < 20);
+}
+
+TEST(Base64, Decoder) {
+	const std::string data = "The quick brown fox jumps over the lazy dog.";
+
+	fut.reset();
+	fut.format(data.data(), data.length());
+	fut.done();
+
+	for(unsigned int space = 1; space < 20; space++) {
+		for(unsigned int split = 0; split <= fut.output.length(); split += 5) {
+			Base64::Decoder decoder;
+			decoder.reset();
+
+			std::string result;
+			const char* fragments[] = {fut.output.data(), fut.output.data() + split};
+			const uint32_t lengths[] = {split, (uint32_t)(fut.output.length() - split)};
+
+			for(int i = 0; i < 2; i++) {
+				const char* buff = fragments[i];
+				uint32_t length = lengths[i];
+
+				while(length) {
+					char output[20];
+					const uint32_t n = decoder.decode(buff, length, output, space);
+					CHECK(n <= space);
+					CHECK(decoder.isValid());
+					result += std::string(output, n);
+				}
+			}
+
+			CHECK(decoder.done());
+			CHECK(result == data);
+		}
+	}
+}
+
+TEST(Base64, DecoderInvalid) {
+	static constexpr const char* input = "Zm9vYmFy@Zm9v";
+	const char* buff = input;
+	uint32_t length = strlen(input);
+	char output[16];
+
+	Base64::Decoder decoder;
+	decoder.reset();
+
+	CHECK(decoder.decode(buff, length, output, sizeof(output)) == 6);
+	CHECK(!decoder.isValid());
+	CHECK(!decoder.done());
+	CHECK(*buff == '@');
+	CHECK(length == 5);
+}
@@ -101,3 +101,24 @@ TEST(ConstantStringMatcher, SegmentedFail)
 	uut.progressWithMatching(str, "r", 1);
 	CHECK(!uut.matches(str));
 }
+
+TEST(ConstantStringMatcher, NoCase)
+{
+	static constexpr const char* str = "100-continue";
+	uut.reset();
+	uut.progressWithMatchingNoCase(str, "100-Con", 7);
+	uut.progressWithMatchingNoCase(str, "TINUE", 5);
+	CHECK(uut.matches(str));
+
+	uut.reset();
+	uut.progressWithMatchingNoCase(str, "100-continue", 12);
+	CHECK(uut.matches(str));
+
+	uut.reset();
+	uut.progressWithMatchingNoCase(str, "100_continue", 12);
+	CHECK(!uut.matches(str));
+
+	uut.reset();
+	uut.progressWithMatchingNoCase(str, "100-continues", 13);
+	CHECK(!uut.matches(str));
+}
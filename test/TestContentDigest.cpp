@@ -0,0 +1,95 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2017 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#include "1test/Test.h"
+
+#include "ContentDigest.h"
+
+#include <string>
+#include <string.h>
+
+TEST_GROUP(ContentDigest) {
+	ContentDigest uut;
+
+	TEST_SETUP() {
+		uut.reset();
+	}
+
+	/*
+	 * Feeds the header field value split at every possible position, then
+	 * the body and returns the result of the check (or false if malformed).
+	 */
+	bool check(void (ContentDigest::*parser)(const char*, uint32_t), const char* field, const char* body) {
+		for(unsigned int i = 0; i <= strlen(field); i++) {
+			uut.reset();
+			(uut.*parser)(nullptr, -1u);
+			(uut.*parser)(field, i);
+			(uut.*parser)(field + i, strlen(field) - i);
+			(uut.*parser)(nullptr, 0);
+
+			if(uut.isMalformed())
+				return false;
+
+			uut.update(body, strlen(body));
+
+			if(!uut.matches())
+				return false;
+		}
+
+		return true;
+	}
+};
+
+TEST(ContentDigest, None) {
+	uut.update("Hello, world!", strlen("Hello, world!"));
+	CHECK(!uut.isMalformed());
+	CHECK(uut.matches());
+}
+
+TEST(ContentDigest, ContentMd5) {
+	CHECK(check(&ContentDigest::parseContentMd5, "bNNVbesNpUvKBgtMOUeYOQ==", "Hello, world!"));
+	CHECK(check(&ContentDigest::parseContentMd5, "1B2M2Y8AsgTpgAmY7PhCfg==", ""));
+}
+
+TEST(ContentDigest, ContentMd5Mismatch) {
+	CHECK(!check(&ContentDigest::parseContentMd5, "bNNVbesNpUvKBgtMOUeYOQ==", "Hello, world?"));
+	CHECK(!check(&ContentDigest::parseContentMd5, "1B2M2Y8AsgTpgAmY7PhCfg==", "Hello, world!"));
+}
+
+TEST(ContentDigest, ContentMd5Malformed) {
+	CHECK(!check(&ContentDigest::parseContentMd5, "bNNVbesNpUvKBgtMOUeY", "Hello, world!"));
+	CHECK(!check(&ContentDigest::parseContentMd5, "bNNVbesNpUvKBgtMOUeYOQAA", "Hello, world!"));
+	CHECK(!check(&ContentDigest::parseContentMd5, "bNNVbesNpUvKBgtMOUe?OQ==", "Hello, world!"));
+	CHECK(!check(&ContentDigest::parseContentMd5, "", "Hello, world!"));
+}
+
+TEST(ContentDigest, Digest) {
+	CHECK(check(&ContentDigest::parseDigest, "MD5=bNNVbesNpUvKBgtMOUeYOQ==", "Hello, world!"));
+	CHECK(check(&ContentDigest::parseDigest, "md5=bNNVbesNpUvKBgtMOUeYOQ==", "Hello, world!"));
+	CHECK(check(&ContentDigest::parseDigest, "SHA=lDpwLQbzRZmu4fjajvn3KWAx1pk=, MD5=bNNVbesNpUvKBgtMOUeYOQ==", "Hello, world!"));
+	CHECK(check(&ContentDigest::parseDigest, "MD5=bNNVbesNpUvKBgtMOUeYOQ==,UNIXsum=30637", "Hello, world!"));
+	CHECK(!check(&ContentDigest::parseDigest, "MD5=bNNVbesNpUvKBgtMOUeYOQ==", "Hello, world?"));
+	CHECK(!check(&ContentDigest::parseDigest, "SHA=lDpwLQbzRZmu4fjajvn3KWAx1pk=, MD5=bNNVbes", "Hello, world!"));
+}
+
+TEST(ContentDigest, DigestOtherAlgorithm) {
+	CHECK(check(&ContentDigest::parseDigest, "SHA=lDpwLQbzRZmu4fjajvn3KWAx1pk=", "Hello, world?"));
+	CHECK(check(&ContentDigest::parseDigest, "MD55=bNNVbesNpUvKBgtMOUeYOQ==", "Hello, world?"));
+	CHECK(check(&ContentDigest::parseDigest, "MD=bNNVbesNpUvKBgtMOUeYOQ==", "Hello, world?"));
+}
@@ -0,0 +1,373 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2017 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#include "1test/Test.h"
+
+#include "DavLock.h"
+
+#include <string.h>
+
+TEST_GROUP(DavLock) {
+	typedef DavLockTable<3> Table;
+	Table table;
+
+	TEST_SETUP() {
+		table.reset();
+	}
+
+	/// Process the slash separated path elements the same way as HttpLogic does.
+	DavLockPath at(const char* path) {
+		DavLockPath ret;
+		ret.reset();
+
+		while(*path) {
+			const char* end = strchr(path, '/');
+			const uint32_t length = end ? end - path : strlen(path);
+
+			table.enterCollection(ret);
+			ret.separator();
+			ret.update(path, length);
+			path += end ? length + 1 : length;
+		}
+
+		return ret;
+	}
+};
+
+TEST(DavLock, PathHash) {
+	constexpr const char* input = "foobar";
+
+	DavLockPath a, b;
+	a.reset();
+	a.update(input, strlen(input));
+
+	for(unsigned int i = 0; i<strlen(input); i++) {
+		b.reset();
+		b.update(input, i);
+		b.update(input + i, strlen(input)-i);
+		CHECK(a.hash == b.hash);
+	}
+
+	b.reset();
+	b.update("foo", 3);
+	b.separator();
+	b.update("bar", 3);
+	CHECK(a.hash != b.hash);
+}
+
+TEST(DavLock, ExclusiveConflict) {
+	const Table::Lock *a = nullptr, *b = nullptr;
+	CHECK(table.acquire(at("foo"), true, false, 10, 0, a) == Table::Result::Ok);
+	CHECK(a && a->token);
+	CHECK(table.acquire(at("foo"), true, false, 10, 0, b) == Table::Result::Conflict);
+	CHECK(table.acquire(at("foo"), false, false, 10, 0, b) == Table::Result::Conflict);
+	CHECK(table.acquire(at("bar"), true, false, 10, 0, b) == Table::Result::Ok);
+	CHECK(a->token != b->token);
+}
+
+TEST(DavLock, Shared) {
+	const Table::Lock *a = nullptr, *b = nullptr;
+	CHECK(table.acquire(at("foo"), false, false, 10, 0, a) == Table::Result::Ok);
+	CHECK(table.acquire(at("foo"), false, false, 10, 0, b) == Table::Result::Ok);
+	CHECK(a != b);
+	CHECK(table.acquire(at("foo"), true, false, 10, 0, b) == Table::Result::Conflict);
+}
+
+TEST(DavLock, Full) {
+	const Table::Lock *lock = nullptr;
+	CHECK(table.acquire(at("foo"), true, false, 10, 0, lock) == Table::Result::Ok);
+	CHECK(table.acquire(at("bar"), true, false, 10, 0, lock) == Table::Result::Ok);
+	CHECK(table.acquire(at("baz"), true, false, 10, 0, lock) == Table::Result::Ok);
+	CHECK(table.acquire(at("qux"), true, false, 10, 0, lock) == Table::Result::Full);
+	CHECK(table.release(lock->token, at("baz"), 0));
+	CHECK(table.acquire(at("qux"), true, false, 10, 0, lock) == Table::Result::Ok);
+}
+
+TEST(DavLock, Expiry) {
+	const Table::Lock *lock = nullptr;
+	CHECK(table.acquire(at("foo"), true, false, 10, -5u, lock) == Table::Result::Ok);
+	CHECK(table.acquire(at("foo"), true, false, 10, 4, lock) == Table::Result::Conflict);
+	CHECK(table.acquire(at("foo"), true, false, 10, 5, lock) == Table::Result::Ok);
+	CHECK(lock->expiry == 15);
+}
+
+TEST(DavLock, Refresh) {
+	const Table::Lock *lock = nullptr;
+	CHECK(table.acquire(at("foo"), true, false, 10, 0, lock) == Table::Result::Ok);
+	const uint32_t token = lock->token;
+	CHECK(!table.refresh(token, at("bar"), 10, 5));
+	CHECK(!table.refresh(token + 1, at("foo"), 10, 5));
+	CHECK(table.refresh(token, at("foo"), 10, 5) == lock);
+	CHECK(lock->expiry == 15);
+	CHECK(!table.refresh(token, at("foo"), 10, 15));
+}
+
+TEST(DavLock, Release) {
+	const Table::Lock *lock = nullptr;
+	CHECK(table.acquire(at("foo"), true, false, 10, 0, lock) == Table::Result::Ok);
+	const uint32_t token = lock->token;
+	CHECK(!table.release(token, at("bar"), 0));
+	CHECK(!table.release(token + 1, at("foo"), 0));
+	CHECK(table.release(token, at("foo"), 0));
+	CHECK(!table.release(token, at("foo"), 0));
+}
+
+TEST(DavLock, Deep) {
+	const Table::Lock *lock = nullptr;
+	CHECK(table.acquire(at("dir"), true, true, 10, 0, lock) == Table::Result::Ok);
+	const uint32_t token = lock->token;
+	CHECK(at("dir/foo").covers);
+	CHECK(!at("foo").covers);
+	CHECK(table.acquire(at("dir/foo"), false, false, 10, 0, lock) == Table::Result::Conflict);
+	CHECK(table.acquire(at("foo"), false, false, 10, 0, lock) == Table::Result::Ok);
+	CHECK(table.release(token, at("dir/bar"), 0));
+}
+
+TEST(DavLock, Permits) {
+	struct Tokens {
+		uint32_t token;
+		bool contains(uint32_t t) const { return t == token; }
+	};
+
+	const Table::Lock *lock = nullptr;
+	CHECK(table.acquire(at("dir"), true, true, 10, 0, lock) == Table::Result::Ok);
+	const uint32_t token = lock->token;
+
+	CHECK(table.permits(at("foo"), Tokens{0}, 0));
+	CHECK(!table.permits(at("dir/foo"), Tokens{0}, 0));
+	CHECK(!table.permits(at("dir"), Tokens{0}, 0));
+	CHECK(table.permits(at("dir/foo"), Tokens{token}, 0));
+	CHECK(table.permits(at("dir/foo"), Tokens{0}, 10));
+}
+
+TEST(DavLock, SharedPermits) {
+	struct Tokens {
+		uint32_t token;
+		bool contains(uint32_t t) const { return t == token; }
+	};
+
+	const Table::Lock *a = nullptr, *b = nullptr;
+	CHECK(table.acquire(at("foo"), false, false, 10, 0, a) == Table::Result::Ok);
+	CHECK(table.acquire(at("foo"), false, false, 10, 0, b) == Table::Result::Ok);
+
+	CHECK(table.permits(at("foo"), Tokens{a->token}, 0));
+	CHECK(table.permits(at("foo"), Tokens{b->token}, 0));
+	CHECK(!table.permits(at("foo"), Tokens{0}, 0));
+	CHECK(table.permitsRemoval(at("foo"), Tokens{a->token}, 0));
+}
+
+TEST(DavLock, Nested) {
+	struct Tokens {
+		uint32_t token;
+		bool contains(uint32_t t) const { return t == token; }
+	};
+
+	const Table::Lock *outer = nullptr, *inner = nullptr, *member = nullptr;
+	CHECK(table.acquire(at("a"), false, true, 10, 0, outer) == Table::Result::Ok);
+	CHECK(table.acquire(at("a/b"), false, true, 10, 0, inner) == Table::Result::Ok);
+	CHECK(table.acquire(at("a/b/c"), true, false, 10, 0, member) == Table::Result::Conflict);
+	CHECK(table.acquire(at("a/b/c"), false, false, 10, 0, member) == Table::Result::Ok);
+
+	CHECK(table.permits(at("a/b/c"), Tokens{outer->token}, 0));
+	CHECK(table.permits(at("a/b/c"), Tokens{inner->token}, 0));
+	CHECK(table.permits(at("a/b/c"), Tokens{member->token}, 0));
+	CHECK(!table.permits(at("a/b/c"), Tokens{0}, 0));
+	CHECK(table.permits(at("a/x"), Tokens{outer->token}, 0));
+	CHECK(!table.permits(at("a/x"), Tokens{inner->token}, 0));
+
+	CHECK(table.permitsRemoval(at("a/b"), Tokens{outer->token}, 0));
+	CHECK(table.permitsRemoval(at("a/b"), Tokens{inner->token}, 0));
+	CHECK(!table.permitsRemoval(at("a/b"), Tokens{member->token}, 0));
+	CHECK(table.permitsRemoval(at("a"), Tokens{outer->token}, 0));
+	CHECK(!table.permitsRemoval(at("a"), Tokens{inner->token}, 0));
+
+	const uint32_t token = inner->token;
+	CHECK(table.release(token, at("a/b"), 0));
+	CHECK(!table.release(token, at("a/b"), 0));
+	CHECK(table.permits(at("a/b/c"), Tokens{outer->token}, 0));
+}
+
+TEST(DavLock, TokenSeed) {
+	const Table::Lock *a = nullptr, *b = nullptr;
+	CHECK(table.acquire(at("foo"), true, false, 10, 0, a) == Table::Result::Ok);
+	CHECK(table.acquire(at("bar"), true, false, 10, 0, b) == Table::Result::Ok);
+	const uint32_t first = a->token, second = b->token;
+	CHECK(first + 1 != second);
+
+	table.reset();
+	CHECK(table.acquire(at("foo"), true, false, 10, 0, a) == Table::Result::Ok);
+	CHECK(a->token == first);
+
+	table.reset(0xc0ffee);
+	CHECK(table.acquire(at("foo"), true, false, 10, 0, a) == Table::Result::Ok);
+	CHECK(a->token != first);
+
+	table.reset();
+	CHECK(table.acquire(at("foo"), true, false, 10, 1, a) == Table::Result::Ok);
+	CHECK(a->token != first);
+}
+
+TEST(DavLock, Members) {
+	struct Tokens {
+		uint32_t token;
+		bool contains(uint32_t t) const { return t == token; }
+	};
+
+	const Table::Lock *lock = nullptr;
+	CHECK(table.acquire(at("dir/sub/file"), true, false, 10, 0, lock) == Table::Result::Ok);
+	const uint32_t token = lock->token;
+
+	CHECK(!table.permitsRemoval(at("dir"), Tokens{0}, 0));
+	CHECK(!table.permitsRemoval(at("dir/sub"), Tokens{0}, 0));
+	CHECK(!table.permitsRemoval(at("dir/sub/file"), Tokens{0}, 0));
+	CHECK(!table.permitsRemoval(at(""), Tokens{0}, 0));
+	CHECK(table.permitsRemoval(at("dir/file"), Tokens{0}, 0));
+	CHECK(table.permitsRemoval(at("sub"), Tokens{0}, 0));
+	CHECK(table.permitsRemoval(at("dir"), Tokens{token}, 0));
+	CHECK(table.permitsRemoval(at("dir"), Tokens{0}, 10));
+	CHECK(table.permits(at("dir"), Tokens{0}, 0));
+
+	CHECK(table.acquire(at("dir"), false, true, 10, 0, lock) == Table::Result::Conflict);
+	CHECK(table.acquire(at("dir"), true, false, 10, 0, lock) == Table::Result::Ok);
+}
+
+TEST(DavLock, DeepMembers) {
+	struct Tokens {
+		bool contains(uint32_t t) const { return false; }
+	};
+
+	const Table::Lock *lock = nullptr;
+	CHECK(table.acquire(at("a/b/c/d/e/f"), true, false, 10, 0, lock) == Table::Result::Ok);
+
+	CHECK(!table.permitsRemoval(at("a/b/c"), Tokens{}, 0));
+	CHECK(!table.permitsRemoval(at("a/b/c/d/e"), Tokens{}, 0));
+	CHECK(!table.permitsRemoval(at("a/b/c/x/e"), Tokens{}, 0));
+	CHECK(table.permitsRemoval(at("a/b/x/d/e"), Tokens{}, 0));
+	CHECK(table.permitsRemoval(at("a/b/c/d/e/f/g"), Tokens{}, 0));
+}
+
+TEST(DavLock, Tokens) {
+	constexpr const char* input = "(<opaquelocktoken:c0ffee>) (Not <opaquelocktoken:opaquelocktoken:42> <urn:x>)";
+
+	for(unsigned int i = 0; i<strlen(input); i++) {
+		DavLockTokenParser<3> uut;
+		uut.reset();
+		uut.parseTokens(input, i);
+		uut.parseTokens(input + i, strlen(input)-i);
+		uut.done();
+		CHECK(uut.getCount() == 2);
+		CHECK(uut.getToken(0) == 0xc0ffee);
+		CHECK(uut.getToken(1) == 0x42);
+		CHECK(uut.contains(0x42));
+		CHECK(!uut.contains(0x43));
+	}
+}
+
+TEST(DavLock, TokenOverflow) {
+	constexpr const char* input = "<opaquelocktoken:1><opaquelocktoken:2><opaquelocktoken:3>";
+	DavLockTokenParser<2> uut;
+	uut.reset();
+	uut.parseTokens(input, strlen(input));
+	uut.done();
+	CHECK(uut.getCount() == 2);
+	CHECK(!uut.contains(3));
+}
+
+TEST(DavLock, Timeout) {
+	struct {
+		const char* input;
+		uint32_t result;
+	} cases[] = {
+		{"Second-3600", 3600},
+		{" Second-10, Infinite", 10},
+		{"Infinite, Second-10", -1u},
+		{"Second-99999999999", -1u},
+		{"Second-", 0},
+		{"Seconds-1", 0},
+		{"Infinity", 0},
+		{"", 0},
+	};
+
+	for(auto &c: cases) {
+		for(unsigned int i = 0; i<=strlen(c.input); i++) {
+			DavLockTimeoutParser uut;
+			uut.reset();
+			uut.parseTimeout(c.input, i);
+			uut.parseTimeout(c.input + i, strlen(c.input)-i);
+			CHECK(uut.getSeconds() == c.result);
+		}
+	}
+}
+
+TEST_GROUP(DavLockReq) {
+	typedef DavLockRequestParser<192> Uut;
+	Uut uut;
+
+	bool parse(const char* input, unsigned int i) {
+		uut.reset();
+		return uut.parseLockRequest(input, i) && uut.parseLockRequest(input + i, strlen(input)-i) && uut.done();
+	}
+};
+
+TEST(DavLockReq, Exclusive) {
+	constexpr const char* input =
+			"<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+			"<D:lockinfo xmlns:D=\"DAV:\">\n"
+			"\t<D:lockscope><D:exclusive/></D:lockscope>\n"
+			"\t<D:locktype><D:write/></D:locktype>\n"
+			"\t<D:owner><D:href>http://example.org/~foo</D:href></D:owner>\n"
+			"</D:lockinfo>";
+
+	for(unsigned int i = 0; i<strlen(input); i++) {
+		CHECK(parse(input, i));
+		CHECK(!uut.isRefresh());
+		CHECK(uut.isExclusiveLock());
+	}
+}
+
+TEST(DavLockReq, Shared) {
+	constexpr const char* input =
+			"<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+			"<lockinfo xmlns=\"DAV:\"><locktype><write/></locktype><lockscope><shared/></lockscope></lockinfo>";
+
+	for(unsigned int i = 0; i<strlen(input); i++) {
+		CHECK(parse(input, i));
+		CHECK(!uut.isRefresh());
+		CHECK(!uut.isExclusiveLock());
+	}
+}
+
+TEST(DavLockReq, Refresh) {
+	uut.reset();
+	CHECK(uut.done());
+	CHECK(uut.isRefresh());
+}
+
+TEST(DavLockReq, Invalid) {
+	constexpr const char* inputs[] = {
+		"<propfind xmlns=\"DAV:\"><allprop/></propfind>",
+		"<lockinfo xmlns=\"DAV:\"><lockscope><exclusive/></lockscope></lockinfo>",
+		"<lockinfo xmlns=\"DAV:\"><locktype><read/></locktype></lockinfo>",
+		"<lockinfo xmlns=\"DAV:\"><lockscope><other/></lockscope><locktype><write/></locktype></lockinfo>",
+		"<lockinfo xmlns=\"DAV:\"><locktype><write/></locktype>",
+	};
+
+	for(const char* input: inputs)
+		CHECK(!parse(input, 0));
+}
@@ -0,0 +1,210 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2017 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#include "1test/Test.h"
+
+#include "DigestCredentials.h"
+
+#include <string>
+#include <stdio.h>
+
+namespace {
+	struct Users {
+		static constexpr DigestCredential credentials[] = {
+			DigestCredential("foo", "ha1-foo"),
+			DigestCredential("foobar", "ha1-foobar"),
+			DigestCredential("bar", "ha1-bar"),
+			DigestCredential("Mufasa", "ha1-Mufasa")
+		};
+	};
+
+	constexpr DigestCredential Users::credentials[];
+
+	struct ManyUsers {
+		static constexpr DigestCredential credentials[] = {
+			DigestCredential("svc-00", "ha1-svc-00"),
+			DigestCredential("svc-01", "ha1-svc-01"),
+			DigestCredential("svc-02", "ha1-svc-02"),
+			DigestCredential("svc-03", "ha1-svc-03"),
+			DigestCredential("svc-04", "ha1-svc-04"),
+			DigestCredential("svc-05", "ha1-svc-05"),
+			DigestCredential("svc-06", "ha1-svc-06"),
+			DigestCredential("svc-07", "ha1-svc-07"),
+			DigestCredential("svc-08", "ha1-svc-08"),
+			DigestCredential("svc-09", "ha1-svc-09"),
+			DigestCredential("svc-10", "ha1-svc-10"),
+			DigestCredential("svc-11", "ha1-svc-11"),
+			DigestCredential("svc-12", "ha1-svc-12"),
+			DigestCredential("svc-13", "ha1-svc-13"),
+			DigestCredential("svc-14", "ha1-svc-14"),
+			DigestCredential("svc-15", "ha1-svc-15"),
+			DigestCredential("svc-16", "ha1-svc-16"),
+			DigestCredential("svc-17", "ha1-svc-17"),
+			DigestCredential("svc-18", "ha1-svc-18"),
+			DigestCredential("svc-19", "ha1-svc-19"),
+			DigestCredential("svc-20", "ha1-svc-20"),
+			DigestCredential("svc-21", "ha1-svc-21"),
+			DigestCredential("svc-22", "ha1-svc-22"),
+			DigestCredential("svc-23", "ha1-svc-23"),
+			DigestCredential("svc-24", "ha1-svc-24"),
+			DigestCredential("svc-25", "ha1-svc-25"),
+			DigestCredential("svc-26", "ha1-svc-26"),
+			DigestCredential("svc-27", "ha1-svc-27"),
+			DigestCredential("svc-28", "ha1-svc-28"),
+			DigestCredential("svc-29", "ha1-svc-29"),
+			DigestCredential("svc-30", "ha1-svc-30"),
+			DigestCredential("svc-31", "ha1-svc-31"),
+			DigestCredential("svc-32", "ha1-svc-32"),
+			DigestCredential("svc-33", "ha1-svc-33"),
+			DigestCredential("svc-34", "ha1-svc-34"),
+			DigestCredential("svc-35", "ha1-svc-35"),
+			DigestCredential("svc-36", "ha1-svc-36"),
+			DigestCredential("svc-37", "ha1-svc-37"),
+			DigestCredential("svc-38", "ha1-svc-38"),
+			DigestCredential("svc-39", "ha1-svc-39"),
+			DigestCredential("svc-40", "ha1-svc-40"),
+			DigestCredential("svc-41", "ha1-svc-41"),
+			DigestCredential("svc-42", "ha1-svc-42"),
+			DigestCredential("svc-43", "ha1-svc-43"),
+			DigestCredential("svc-44", "ha1-svc-44"),
+			DigestCredential("svc-45", "ha1-svc-45"),
+			DigestCredential("svc-46", "ha1-svc-46"),
+			DigestCredential("svc-47", "ha1-svc-47"),
+			DigestCredential("svc-48", "ha1-svc-48"),
+			DigestCredential("svc-49", "ha1-svc-49"),
+			DigestCredential("svc-50", "ha1-svc-50"),
+			DigestCredential("svc-51", "ha1-svc-51"),
+			DigestCredential("svc-52", "ha1-svc-52"),
+			DigestCredential("svc-53", "ha1-svc-53"),
+			DigestCredential("svc-54", "ha1-svc-54"),
+			DigestCredential("svc-55", "ha1-svc-55"),
+			DigestCredential("svc-56", "ha1-svc-56"),
+			DigestCredential("svc-57", "ha1-svc-57"),
+			DigestCredential("svc-58", "ha1-svc-58"),
+			DigestCredential("svc-59", "ha1-svc-59"),
+			DigestCredential("svc-60", "ha1-svc-60"),
+			DigestCredential("svc-61", "ha1-svc-61"),
+			DigestCredential("svc-62", "ha1-svc-62"),
+			DigestCredential("svc-63", "ha1-svc-63")
+		};
+	};
+
+	constexpr DigestCredential ManyUsers::credentials[];
+
+	struct Sorted {
+		static DigestCredential table[4];
+		static uint32_t count;
+
+		static const DigestCredential* credentials(uint32_t &count) {
+			count = Sorted::count;
+			return table;
+		}
+	};
+
+	DigestCredential Sorted::table[4] = {
+		DigestCredential("Mufasa", "ha1-Mufasa"),
+		DigestCredential("bar", "ha1-bar"),
+		DigestCredential("foo", "ha1-foo"),
+		DigestCredential("foobar", "ha1-foobar")
+	};
+
+	uint32_t Sorted::count = 4;
+}
+
+TEST_GROUP(DigestCredentials) {
+	template<class Matcher>
+	static std::string lookup(const char* name, uint32_t split) {
+		Matcher matcher;
+		matcher.reset();
+		matcher.progress(name, split);
+		matcher.progress(name + split, strlen(name) - split);
+		matcher.done();
+
+		const char* ha1 = matcher.ha1();
+
+		if(!ha1)
+			return "";
+
+		if(strcmp(matcher.username(), name) != 0)
+			return "wrong name";
+
+		return ha1;
+	}
+
+	template<class Store>
+	static bool check() {
+		static const char* names[] = {"foo", "foobar", "bar", "Mufasa"};
+
+		for(const char* name: names)
+			for(uint32_t i = 0; i <= strlen(name); i++)
+				if(lookup<typename Store::Matcher>(name, i) != std::string("ha1-") + name)
+					return false;
+
+		static const char* unknown[] = {"", "fo", "fooba", "foobarbaz", "baz", "mufasa", "Mufasa "};
+
+		for(const char* name: unknown)
+			for(uint32_t i = 0; i <= strlen(name); i++)
+				if(lookup<typename Store::Matcher>(name, i) != "")
+					return false;
+
+		return true;
+	}
+};
+
+TEST(DigestCredentials, Static) {
+	CHECK(check<StaticCredentials<Users> >());
+}
+
+TEST(DigestCredentials, StaticMany) {
+	char name[16];
+
+	for(int i = 0; i < 64; i++) {
+		sprintf(name, "svc-%02d", i);
+		CHECK(lookup<StaticCredentials<ManyUsers>::Matcher>(name, 2) == std::string("ha1-") + name);
+	}
+
+	CHECK(lookup<StaticCredentials<ManyUsers>::Matcher>("svc-64", 2) == "");
+	CHECK(StaticCredentials<ManyUsers>::Build::slots < 2 * 64);
+}
+
+TEST(DigestCredentials, Sorted) {
+	CHECK(check<SortedCredentials<Sorted> >());
+}
+
+TEST(DigestCredentials, SortedChanged) {
+	Sorted::count = 2;
+	CHECK(lookup<SortedCredentials<Sorted>::Matcher>("bar", 1) == "ha1-bar");
+	CHECK(lookup<SortedCredentials<Sorted>::Matcher>("foo", 1) == "");
+	Sorted::count = 4;
+	CHECK(lookup<SortedCredentials<Sorted>::Matcher>("foo", 1) == "ha1-foo");
+}
+
+TEST(DigestCredentials, Embedded) {
+	SortedCredentials<Sorted>::Matcher sorted;
+	sorted.reset();
+	sorted.progress("foo\0bar", 7);
+	sorted.done();
+	CHECK(!sorted.ha1());
+
+	StaticCredentials<Users>::Matcher table;
+	table.reset();
+	table.progress("foo\0bar", 7);
+	table.done();
+	CHECK(!table.ha1());
+}
@@ -0,0 +1,248 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2017 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#include "1test/Test.h"
+
+#include "HttpLogic.h"
+
+#include <string>
+
+namespace {
+	static constexpr const char authUser[] = "foo";
+	static constexpr const char authRealm[] = "bar";
+	static constexpr const char authA1[] = "d65f52b42a2605dd84ef29a88bd75e1d";
+	static constexpr const char nonceKey[] = "secret";
+	static constexpr const char authPassword[] = "baz";
+
+	std::string md5Hex(const std::string& in) {
+		static const char hex[] = "0123456789abcdef";
+		unsigned char temp[16];
+		std::string ret;
+		MD5_CTX ctx;
+		MD5_Init(&ctx);
+		MD5_Update(&ctx, in.data(), in.length());
+		MD5_Final(temp, &ctx);
+
+		for(unsigned char c: temp)
+			ret += std::string(1, hex[c >> 4]) + hex[c & 0xf];
+
+		return ret;
+	}
+
+	template<class... Options>
+	struct AuthUut: public HttpLogic<AuthUut<Options...>,
+		HttpConfig::AuthUser<authUser>,
+		HttpConfig::AuthRealm<authRealm>,
+		HttpConfig::AuthPasswdHash<authA1>,
+		HttpConfig::AuthNonceKey<nonceKey>,
+		HttpConfig::AuthNonceLifetime<60>,
+		HttpConfig::DavStackSize<192>,
+		Options...
+	> {
+		std::string response;
+		const char* user = nullptr;
+		uint32_t now = 1000;
+
+		void send(const char* str, unsigned int length) {
+			response += std::string(str, length);
+		}
+
+		void flush() {}
+
+		DavAccess sourceAccessible(bool authenticated) {
+			user = this->getAuthUser();
+			return DavAccess::AuthNeeded;
+		}
+
+		void resetSourceLocator() {}
+		void resetDestinationLocator() {}
+		HttpStatus enterSource(const char* str, unsigned int length) {return HTTP_STATUS_OK;}
+		HttpStatus enterDestination(const char* str, unsigned int length) {return HTTP_STATUS_OK;}
+
+		HttpStatus arrangeSendFrom(uint32_t &size) {
+			size = 0;
+			return HTTP_STATUS_OK;
+		}
+
+		HttpStatus readContent() { return HTTP_STATUS_OK; }
+		HttpStatus contentRead() { return HTTP_STATUS_OK; }
+
+		uint32_t currentTime() { return now; }
+
+		std::string process(const std::string& input) {
+			response.clear();
+			this->reset();
+			this->parse(input.data(), input.length());
+			this->done();
+			return response.substr(0, response.find("\r\n"));
+		}
+
+		std::string challenge() {
+			constexpr const char* header = "WWW-Authenticate: ";
+			size_t start = response.find(header);
+
+			if(start == std::string::npos)
+				return "";
+
+			start += strlen(header);
+			return response.substr(start, response.find("\r\n", start) - start);
+		}
+	};
+}
+
+TEST_GROUP(HttpLogicAuth) {
+	AuthUut<> uut;
+
+	std::string get(const std::string& nonce) {
+		const std::string response = md5Hex(std::string(authA1) + ":" + nonce + ":" + md5Hex("GET:/foo"));
+		return uut.process("GET /foo HTTP/1.1\r\n"
+				"Authorization: Digest username=\"foo\", realm=\"bar\", nonce=\"" + nonce + "\", "
+				"uri=\"/foo\", response=\"" + response + "\"\r\n\r\n");
+	}
+
+	std::string getQop(const std::string& nonce, const char* nc) {
+		const std::string response = md5Hex(std::string(authA1) + ":" + nonce + ":" + nc + ":abcd:auth:" + md5Hex("GET:/foo"));
+		return uut.process("GET /foo HTTP/1.1\r\n"
+				"Authorization: Digest username=\"foo\", realm=\"bar\", nonce=\"" + nonce + "\", "
+				"uri=\"/foo\", qop=auth, nc=" + nc + ", cnonce=\"abcd\", response=\"" + response + "\"\r\n\r\n");
+	}
+
+	std::string nonce() {
+		const std::string challenge = uut.challenge();
+		const size_t start = challenge.find("nonce=\"") + strlen("nonce=\"");
+		return challenge.substr(start, challenge.find('"', start) - start);
+	}
+};
+
+TEST(HttpLogicAuth, Challenge)
+{
+	CHECK(uut.process("GET /foo HTTP/1.1\r\n\r\n") == "HTTP/1.1 401 Unauthorized");
+	CHECK(uut.challenge().find("Digest realm=\"bar\", nonce=\"") == 0);
+	CHECK(uut.challenge().find("qop=\"auth\"") != std::string::npos);
+	CHECK(uut.challenge().find("algorithm=MD5") != std::string::npos);
+	CHECK(uut.challenge().find("stale") == std::string::npos);
+	CHECK(nonce().length() == DigestNonce::length);
+}
+
+TEST(HttpLogicAuth, Authorized)
+{
+	uut.process("GET /foo HTTP/1.1\r\n\r\n");
+	const std::string nonce = this->nonce();
+
+	uut.now += 60;
+	CHECK(get(nonce) == "HTTP/1.1 200 OK");
+	CHECK(uut.challenge() == "");
+	CHECK(uut.user && strcmp(uut.user, "foo") == 0);
+}
+
+TEST(HttpLogicAuth, Stale)
+{
+	uut.process("GET /foo HTTP/1.1\r\n\r\n");
+	const std::string nonce = this->nonce();
+
+	uut.now += 61;
+	CHECK(get(nonce) == "HTTP/1.1 401 Unauthorized");
+	CHECK(uut.challenge().find("stale=true") != std::string::npos);
+	CHECK(this->nonce() != nonce);
+}
+
+TEST(HttpLogicAuth, Forged)
+{
+	CHECK(get("000003e8000000000000000000000000") == "HTTP/1.1 403 Forbidden");
+}
+
+TEST(HttpLogicAuth, NonceCount)
+{
+	uut.process("GET /foo HTTP/1.1\r\n\r\n");
+	const std::string nonce = this->nonce();
+
+	CHECK(getQop(nonce, "00000001") == "HTTP/1.1 200 OK");
+	CHECK(getQop(nonce, "00000002") == "HTTP/1.1 200 OK");
+	CHECK(getQop(nonce, "00000002") == "HTTP/1.1 401 Unauthorized");
+	CHECK(uut.challenge().find("stale=true") != std::string::npos);
+	CHECK(getQop(nonce, "0000000a") == "HTTP/1.1 200 OK");
+}
+
+TEST(HttpLogicAuth, TwoClients)
+{
+	uut.process("GET /foo HTTP/1.1\r\n\r\n");
+	const std::string first = this->nonce();
+	uut.process("GET /foo HTTP/1.1\r\n\r\n");
+	const std::string second = this->nonce();
+	CHECK(first != second);
+
+	CHECK(getQop(first, "00000001") == "HTTP/1.1 200 OK");
+	CHECK(getQop(second, "00000001") == "HTTP/1.1 200 OK");
+	CHECK(getQop(second, "00000002") == "HTTP/1.1 200 OK");
+	CHECK(getQop(first, "00000002") == "HTTP/1.1 200 OK");
+	CHECK(getQop(first, "00000002") == "HTTP/1.1 401 Unauthorized");
+}
+
+TEST_GROUP(HttpLogicBasicAuth) {
+	AuthUut<HttpConfig::AuthPassword<authPassword>, HttpConfig::AuthSchemes<AuthScheme::Basic> > uut;
+};
+
+TEST(HttpLogicBasicAuth, Challenge)
+{
+	CHECK(uut.process("GET /foo HTTP/1.1\r\n\r\n") == "HTTP/1.1 401 Unauthorized");
+	CHECK(uut.challenge() == "Basic realm=\"bar\", charset=\"UTF-8\"");
+}
+
+TEST(HttpLogicBasicAuth, Authorized)
+{
+	CHECK(uut.process("GET /foo HTTP/1.1\r\nAuthorization: Basic Zm9vOmJheg==\r\n\r\n") == "HTTP/1.1 200 OK");
+	CHECK(uut.challenge() == "");
+	CHECK(uut.user && strcmp(uut.user, "foo") == 0);
+}
+
+TEST(HttpLogicBasicAuth, WrongPassword)
+{
+	CHECK(uut.process("GET /foo HTTP/1.1\r\nAuthorization: Basic Zm9vOnF1eA==\r\n\r\n") == "HTTP/1.1 403 Forbidden");
+	CHECK(uut.challenge() == "");
+}
+
+TEST_GROUP(HttpLogicEitherAuth) {
+	AuthUut<HttpConfig::AuthPassword<authPassword>, HttpConfig::AuthSchemes<AuthScheme::Both> > uut;
+};
+
+TEST(HttpLogicEitherAuth, Challenge)
+{
+	CHECK(uut.process("GET /foo HTTP/1.1\r\n\r\n") == "HTTP/1.1 401 Unauthorized");
+	CHECK(uut.response.find("WWW-Authenticate: Digest realm=\"bar\", nonce=\"") != std::string::npos);
+	CHECK(uut.response.find("WWW-Authenticate: Basic realm=\"bar\", charset=\"UTF-8\"") != std::string::npos);
+}
+
+TEST(HttpLogicEitherAuth, Basic)
+{
+	CHECK(uut.process("GET /foo HTTP/1.1\r\nAuthorization: Basic Zm9vOmJheg==\r\n\r\n") == "HTTP/1.1 200 OK");
+	CHECK(uut.user && strcmp(uut.user, "foo") == 0);
+}
+
+TEST(HttpLogicEitherAuth, Digest)
+{
+	uut.process("GET /foo HTTP/1.1\r\n\r\n");
+	const std::string challenge = uut.challenge();
+	const size_t start = challenge.find("nonce=\"") + strlen("nonce=\"");
+	const std::string nonce = challenge.substr(start, challenge.find('"', start) - start);
+	const std::string response = md5Hex(std::string(authA1) + ":" + nonce + ":" + md5Hex("GET:/foo"));
+
+	CHECK(uut.process("GET /foo HTTP/1.1\r\n"
+			"Authorization: Digest username=\"foo\", realm=\"bar\", nonce=\"" + nonce + "\", "
+			"uri=\"/foo\", response=\"" + response + "\"\r\n\r\n") == "HTTP/1.1 200 OK");
+}
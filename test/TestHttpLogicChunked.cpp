@@ -0,0 +1,157 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2017 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#include "1test/Test.h"
+
+#include "HttpLogic.h"
+
+#include <string>
+
+TEST_GROUP(HttpLogicChunked) {
+
+	template<uint32_t bufferSize>
+	struct Uut: public HttpLogic<Uut<bufferSize>,
+		HttpConfig::BodyBufferSize<bufferSize>
+	> {
+		std::string content, writes;
+		unsigned int failAt = 0;
+		bool written = false;
+
+		void send(const char* str, unsigned int length) {}
+		void flush() {}
+
+		HttpStatus writeContent(const char* buff, uint32_t length) {
+			content += std::string(buff, length);
+			writes += std::to_string(length) + ",";
+
+			if(failAt && !--failAt)
+				return HTTP_STATUS_INSUFFICIENT_STORAGE;
+
+			return HTTP_STATUS_OK;
+		}
+
+		HttpStatus contentWritten() {
+			written = true;
+			return HTTP_STATUS_OK;
+		}
+	};
+
+	static constexpr const char* request =
+			"PUT /foo HTTP/1.1\r\n"
+			"Transfer-Encoding: chunked\r\n\r\n"
+			"3\r\nabc\r\n"
+			"5\r\ndefgh\r\n"
+			"1\r\ni\r\n"
+			"7\r\njklmnop\r\n"
+			"28\r\n0123456789012345678901234567890123456789\r\n"
+			"2\r\nqr\r\n"
+			"4\r\nstuv\r\n"
+			"0\r\n\r\n";
+
+	static constexpr const char* trailed =
+			"PUT /foo HTTP/1.1\r\n"
+			"Transfer-Encoding: chunked\r\n\r\n"
+			"3\r\nabc\r\n"
+			"5\r\ndefgh\r\n"
+			"1\r\ni\r\n"
+			"7\r\njklmnop\r\n"
+			"28\r\n0123456789012345678901234567890123456789\r\n"
+			"2\r\nqr\r\n"
+			"4\r\nstuv\r\n"
+			"0\r\n"
+			"X-Checksum: 0123456789abcdef\r\n"
+			"Content-Type: text/plain\r\n\r\n";
+
+	static constexpr const char* content =
+			"abcdefghijklmnop0123456789012345678901234567890123456789qrstuv";
+
+	template<class Uut>
+	static void parse(Uut& uut, unsigned int segment, const char* input = request) {
+		uut.reset();
+
+		for(unsigned int i = 0; i < strlen(input); i += segment)
+			uut.parse(input + i, (strlen(input) - i < segment) ? strlen(input) - i : segment);
+
+		uut.done();
+	}
+};
+
+TEST(HttpLogicChunked, Unbuffered)
+{
+	Uut<0> uut;
+	parse(uut, strlen(request));
+
+	CHECK(uut.getStatus() == HTTP_STATUS_OK);
+	CHECK(uut.written);
+	CHECK(uut.content == content);
+	CHECK(uut.writes == "3,5,1,7,40,2,4,");
+}
+
+TEST(HttpLogicChunked, Batched)
+{
+	Uut<16> uut;
+	parse(uut, strlen(request));
+
+	CHECK(uut.getStatus() == HTTP_STATUS_OK);
+	CHECK(uut.written);
+	CHECK(uut.content == content);
+	CHECK(uut.writes == "16,40,6,");
+}
+
+TEST(HttpLogicChunked, Fragmented)
+{
+	for(unsigned int segment = 1; segment < strlen(request); segment++) {
+		Uut<16> uut;
+		parse(uut, segment);
+
+		CHECK(uut.getStatus() == HTTP_STATUS_OK);
+		CHECK(uut.written);
+		CHECK(uut.content == content);
+
+		if(segment == 1)
+			CHECK(uut.writes == "16,16,16,14,");
+	}
+}
+
+TEST(HttpLogicChunked, WriteError)
+{
+	for(unsigned int failAt = 1; failAt <= 3; failAt++) {
+		Uut<16> uut;
+		uut.failAt = failAt;
+		parse(uut, strlen(request));
+
+		CHECK(!uut.written);
+		CHECK(uut.content == std::string(content).substr(0, uut.content.length()));
+	}
+}
+
+TEST(HttpLogicChunked, Trailer)
+{
+	for(unsigned int segment = 1; segment <= strlen(trailed); segment++) {
+		Uut<16> uut;
+		parse(uut, segment, trailed);
+
+		CHECK(uut.getStatus() == HTTP_STATUS_OK);
+		CHECK(uut.written);
+		CHECK(uut.content == content);
+
+		if(segment == strlen(trailed))
+			CHECK(uut.writes == "16,40,6,");
+	}
+}
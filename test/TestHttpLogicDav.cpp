@@ -123,9 +123,9 @@ TEST(HttpLogicDav, PropfindFile)
 		"Authorization: Digest"
 		" username=\"foo\",\r\n"
 		" realm=\"bar\",\r\n"
-		" nonce=\"justonce\",\r\n"
+		" nonce=\"0000000000000000d1d8075129755a4e\",\r\n"
 		" uri=\"/\",\r\n"
-		" response=\"9edbbf5afdd2e426298f7be121e652ad\",\r\n"
+		" response=\"be4b1e3ec28bfe60cabb22e0d6a6df71\",\r\n"
 		" algorithm=\"MD5\"\r\n"
 		"\r\n"
 		"<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
@@ -0,0 +1,157 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2017 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#include "1test/Test.h"
+
+#include "HttpLogic.h"
+
+#include <string>
+#include <string.h>
+
+namespace {
+	struct DigestUut: public HttpLogic<DigestUut, HttpConfig::ContentMd5<true>> {
+		std::string response, target, temp, content;
+		unsigned int finalized = 0, discarded = 0;
+
+		void send(const char* str, unsigned int length) {
+			response += std::string(str, length);
+		}
+
+		void flush() {}
+
+		HttpStatus arrangeReceiveInto(const char* dstName, uint32_t length) {
+			target = std::string(dstName, length);
+			temp.clear();
+			return HTTP_STATUS_OK;
+		}
+
+		HttpStatus writeContent(const char* buff, uint32_t length) {
+			temp += std::string(buff, length);
+			return HTTP_STATUS_OK;
+		}
+
+		HttpStatus contentWritten() {
+			content = temp;
+			finalized++;
+			return HTTP_STATUS_OK;
+		}
+
+		void contentDiscarded() {
+			temp.clear();
+			discarded++;
+		}
+
+		/*
+		 * Feeds the request split at the given position,
+		 * returns the status line of the response.
+		 */
+		std::string process(const char* request, unsigned int split) {
+			response.clear();
+			target.clear();
+			content.clear();
+			finalized = discarded = 0;
+
+			reset();
+			parse(request, split);
+			parse(request + split, strlen(request) - split);
+			done();
+			return response.substr(0, response.find("\r\n"));
+		}
+	};
+}
+
+TEST_GROUP(HttpLogicDigest) {
+	DigestUut uut;
+};
+
+TEST(HttpLogicDigest, PutContentMd5)
+{
+	static constexpr const char* testRequest =
+			"PUT /foo/bar HTTP/1.1\r\n"
+			"Content-MD5: 9rS9/JQi8+2BQb++dXZzrA==\r\n"
+			"Content-Length:8\r\n\r\n"
+			"BodyTest\r\n";
+
+	for(unsigned int i=0; i<strlen(testRequest); i++) {
+		CHECK(uut.process(testRequest, i) == "HTTP/1.1 200 OK");
+		CHECK(uut.target == "bar");
+		CHECK(uut.finalized == 1);
+		CHECK(uut.discarded == 0);
+		CHECK(uut.content == "BodyTest");
+	}
+}
+
+TEST(HttpLogicDigest, PutDigest)
+{
+	static constexpr const char* testRequest =
+			"PUT /foo/bar HTTP/1.1\r\n"
+			"Digest: SHA=zrBrpr0jEi4JzgwXlb6HlqIOVqE=, MD5=9rS9/JQi8+2BQb++dXZzrA==\r\n"
+			"Transfer-Encoding: chunked\r\n\r\n"
+			"4\r\nBody\r\n"
+			"4\r\nTest\r\n"
+			"0\r\n\r\n";
+
+	for(unsigned int i=0; i<strlen(testRequest); i++) {
+		CHECK(uut.process(testRequest, i) == "HTTP/1.1 200 OK");
+		CHECK(uut.finalized == 1);
+		CHECK(uut.discarded == 0);
+		CHECK(uut.content == "BodyTest");
+	}
+}
+
+TEST(HttpLogicDigest, PutCorrupted)
+{
+	static constexpr const char* testRequest =
+			"PUT /foo/bar HTTP/1.1\r\n"
+			"Content-MD5: 9rS9/JQi8+2BQb++dXZzrA==\r\n"
+			"Content-Length:8\r\n\r\n"
+			"BodyTesT";
+
+	for(unsigned int i=0; i<strlen(testRequest); i++) {
+		CHECK(uut.process(testRequest, i) == "HTTP/1.1 400 Bad Request");
+		CHECK(uut.temp == "");
+		CHECK(uut.finalized == 0);
+		CHECK(uut.discarded == 1);
+		CHECK(uut.content == "");
+	}
+}
+
+TEST(HttpLogicDigest, PutMalformedDigest)
+{
+	static constexpr const char* testRequest =
+			"PUT /foo/bar HTTP/1.1\r\n"
+			"Digest: MD5=9rS9/JQi8+2BQb++dXZz\r\n"
+			"Content-Length:8\r\n\r\n"
+			"BodyTest";
+
+	for(unsigned int i=0; i<strlen(testRequest); i++) {
+		CHECK(uut.process(testRequest, i) == "HTTP/1.1 400 Bad Request");
+		CHECK(uut.target == "");
+		CHECK(uut.finalized == 0);
+	}
+}
+
+TEST(HttpLogicDigest, MemoryReport)
+{
+	typedef DigestUut::MemoryReport Report;
+
+	CHECK(Report::contentDigest() > sizeof(MD5_CTX) + 16);
+	CHECK(Report::session() > Report::pathElement() + Report::contentDigest());
+	CHECK(Report::session() <= sizeof(DigestUut));
+}
@@ -40,9 +40,9 @@ TEST(HttpLogicErrors, PutWrongAuth)
 			"Authorization: Digest\r\n"
 			" username=\"BADGUY\",\r\n"
 			" realm=\"bar\",\r\n"
-			" nonce=\"justonce\",\r\n"
+			" nonce=\"0000000000000000d1d8075129755a4e\",\r\n"
 			" uri=\"/index.html\",\r\n"
-			" response=\"3f698a1237eeb963bb25fed3febf42de\",\r\n"
+			" response=\"0cab82f62b09d13e1e852db661c78a4b\",\r\n"
 			" algorithm=\"MD5\"\r\n"
 			"Content-Length:8\r\n\r\n"
 			"BodyTest";
@@ -63,6 +63,75 @@ TEST(HttpLogicErrors, PutWrongAuth)
 	}
 }
 
+TEST(HttpLogicErrors, GetEscapedSlash)
+{
+	static constexpr const char* testRequest =
+			"GET /foo%2F..%2Fbar HTTP/1.1\r\n"
+			"Host: localhost\r\n\r\n";
+
+	for(unsigned int i=0; i<strlen(testRequest) - 1; i++) {
+		MOCK(ResourceLocator)::EXPECT(reset);
+		MOCK(ResourceLocator)::EXPECT(enter).withStringParam("foo..bar");
+
+		uut.reset();
+		uut.parse(testRequest, i);
+		uut.parse(testRequest + i, strlen(testRequest) - i - 1);
+
+		CHECK(uut.getStatus() == HTTP_STATUS_BAD_REQUEST);
+
+		uut.parse(testRequest + strlen(testRequest) - 1, 1);
+		uut.done();
+		CHECK(!MockedHttpLogic::workerCalled);
+	}
+}
+
+TEST(HttpLogicErrors, GetLongElement)
+{
+	static constexpr const char* testRequest =
+			"GET /foo/0123456789abcdef0123456789abcdefX/bar HTTP/1.1\r\n"
+			"Host: localhost\r\n\r\n";
+
+	for(unsigned int i=0; i<strlen(testRequest) - 1; i++) {
+		MOCK(ResourceLocator)::EXPECT(reset);
+		MOCK(ResourceLocator)::EXPECT(enter).withStringParam("foo");
+
+		uut.reset();
+		uut.parse(testRequest, i);
+		uut.parse(testRequest + i, strlen(testRequest) - i - 1);
+
+		CHECK(uut.getStatus() == HTTP_STATUS_URI_TOO_LONG);
+
+		uut.parse(testRequest + strlen(testRequest) - 1, 1);
+		uut.done();
+		CHECK(!MockedHttpLogic::workerCalled);
+	}
+}
+
+TEST(HttpLogicErrors, MoveLongDestination)
+{
+	static constexpr const char* testRequest =
+			"MOVE /foo/bar HTTP/1.1\r\n"
+			"Destination: http://127.0.0.1/foo/0123456789abcdef0123456789abcdefX\r\n"
+			"Host: localhost\r\n\r\n";
+
+	for(unsigned int i=0; i<strlen(testRequest) - 1; i++) {
+		MOCK(ResourceLocator)::EXPECT(reset);
+		MOCK(ResourceLocator)::EXPECT(enter).withStringParam("foo");
+		MOCK(ResourceLocator)::EXPECT(enter).withStringParam("bar");
+		MOCK(ResourceLocator)::EXPECT(reset);
+		MOCK(ResourceLocator)::EXPECT(enter).withStringParam("foo");
+
+		uut.reset();
+		uut.parse(testRequest, i);
+		uut.parse(testRequest + i, strlen(testRequest) - i - 1);
+
+		CHECK(uut.getStatus() == HTTP_STATUS_BAD_REQUEST);
+
+		uut.parse(testRequest + strlen(testRequest) - 1, 1);
+		uut.done();
+	}
+}
+
 TEST(HttpLogicErrors, PutBadReq)
 {
 	static constexpr const char* testRequest =
@@ -70,9 +139,9 @@ TEST(HttpLogicErrors, PutBadReq)
 			"Authorization: Digest\r\n"
 			" username=\"foo\",\r\n"
 			" realm=\"bar\",\r\n"
-			" nonce=\"justonce\",\r\n"
+			" nonce=\"0000000000000000d1d8075129755a4e\",\r\n"
 			" uri=\"/index.html\",\r\n"
-			" response=\"3f698a1237eeb963bb25fed3febf42de\",\r\n"
+			" response=\"0cab82f62b09d13e1e852db661c78a4b\",\r\n"
 			"Content-Length:8\r\n\r\n"
 			"BodyTest";
 
@@ -96,9 +165,9 @@ TEST(HttpLogicErrors, PutTrunactedReq)
 			"Authorization: Digest\r\n"
 			" username=\"foo\",\r\n"
 			" realm=\"bar\",\r\n"
-			" nonce=\"justonce\",\r\n"
+			" nonce=\"0000000000000000d1d8075129755a4e\",\r\n"
 			" uri=\"/index.html\",\r\n"
-			" response=\"3f698a1237eeb963bb25fed3febf42de\",\r\n"
+			" response=\"0cab82f62b09d13e1e852db661c78a4b\",\r\n"
 			"Content-Length:8\r\n\r\n"
 			"Body";
 
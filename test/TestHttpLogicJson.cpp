@@ -0,0 +1,234 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2017 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#include "1test/Test.h"
+
+#include "HttpLogic.h"
+
+#include <string>
+
+namespace {
+	template<class... Options>
+	struct JsonUut: public HttpLogic<JsonUut<Options...>, Options...> {
+		std::string response, written, target;
+		int interval = 0;
+		bool enabled = false;
+		unsigned int finalized = 0;
+
+		NumberExtractor intervalExtractor{interval};
+		BoolExtractor enabledExtractor{enabled};
+		ObjectFilter<2> filter{FilterEntry("interval", &intervalExtractor), FilterEntry("enabled", &enabledExtractor)};
+
+		void send(const char* str, unsigned int length) {
+			response += std::string(str, length);
+		}
+
+		void flush() {}
+
+		DavAccess sourceAccessible(bool authenticated) { return DavAccess::NoDav; }
+		void resetSourceLocator() {}
+		void resetDestinationLocator() { target.clear(); }
+		HttpStatus enterSource(const char* str, unsigned int length) {return HTTP_STATUS_OK;}
+		HttpStatus enterDestination(const char* str, unsigned int length) {return HTTP_STATUS_OK;}
+
+		HttpStatus arrangeReceiveInto(const char* dstName, uint32_t length) {
+			target = std::string(dstName, length);
+			return HTTP_STATUS_OK;
+		}
+
+		HttpStatus arrangeJsonReceive(const char* dstName, uint32_t length, EntityFilter* &filter) {
+			target = std::string(dstName, length);
+
+			if(target != "settings")
+				return HTTP_STATUS_NOT_FOUND;
+
+			filter = &this->filter;
+			return HTTP_STATUS_OK;
+		}
+
+		HttpStatus writeContent(const char* buff, uint32_t length) {
+			written += std::string(buff, length);
+			return HTTP_STATUS_OK;
+		}
+
+		HttpStatus contentWritten() {
+			finalized++;
+			return HTTP_STATUS_NO_CONTENT;
+		}
+
+		std::string process(const std::string& input, size_t step = 0) {
+			response.clear();
+			written.clear();
+			interval = 0;
+			enabled = false;
+			finalized = 0;
+
+			if(!step)
+				step = input.length();
+
+			this->reset();
+			for(size_t i = 0; i < input.length(); i += step)
+				this->parse(input.data() + i, std::min(step, input.length() - i));
+
+			this->done();
+			return response.substr(0, response.find("\r\n"));
+		}
+	};
+
+	std::string post(const char* contentType, const std::string& body) {
+		return std::string("POST /settings HTTP/1.1\r\n"
+				"Content-Type: ") + contentType + "\r\n"
+				"Content-Length: " + std::to_string(body.length()) + "\r\n\r\n" + body;
+	}
+}
+
+TEST_GROUP(HttpLogicJson) {
+	JsonUut<HttpConfig::JsonBodyDepth<4>, HttpConfig::BodyBufferSize<64>> uut;
+};
+
+TEST(HttpLogicJson, Parsed)
+{
+	const std::string request = post("application/json", "{\"enabled\": true, \"name\": \"x\", \"interval\": 60}");
+
+	for(size_t step = 1; step <= request.length(); step++) {
+		CHECK(uut.process(request, step) == "HTTP/1.1 204 No Content");
+		CHECK(uut.interval == 60);
+		CHECK(uut.enabled);
+		CHECK(uut.finalized == 1);
+		CHECK(uut.written.empty());
+	}
+}
+
+TEST(HttpLogicJson, Parameters)
+{
+	CHECK(uut.process(post("application/json; charset=utf-8", "{\"interval\": 5}")) == "HTTP/1.1 204 No Content");
+	CHECK(uut.interval == 5);
+
+	CHECK(uut.process(post("application/json ;charset=utf-8", "{\"interval\": 6}")) == "HTTP/1.1 204 No Content");
+	CHECK(uut.interval == 6);
+}
+
+TEST(HttpLogicJson, TypeCase)
+{
+	CHECK(uut.process(post("Application/JSON", "{\"interval\": 7}")) == "HTTP/1.1 204 No Content");
+	CHECK(uut.interval == 7);
+	CHECK(uut.written.empty());
+
+	CHECK(uut.process(post("APPLICATION/JSON; charset=UTF-8", "{\"interval\": 8}")) == "HTTP/1.1 204 No Content");
+	CHECK(uut.interval == 8);
+	CHECK(uut.written.empty());
+}
+
+TEST(HttpLogicJson, OtherTypes)
+{
+	CHECK(uut.process(post("text/plain", "{\"interval\": 5}")) == "HTTP/1.1 204 No Content");
+	CHECK(uut.interval == 0);
+	CHECK(uut.written == "{\"interval\": 5}");
+
+	CHECK(uut.process(post("application/jsonx", "{}")) == "HTTP/1.1 204 No Content");
+	CHECK(uut.written == "{}");
+
+	CHECK(uut.process(post("application/js", "{}")) == "HTTP/1.1 204 No Content");
+	CHECK(uut.written == "{}");
+}
+
+TEST(HttpLogicJson, NotPost)
+{
+	CHECK(uut.process("PUT /settings HTTP/1.1\r\nContent-Type: application/json\r\nContent-Length: 2\r\n\r\n{}") == "HTTP/1.1 204 No Content");
+	CHECK(uut.written == "{}");
+}
+
+TEST(HttpLogicJson, Malformed)
+{
+	CHECK(uut.process(post("application/json", "{\"interval\": 5,,}")) == "HTTP/1.1 400 Bad Request");
+	CHECK(uut.finalized == 0);
+
+	CHECK(uut.process(post("application/json", "{\"interval\": 5")) == "HTTP/1.1 400 Bad Request");
+	CHECK(uut.finalized == 0);
+
+	CHECK(uut.process(post("application/json", "")) == "HTTP/1.1 400 Bad Request");
+	CHECK(uut.finalized == 0);
+
+	CHECK(uut.process(post("application/json", "[[[[[1]]]]]")) == "HTTP/1.1 400 Bad Request");
+	CHECK(uut.finalized == 0);
+}
+
+TEST(HttpLogicJson, Rejected)
+{
+	CHECK(uut.process("POST /other HTTP/1.1\r\nContent-Type: application/json\r\nContent-Length: 2\r\n\r\n{}") == "HTTP/1.1 404 Not Found");
+	CHECK(uut.target == "other");
+	CHECK(uut.finalized == 0);
+}
+
+TEST(HttpLogicJson, Chunked)
+{
+	CHECK(uut.process("POST /settings HTTP/1.1\r\nContent-Type: application/json\r\nTransfer-Encoding: chunked\r\n\r\n"
+			"5\r\n{\"int\r\n"
+			"9\r\nerval\": 7\r\n"
+			"1\r\n}\r\n"
+			"0\r\n\r\n") == "HTTP/1.1 204 No Content");
+	CHECK(uut.interval == 7);
+}
+
+TEST(HttpLogicJson, Trailer)
+{
+	const std::string request = "POST /settings HTTP/1.1\r\nContent-Type: application/json\r\nTransfer-Encoding: chunked\r\n\r\n"
+			"10\r\n{\"interval\": 42}\r\n"
+			"0\r\n"
+			"X-Some-Rather-Long-Trailer-Field-Name: with-a-value-that-is-long-enough\r\n"
+			"Content-Type: text/plain\r\n\r\n";
+
+	for(size_t step = 1; step <= request.length(); step++) {
+		CHECK(uut.process(request, step) == "HTTP/1.1 204 No Content");
+		CHECK(uut.interval == 42);
+		CHECK(uut.finalized == 1);
+		CHECK(uut.written.empty());
+	}
+
+	CHECK(uut.process("POST /settings HTTP/1.1\r\nContent-Type: application/json\r\nTransfer-Encoding: chunked\r\n\r\n"
+			"f\r\n{\"interval\": 42\r\n"
+			"0\r\n"
+			"Content-Type: text/plain\r\n\r\n") == "HTTP/1.1 400 Bad Request");
+	CHECK(uut.finalized == 0);
+}
+
+TEST(HttpLogicJson, Disabled)
+{
+	JsonUut<> plain;
+	CHECK(plain.process(post("application/json", "{\"interval\": 5}")) == "HTTP/1.1 204 No Content");
+	CHECK(plain.interval == 0);
+	CHECK(plain.written == "{\"interval\": 5}");
+	CHECK(JsonUut<>::MemoryReport::jsonBody() == 1);
+}
+
+TEST(HttpLogicJson, Unsupported)
+{
+	struct Default: HttpLogic<Default, HttpConfig::JsonBodyDepth<4>> {
+		std::string response;
+		void send(const char* str, unsigned int length) { response += std::string(str, length); }
+		void flush() {}
+	} uut;
+
+	uut.reset();
+	const std::string request = post("application/json", "{}");
+	uut.parse(request.data(), request.length());
+	uut.done();
+
+	CHECK(uut.response.substr(0, uut.response.find("\r\n")) == "HTTP/1.1 415 Unsupported Media Type");
+}
@@ -0,0 +1,256 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2017 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#include "1test/Test.h"
+
+#include "HttpLogic.h"
+
+#include <string>
+
+#include <stdlib.h>
+
+TEST_GROUP(HttpLogicLock) {
+
+	struct Uut: public HttpLogic<Uut,
+		HttpConfig::DavStackSize<192>,
+		HttpConfig::DavLockCount<4>,
+		HttpConfig::DavLockTimeout<100>
+	> {
+		std::string response;
+		uint32_t now = 0;
+
+		void send(const char* str, unsigned int length) {
+			response += std::string(str, length);
+		}
+
+		void flush() {}
+
+		DavAccess sourceAccessible(bool authenticated) { return DavAccess::Dav; }
+
+		void resetSourceLocator() {}
+		void resetDestinationLocator() {}
+		HttpStatus enterSource(const char* str, unsigned int length) {return HTTP_STATUS_OK;}
+		HttpStatus enterDestination(const char* str, unsigned int length) {return HTTP_STATUS_OK;}
+
+		HttpStatus remove(const char* dstName, uint32_t length) { return HTTP_STATUS_NO_CONTENT; }
+		HttpStatus move(const char* dstName, uint32_t length, bool overwrite) { return HTTP_STATUS_CREATED; }
+		HttpStatus arrangeReceiveInto(const char* dstName, uint32_t length) { return HTTP_STATUS_OK; }
+		HttpStatus writeContent(const char* buff, uint32_t length) { return HTTP_STATUS_OK; }
+		HttpStatus contentWritten() { return HTTP_STATUS_CREATED; }
+
+		uint32_t currentTime() { return now; }
+
+		std::string process(const char* input) {
+			response.clear();
+			reset();
+			parse(input, strlen(input));
+			done();
+			return response.substr(0, response.find("\r\n"));
+		}
+
+		std::string body() {
+			std::string ret;
+			size_t idx = response.find("\r\n\r\n");
+
+			if(idx == std::string::npos)
+				return ret;
+
+			for(idx += 4; idx < response.length();) {
+				size_t end = response.find("\r\n", idx);
+				uint32_t size = strtoul(response.substr(idx, end - idx).c_str(), nullptr, 16);
+				ret += response.substr(end + 2, size);
+				idx = end + 2 + size + 2;
+			}
+
+			return ret;
+		}
+
+		std::string lockToken() {
+			constexpr const char* header = "Lock-Token: <";
+			size_t start = response.find(header);
+
+			if(start == std::string::npos)
+				return "";
+
+			start += strlen(header);
+			return response.substr(start, response.find('>', start) - start);
+		}
+	};
+
+	Uut uut;
+
+	TEST_SETUP() {
+		Uut::resetLocks();
+	}
+
+	static constexpr const char* exclusiveBody =
+			"<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+			"<D:lockinfo xmlns:D=\"DAV:\">"
+			"<D:lockscope><D:exclusive/></D:lockscope>"
+			"<D:locktype><D:write/></D:locktype>"
+			"</D:lockinfo>";
+
+	static constexpr const char* sharedBody =
+			"<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+			"<D:lockinfo xmlns:D=\"DAV:\">"
+			"<D:lockscope><D:shared/></D:lockscope>"
+			"<D:locktype><D:write/></D:locktype>"
+			"</D:lockinfo>";
+
+	std::string lock(const char* path, const char* depth = "infinity", const char* body = exclusiveBody) {
+		std::string request = std::string("LOCK ") + path + " HTTP/1.1\r\n"
+				"Depth: " + depth + "\r\n"
+				"Timeout: Second-3600\r\n"
+				"Content-Length: " + std::to_string(strlen(body)) + "\r\n\r\n" +
+				body;
+
+		return uut.process(request.c_str());
+	}
+
+	std::string withToken(const char* requestLine, const char* header, const std::string &token) {
+		std::string request = std::string(requestLine) + "\r\n" + header + ": (<" + token + ">)\r\n\r\n";
+		return uut.process(request.c_str());
+	}
+};
+
+TEST(HttpLogicLock, Options) {
+	CHECK(uut.process("OPTIONS / HTTP/1.1\r\n\r\n") == "HTTP/1.1 200 OK");
+	CHECK(uut.response.find("LOCK,UNLOCK") != std::string::npos);
+	CHECK(uut.response.find("Dav: 1,2\r\n") != std::string::npos);
+}
+
+TEST(HttpLogicLock, LockUnlock) {
+	CHECK(lock("/foo/bar", "0") == "HTTP/1.1 200 OK");
+	const std::string token = uut.lockToken();
+	CHECK(token.length() > strlen("opaquelocktoken:"));
+	CHECK(uut.response.find("Transfer-Encoding: chunked") != std::string::npos);
+	CHECK(uut.body().find("<exclusive/>") != std::string::npos);
+	CHECK(uut.body().find("<depth>0</depth>") != std::string::npos);
+	CHECK(uut.body().find("<timeout>Second-100</timeout>") != std::string::npos);
+	CHECK(uut.body().find("<href>" + token + "</href>") != std::string::npos);
+
+	CHECK(lock("/foo/bar") == "HTTP/1.1 423 Locked");
+	CHECK(uut.process("DELETE /foo/bar HTTP/1.1\r\n\r\n") == "HTTP/1.1 423 Locked");
+	CHECK(uut.process("PUT /foo/bar HTTP/1.1\r\nContent-Length: 3\r\n\r\nfoo") == "HTTP/1.1 423 Locked");
+	CHECK(uut.process("PUT /foo/baz HTTP/1.1\r\nContent-Length: 3\r\n\r\nfoo") == "HTTP/1.1 201 Created");
+	CHECK(withToken("DELETE /foo/bar HTTP/1.1", "If", token) == "HTTP/1.1 204 No Content");
+
+	CHECK(uut.process("UNLOCK /foo/bar HTTP/1.1\r\n\r\n") == "HTTP/1.1 400 Bad Request");
+	CHECK(withToken("UNLOCK /foo/baz HTTP/1.1", "Lock-Token", token) == "HTTP/1.1 409 Conflict");
+	CHECK(withToken("UNLOCK /foo/bar HTTP/1.1", "Lock-Token", token) == "HTTP/1.1 204 No Content");
+	CHECK(uut.process("DELETE /foo/bar HTTP/1.1\r\n\r\n") == "HTTP/1.1 204 No Content");
+}
+
+TEST(HttpLogicLock, Deep) {
+	CHECK(lock("/foo") == "HTTP/1.1 200 OK");
+	const std::string token = uut.lockToken();
+	CHECK(uut.body().find("<depth>infinity</depth>") != std::string::npos);
+
+	CHECK(uut.process("PUT /foo/bar HTTP/1.1\r\nContent-Length: 3\r\n\r\nfoo") == "HTTP/1.1 423 Locked");
+	CHECK(uut.process("MOVE /bar HTTP/1.1\r\nDestination: http://127.0.0.1/foo/bar\r\n\r\n") == "HTTP/1.1 423 Locked");
+	CHECK(uut.process("MOVE /foo/bar HTTP/1.1\r\nDestination: http://127.0.0.1/bar\r\n\r\n") == "HTTP/1.1 423 Locked");
+	CHECK(uut.process("MOVE /bar HTTP/1.1\r\nDestination: http://127.0.0.1/baz\r\n\r\n") == "HTTP/1.1 201 Created");
+	CHECK(lock("/foo/bar", "0") == "HTTP/1.1 423 Locked");
+	CHECK(lock("/foo/bar", "1") == "HTTP/1.1 400 Bad Request");
+}
+
+TEST(HttpLogicLock, Members) {
+	CHECK(lock("/foo/bar", "0") == "HTTP/1.1 200 OK");
+	const std::string token = uut.lockToken();
+
+	CHECK(uut.process("DELETE /foo HTTP/1.1\r\n\r\n") == "HTTP/1.1 423 Locked");
+	CHECK(uut.process("DELETE /foo/ HTTP/1.1\r\n\r\n") == "HTTP/1.1 423 Locked");
+	CHECK(uut.process("MOVE /foo HTTP/1.1\r\nDestination: http://127.0.0.1/baz\r\n\r\n") == "HTTP/1.1 423 Locked");
+	CHECK(uut.process("MOVE /baz HTTP/1.1\r\nDestination: http://127.0.0.1/foo\r\n\r\n") == "HTTP/1.1 423 Locked");
+	CHECK(uut.process("PUT /foo/baz HTTP/1.1\r\nContent-Length: 3\r\n\r\nfoo") == "HTTP/1.1 201 Created");
+	CHECK(uut.process("DELETE /bar HTTP/1.1\r\n\r\n") == "HTTP/1.1 204 No Content");
+	CHECK(lock("/foo") == "HTTP/1.1 423 Locked");
+	CHECK(lock("/foo", "0") == "HTTP/1.1 200 OK");
+	const std::string other = uut.lockToken();
+
+	CHECK(withToken("DELETE /foo HTTP/1.1", "If", token) == "HTTP/1.1 423 Locked");
+	std::string request = std::string("DELETE /foo HTTP/1.1\r\nIf: (<") + token + ">) (<" + other + ">)\r\n\r\n";
+	CHECK(uut.process(request.c_str()) == "HTTP/1.1 204 No Content");
+}
+
+TEST(HttpLogicLock, Shared) {
+	CHECK(lock("/foo", "0", sharedBody) == "HTTP/1.1 200 OK");
+	const std::string first = uut.lockToken();
+	CHECK(lock("/foo", "0", sharedBody) == "HTTP/1.1 200 OK");
+	const std::string second = uut.lockToken();
+	CHECK(lock("/foo", "0") == "HTTP/1.1 423 Locked");
+
+	CHECK(uut.process("PUT /foo HTTP/1.1\r\nContent-Length: 3\r\n\r\nfoo") == "HTTP/1.1 423 Locked");
+	CHECK(withToken("PUT /foo HTTP/1.1\r\nContent-Length: 0", "If", first) == "HTTP/1.1 201 Created");
+	CHECK(withToken("PUT /foo HTTP/1.1\r\nContent-Length: 0", "If", second) == "HTTP/1.1 201 Created");
+	CHECK(withToken("DELETE /foo HTTP/1.1", "If", second) == "HTTP/1.1 204 No Content");
+}
+
+TEST(HttpLogicLock, Nested) {
+	CHECK(lock("/foo", "infinity", sharedBody) == "HTTP/1.1 200 OK");
+	const std::string outer = uut.lockToken();
+	CHECK(lock("/foo/bar", "infinity", sharedBody) == "HTTP/1.1 200 OK");
+	const std::string inner = uut.lockToken();
+	CHECK(lock("/foo/bar/baz", "0") == "HTTP/1.1 423 Locked");
+
+	CHECK(uut.process("PUT /foo/bar/baz HTTP/1.1\r\nContent-Length: 0\r\n\r\n") == "HTTP/1.1 423 Locked");
+	CHECK(withToken("PUT /foo/bar/baz HTTP/1.1\r\nContent-Length: 0", "If", outer) == "HTTP/1.1 201 Created");
+	CHECK(withToken("PUT /foo/bar/baz HTTP/1.1\r\nContent-Length: 0", "If", inner) == "HTTP/1.1 201 Created");
+	CHECK(withToken("PUT /foo/qux HTTP/1.1\r\nContent-Length: 0", "If", inner) == "HTTP/1.1 423 Locked");
+	CHECK(withToken("DELETE /foo/bar HTTP/1.1", "If", outer) == "HTTP/1.1 204 No Content");
+	CHECK(withToken("DELETE /foo HTTP/1.1", "If", inner) == "HTTP/1.1 423 Locked");
+
+	CHECK(withToken("UNLOCK /foo/bar HTTP/1.1", "Lock-Token", inner) == "HTTP/1.1 204 No Content");
+	CHECK(withToken("UNLOCK /foo HTTP/1.1", "Lock-Token", outer) == "HTTP/1.1 204 No Content");
+	CHECK(uut.process("DELETE /foo HTTP/1.1\r\n\r\n") == "HTTP/1.1 204 No Content");
+}
+
+TEST(HttpLogicLock, RefreshExpire) {
+	CHECK(lock("/foo") == "HTTP/1.1 200 OK");
+	const std::string token = uut.lockToken();
+
+	uut.now = 90;
+	CHECK(withToken("LOCK /foo HTTP/1.1", "If", token) == "HTTP/1.1 200 OK");
+	CHECK(uut.lockToken() == "");
+	CHECK(uut.body().find("<href>" + token + "</href>") != std::string::npos);
+
+	uut.now = 180;
+	CHECK(uut.process("DELETE /foo HTTP/1.1\r\n\r\n") == "HTTP/1.1 423 Locked");
+
+	uut.now = 190;
+	CHECK(withToken("LOCK /foo HTTP/1.1", "If", token) == "HTTP/1.1 412 Precondition Failed");
+	CHECK(uut.process("DELETE /foo HTTP/1.1\r\n\r\n") == "HTTP/1.1 204 No Content");
+}
+
+TEST(HttpLogicLock, Full) {
+	CHECK(lock("/a") == "HTTP/1.1 200 OK");
+	CHECK(lock("/b") == "HTTP/1.1 200 OK");
+	CHECK(lock("/c") == "HTTP/1.1 200 OK");
+	CHECK(lock("/d") == "HTTP/1.1 200 OK");
+	CHECK(lock("/e") == "HTTP/1.1 503 Service Unavailable");
+}
+
+TEST(HttpLogicLock, BadBody) {
+	static constexpr const char* request =
+			"LOCK /foo HTTP/1.1\r\n"
+			"Content-Length: 47\r\n\r\n"
+			"<propfind xmlns=\"DAV:\"><allprop/></propfind>\r\n";
+
+	CHECK(uut.process(request) == "HTTP/1.1 400 Bad Request");
+}
@@ -110,6 +110,46 @@ TEST(HttpLogicNormal, Get)
 	}
 }
 
+TEST(HttpLogicNormal, GetEscaped)
+{
+	static constexpr const char* testRequest =
+			"GET /foo%20bar/b%61z HTTP/1.1\r\n\r\n";
+
+	for(unsigned int i=0; i<strlen(testRequest); i++) {
+		MOCK(ResourceLocator)::EXPECT(reset);
+		MOCK(ResourceLocator)::EXPECT(enter).withStringParam("foo bar");
+		MOCK(ResourceLocator)::EXPECT(enter).withStringParam("baz");
+		MOCK(ContentProvider)::EXPECT(sendFrom).withStringParam("/foo bar/baz");
+		MOCK(ContentProvider)::EXPECT(contentRead);
+
+		uut.reset();
+		uut.parse(testRequest, i);
+		uut.parse(testRequest + i, strlen(testRequest) - i);
+		uut.done();
+
+		CHECK(MockedHttpLogic::workerCalled);
+		CHECK(uut.getStatus() == HTTP_STATUS_OK);
+	}
+}
+
+TEST(HttpLogicNormal, GetLongestElement)
+{
+	static constexpr const char* testRequest =
+			"GET /0123456789abcdef0123456789abcdef HTTP/1.1\r\n\r\n";
+
+	MOCK(ResourceLocator)::EXPECT(reset);
+	MOCK(ResourceLocator)::EXPECT(enter).withStringParam("0123456789abcdef0123456789abcdef");
+	MOCK(ContentProvider)::EXPECT(sendFrom).withStringParam("/0123456789abcdef0123456789abcdef");
+	MOCK(ContentProvider)::EXPECT(contentRead);
+
+	uut.reset();
+	uut.parse(testRequest, strlen(testRequest));
+	uut.done();
+
+	CHECK(MockedHttpLogic::workerCalled);
+	CHECK(uut.getStatus() == HTTP_STATUS_OK);
+}
+
 TEST(HttpLogicNormal, PutAuth)
 {
 	static constexpr const char* testRequest =
@@ -117,9 +157,9 @@ TEST(HttpLogicNormal, PutAuth)
 			"Authorization: Digest\r\n"
 			" username=\"foo\",\r\n"
 			" realm=\"bar\",\r\n"
-			" nonce=\"justonce\",\r\n"
+			" nonce=\"0000000000000000d1d8075129755a4e\",\r\n"
 			" uri=\"/index.html\",\r\n"
-			" response=\"3f698a1237eeb963bb25fed3febf42de\",\r\n"
+			" response=\"0cab82f62b09d13e1e852db661c78a4b\",\r\n"
 			" algorithm=\"MD5\"\r\n"
 			"Content-Length:8\r\n\r\n"
 			"BodyTest\r\n";
@@ -144,3 +184,11 @@ TEST(HttpLogicNormal, PutAuth)
 	}
 }
 
+TEST(HttpLogicNormal, MemoryReport)
+{
+	typedef MockedHttpLogic::MemoryReport Report;
+
+	CHECK(Report::pathElement() > 32);
+	CHECK(Report::session() > Report::pathElement() + Report::davRequest());
+	CHECK(Report::session() <= sizeof(MockedHttpLogic));
+}
@@ -41,6 +41,7 @@ TEST_GROUP(HttpLogicOutput) {
 		uint32_t n;
 
 		std::string response;
+		DavAccess access;
 
 		void send(const char* str, unsigned int length) {
 			response += std::string(str, length);
@@ -48,7 +49,7 @@ TEST_GROUP(HttpLogicOutput) {
 
 		void flush() {}
 
-		DavAccess sourceAccessible(bool authenticated) { return DavAccess::Dav; }
+		DavAccess sourceAccessible(bool authenticated) { return access; }
 
 		void resetSourceLocator() {}
 		void resetDestinationLocator() {}
@@ -236,6 +237,7 @@ TEST_GROUP(HttpLogicOutput) {
 
 	TEST_SETUP() {
 		uut.response.clear();
+		uut.access = DavAccess::Dav;
 	}
 };
 
@@ -292,6 +294,81 @@ TEST(HttpLogicOutput, Put)
 			"\r\n");
 }
 
+TEST(HttpLogicOutput, PutExpectContinue)
+{
+	uut.process("PUT /foo/bar HTTP/1.1\r\n"
+			"Content-Length: 7\r\n"
+			"Expect: 100-continue\r\n"
+			"\r\n"
+			"Content");
+
+	CHECK(uut.response ==
+			"HTTP/1.1 100 Continue\r\n"
+			"\r\n"
+			"HTTP/1.1 201 Created\r\n"
+			"Connection: Keep-Alive\r\n"
+			"Content-Length: 0\r\n"
+			"\r\n");
+}
+
+TEST(HttpLogicOutput, PutExpectContinueCase)
+{
+	uut.process("PUT /foo/bar HTTP/1.1\r\n"
+			"Content-Length: 7\r\n"
+			"Expect: 100-Continue\r\n"
+			"\r\n"
+			"Content");
+
+	CHECK(uut.response ==
+			"HTTP/1.1 100 Continue\r\n"
+			"\r\n"
+			"HTTP/1.1 201 Created\r\n"
+			"Connection: Keep-Alive\r\n"
+			"Content-Length: 0\r\n"
+			"\r\n");
+}
+
+TEST(HttpLogicOutput, PutExpectUnauthorized)
+{
+	static constexpr const char* headers =
+			"PUT /foo/bar HTTP/1.1\r\n"
+			"Content-Length: 7\r\n"
+			"Expect: 100-continue\r\n"
+			"\r\n";
+
+	static constexpr const char* expected =
+			"HTTP/1.1 401 Unauthorized\r\n"
+			"Connection: Close\r\n"
+			"Content-Length: 0\r\n"
+			"\r\n";
+
+	uut.access = DavAccess::AuthNeeded;
+	uut.reset();
+	uut.parse(headers, strlen(headers));
+	CHECK(uut.response == expected);
+
+	uut.parse("Content", 7);
+	uut.done();
+	CHECK(uut.response == expected);
+}
+
+TEST(HttpLogicOutput, PutExpectUnknown)
+{
+	static constexpr const char* headers =
+			"PUT /foo/bar HTTP/1.1\r\n"
+			"Content-Length: 7\r\n"
+			"Expect: something\r\n"
+			"\r\n";
+
+	uut.reset();
+	uut.parse(headers, strlen(headers));
+	CHECK(uut.response ==
+			"HTTP/1.1 417 Expectation Failed\r\n"
+			"Connection: Close\r\n"
+			"Content-Length: 0\r\n"
+			"\r\n");
+}
+
 TEST(HttpLogicOutput, Delete)
 {
 	uut.process("DELETE /foo/bar HTTP/1.1\r\n\r\n");
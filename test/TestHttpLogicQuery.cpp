@@ -0,0 +1,121 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2017 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#include "1test/Test.h"
+
+#include "HttpLogic.h"
+
+#include <string>
+#include <string.h>
+
+namespace {
+	struct QueryParameters {
+		enum Key {Offset, Name};
+		static const Keywords<Key, 2> keywords;
+	};
+
+	const Keywords<QueryParameters::Key, 2> QueryParameters::keywords(
+		Keywords<QueryParameters::Key, 2>::Keyword("offset", QueryParameters::Offset),
+		Keywords<QueryParameters::Key, 2>::Keyword("name", QueryParameters::Name)
+	);
+
+	struct QueryUut: public HttpLogic<QueryUut, HttpConfig::QueryParameters<QueryParameters>> {
+		std::string response, path, value, parameters;
+		bool sent = false;
+
+		void send(const char* str, unsigned int length) {
+			response += std::string(str, length);
+		}
+
+		void flush() {}
+
+		void resetSourceLocator() {
+			path.clear();
+		}
+
+		HttpStatus enterSource(const char* str, unsigned int length) {
+			path += std::string("/") + std::string(str, length);
+			return HTTP_STATUS_OK;
+		}
+
+		void onQueryParameter(QueryParameters::Key key, const char* str, uint32_t length) {
+			value += std::string(str, length);
+		}
+
+		void queryParameterDone(QueryParameters::Key key) {
+			parameters += (key == QueryParameters::Offset ? "offset=" : "name=") + value + ";";
+			value.clear();
+		}
+
+		HttpStatus arrangeSendFrom(uint32_t &size) {
+			size = 0;
+			sent = true;
+			return HTTP_STATUS_OK;
+		}
+
+		HttpStatus readContent() { return HTTP_STATUS_OK; }
+		HttpStatus contentRead() { return HTTP_STATUS_OK; }
+
+		/*
+		 * Feeds the request split at the given position,
+		 * returns the status line of the response.
+		 */
+		std::string process(const char* request, unsigned int split) {
+			response.clear();
+			parameters.clear();
+			value.clear();
+			sent = false;
+
+			reset();
+			parse(request, split);
+			parse(request + split, strlen(request) - split);
+			done();
+			return response.substr(0, response.find("\r\n"));
+		}
+	};
+}
+
+TEST_GROUP(HttpLogicQuery) {
+	QueryUut uut;
+};
+
+TEST(HttpLogicQuery, Dispatched)
+{
+	static constexpr const char* testRequest =
+			"GET /foo?offset=12&sort=asc&&name=a%20b+c HTTP/1.1\r\n\r\n";
+
+	for(unsigned int i=0; i<strlen(testRequest); i++) {
+		CHECK(uut.process(testRequest, i) == "HTTP/1.1 200 OK");
+		CHECK(uut.path == "/foo");
+		CHECK(uut.parameters == "offset=12;name=a b c;");
+		CHECK(uut.sent);
+	}
+}
+
+TEST(HttpLogicQuery, Invalid)
+{
+	static constexpr const char* testRequest =
+			"GET /foo?offset=1%x2 HTTP/1.1\r\n"
+			"Host: localhost\r\n\r\n";
+
+	for(unsigned int i=0; i<strlen(testRequest); i++) {
+		CHECK(uut.process(testRequest, i) == "HTTP/1.1 400 Bad Request");
+		CHECK(!uut.sent);
+	}
+}
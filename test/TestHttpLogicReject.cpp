@@ -0,0 +1,125 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2017 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#include "1test/Test.h"
+
+#include "HttpLogic.h"
+
+#include <string>
+
+TEST_GROUP(HttpLogicReject) {
+
+	template<RejectPolicy policy>
+	struct Uut: public HttpLogic<Uut<policy>,
+		HttpConfig::DavStackSize<192>,
+		HttpConfig::EarlyReject<policy>
+	> {
+		std::string response;
+		uint32_t written = 0;
+		bool closed = false;
+
+		void send(const char* str, unsigned int length) {
+			response += std::string(str, length);
+		}
+
+		void flush() {}
+
+		void closeConnection() {
+			closed = true;
+		}
+
+		DavAccess sourceAccessible(bool authenticated) { return DavAccess::AuthNeeded; }
+
+		void resetSourceLocator() {}
+		void resetDestinationLocator() {}
+		HttpStatus enterSource(const char* str, unsigned int length) {return HTTP_STATUS_OK;}
+		HttpStatus enterDestination(const char* str, unsigned int length) {return HTTP_STATUS_OK;}
+
+		HttpStatus arrangeReceiveInto(const char* dstName, uint32_t length) {
+			return HTTP_STATUS_OK;
+		}
+
+		HttpStatus writeContent(const char* buff, uint32_t length) {
+			written += length;
+			return HTTP_STATUS_OK;
+		}
+	};
+
+	static constexpr const char* headers =
+			"PUT /foo/bar HTTP/1.1\r\n"
+			"Content-Length: 7\r\n"
+			"\r\n";
+
+	static constexpr const char* next =
+			"OPTIONS / HTTP/1.1\r\n"
+			"\r\n";
+
+	static constexpr const char* rejected =
+			"HTTP/1.1 401 Unauthorized\r\n"
+			"Content-Length: 0\r\n"
+			"\r\n";
+};
+
+TEST(HttpLogicReject, Wait)
+{
+	Uut<RejectPolicy::Wait> uut;
+	uut.reset();
+	uut.parse(headers, strlen(headers));
+	CHECK(uut.response == "");
+
+	uut.parse("Content", 7);
+	CHECK(uut.response == rejected);
+	CHECK(uut.written == 0);
+}
+
+TEST(HttpLogicReject, Drain)
+{
+	Uut<RejectPolicy::Drain> uut;
+	uut.reset();
+	uut.parse(headers, strlen(headers));
+	CHECK(uut.response == rejected);
+
+	uut.parse("Content", 7);
+	CHECK(uut.response == rejected);
+	CHECK(uut.written == 0);
+
+	uut.response.clear();
+	uut.parse(next, strlen(next));
+	CHECK(uut.response == rejected);
+	CHECK(!uut.closed);
+}
+
+TEST(HttpLogicReject, Close)
+{
+	Uut<RejectPolicy::Close> uut;
+	uut.reset();
+	uut.parse(headers, strlen(headers));
+	CHECK(uut.response ==
+			"HTTP/1.1 401 Unauthorized\r\n"
+			"Connection: Close\r\n"
+			"Content-Length: 0\r\n"
+			"\r\n");
+	CHECK(uut.closed);
+
+	uut.response.clear();
+	uut.parse("Content", 7);
+	uut.parse(next, strlen(next));
+	CHECK(uut.written == 0);
+	CHECK(uut.response == "");
+}
@@ -209,6 +209,55 @@ TEST(JsonParser, Complex) {
 	CHECK(id == 5002);
 }
 
+TEST(JsonParser, Doubles) {
+	int id = 0;
+	double ppu = 0, batter = 0;
+
+	NumberExtractor idExtractor(id);
+	DoubleExtractor ppuExtractor(ppu), batterExtractor(batter);
+	auto f2 = assemble<ObjectFilter>(FilterEntry("id", &batterExtractor));
+	auto f1 = assemble<ArrayFilter>(FilterEntry(3, &f2));
+	auto f0 = assemble<ObjectFilter>(FilterEntry("batter", &f1));
+	auto filter = assemble<ObjectFilter>(
+			FilterEntry("ppu", &ppuExtractor),
+			FilterEntry("batters", &f0)
+		);
+
+	uut.reset(&filter);
+	CHECK(uut.parse(complexTestDocument, strlen(complexTestDocument)));
+	CHECK(uut.done());
+
+	CHECK(ppu == 0.55);
+	CHECK(batter == 1004);
+}
+
+TEST(JsonParser, ParentLeave) {
+	struct Counter: NumberExtractor {
+		int left = 0;
+		inline Counter(int& x): NumberExtractor(x) {}
+		virtual void onParentLeave() override { left++; }
+	};
+
+	int x[4];
+	Counter counters[] = {x[0], x[1], x[2], x[3]};
+
+	auto filter = assemble<ObjectFilter>(
+			FilterEntry("one", counters + 0),
+			FilterEntry("three", counters + 2),
+			FilterEntry("five", counters + 3),
+			FilterEntry("four", counters + 1)
+		);
+
+	uut.reset(&filter);
+	CHECK(uut.parse(objectTestDocument, strlen(objectTestDocument)));
+	CHECK(uut.done());
+
+	CHECK(x[0] == 1 && counters[0].left == 1);
+	CHECK(x[1] == 4 && counters[1].left == 1);
+	CHECK(x[2] == 3 && counters[2].left == 1);
+	CHECK(counters[3].left == 0);
+}
+
 TEST(JsonParser, Erroneous) {
 	char never[16] = {0,};
 	auto typeExtractor = makeStringExtractor(never);
@@ -90,3 +90,102 @@ TEST(Keywords, PartialNoMatch) {
 	CHECK(matcher.progress(keywords, "so"));
 	CHECK(matcher.match(keywords) == 0);
 }
+
+typedef HashedKeywords<int, 8> TestHashedKeywords;
+
+const TestHashedKeywords hashedKeywords = {
+	TestHashedKeywords::Keyword("foobar", 1),
+	TestHashedKeywords::Keyword("some", 2),
+	TestHashedKeywords::Keyword("foo", 3),
+	TestHashedKeywords::Keyword("things", 4),
+	TestHashedKeywords::Keyword("bar", 5),
+	TestHashedKeywords::Keyword("buz", 6),
+	TestHashedKeywords::Keyword("baz", 7),
+	TestHashedKeywords::Keyword("foo", 8)
+};
+
+TEST_GROUP(HashedKeywords) {
+	TestHashedKeywords::Matcher matcher;
+};
+
+TEST(HashedKeywords, Hash) {
+	static_assert(KeywordHash::of("") == 0x811c9dc5, "FNV-1a offset basis");
+	static_assert(KeywordHash::of("a") == 0xe40c292c, "FNV-1a of 'a'");
+	static_assert(KeywordHash::of("foobar") == 0xbf9cf968, "FNV-1a of 'foobar'");
+	static_assert(KeywordHash::lengthOf("foobar") == 6, "Length of 'foobar'");
+
+	KeywordHash hash;
+	hash.reset();
+	hash.progress("foo", 3);
+	hash.progress("bar", 3);
+	CHECK(hash.hash == KeywordHash::of("foobar"));
+	CHECK(hash.length == 6);
+}
+
+TEST(HashedKeywords, Segmented) {
+	matcher.reset();
+	matcher.progress(hashedKeywords, "f");
+	matcher.progress(hashedKeywords, "oob");
+	matcher.progress(hashedKeywords, "ar");
+	CHECK(matcher.match(hashedKeywords)->getValue() == 1);
+}
+
+TEST(HashedKeywords, All) {
+	const char* keys[] = {"foobar", "some", "foo", "things", "bar", "buz", "baz"};
+
+	for(int i = 0; i < 7; i++) {
+		matcher.reset();
+		matcher.progress(hashedKeywords, keys[i]);
+		CHECK(matcher.match(hashedKeywords)->getValue() == i + 1);
+	}
+}
+
+TEST(HashedKeywords, Nonexistent) {
+	const char* keys[] = {"", "f", "fo", "foob", "foobarr", "somes", "thing", "asdqwe", "FOO"};
+
+	for(auto key: keys) {
+		matcher.reset();
+		matcher.progress(hashedKeywords, key);
+		CHECK(matcher.match(hashedKeywords) == 0);
+	}
+}
+
+TEST(HashedKeywords, Collision) {
+	// Same FNV-1a hash and length as 'foobar'.
+	static_assert(KeywordHash::of("wHieEk") == KeywordHash::of("foobar"), "Colliding key");
+	static_assert(KeywordHash::of("0foSCr") == KeywordHash::of("foobar"), "Colliding key");
+
+	const char* keys[] = {"wHieEk", "0foSCr"};
+
+	for(auto key: keys) {
+		matcher.reset();
+		matcher.progress(hashedKeywords, key);
+		CHECK(matcher.match(hashedKeywords) == 0);
+	}
+}
+
+TEST(HashedKeywords, Branching) {
+	const char* keys[] = {"foobar", "foo", "fo", "fooba", "bar", "buz", "baz", "bu", "b", ""};
+	const int values[] = {1, 3, -1, -1, 5, 6, 7, -1, -1, -1};
+
+	for(int i = 0; i < 10; i++) {
+		for(unsigned int j = 0; j <= strlen(keys[i]); j++) {
+			matcher.reset();
+			matcher.progress(hashedKeywords, keys[i], j);
+			matcher.progress(hashedKeywords, keys[i] + j);
+
+			const TestHashedKeywords::Keyword* result = matcher.match(hashedKeywords);
+			CHECK(values[i] < 0 ? !result : (result && result->getValue() == values[i]));
+		}
+	}
+}
+
+TEST(HashedKeywords, Iterate) {
+	TestHashedKeywords copy = hashedKeywords;
+	int sum = 0;
+
+	for(auto &k: copy)
+		sum += k.getValue();
+
+	CHECK(sum == 36);
+}
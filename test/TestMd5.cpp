@@ -0,0 +1,70 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2017 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#include "1test/Test.h"
+
+#include "md5/md5.h"
+
+#include <string>
+#include <string.h>
+
+TEST_GROUP(Md5) {
+	static std::string hash(const std::string& in, unsigned int chunk) {
+		static const char hex[] = "0123456789abcdef";
+		unsigned char temp[16];
+		std::string ret;
+		MD5_CTX ctx;
+		MD5_Init(&ctx);
+
+		for(unsigned int i = 0; i < in.length(); i += chunk)
+			MD5_Update(&ctx, in.data() + i, (in.length() - i < chunk) ? (in.length() - i) : chunk);
+
+		MD5_Final(temp, &ctx);
+
+		for(unsigned char c: temp)
+			ret += std::string(1, hex[c >> 4]) + hex[c & 0xf];
+
+		return ret;
+	}
+
+	/*
+	 * Feeds the input in one piece and in odd sized chunks too.
+	 */
+	static bool check(const std::string& in, const char* expected) {
+		for(unsigned int chunk: {(unsigned int)in.length() + 1, 1u, 3u, 63u, 65u})
+			if(hash(in, chunk) != expected)
+				return false;
+
+		return true;
+	}
+};
+
+TEST(Md5, Rfc1321) {
+	CHECK(check("", "d41d8cd98f00b204e9800998ecf8427e"));
+	CHECK(check("a", "0cc175b9c0f1b6a831c399e269772661"));
+	CHECK(check("abc", "900150983cd24fb0d6963f7d28e17f72"));
+	CHECK(check("message digest", "f96b697d7cb7938d525a2f31aaf161d0"));
+	CHECK(check("abcdefghijklmnopqrstuvwxyz", "c3fcd3d76192e4007dfb496cca67e13b"));
+	CHECK(check("12345678901234567890123456789012345678901234567890123456789012345678901234567890",
+			"57edf4a22be3c955ac49da2e2107b67a"));
+}
+
+TEST(Md5, Long) {
+	CHECK(check(std::string(1000000, 'a'), "7707d6ae4e027c70eea2a935c2296f21"));
+}
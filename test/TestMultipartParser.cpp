@@ -0,0 +1,174 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2017 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#include "1test/Test.h"
+
+#include "MultipartParser.h"
+
+#include <string>
+
+#include <string.h>
+
+namespace {
+	static constexpr const char* upload =
+			"--xYzZY\r\n"
+			"Content-Disposition: form-data; name=\"comment\"\r\n"
+			"\r\n"
+			"Hello\r\n-\r\n--xYz\r\r\n--xYzZ\r\n"
+			"--xYzZY\r\n"
+			"Content-Disposition: form-data; name=\"file\"; filename=\"a.txt\"\r\n"
+			"Content-Type:text/plain\r\n"
+			"\r\n"
+			"\r\n--\r\n"
+			"--xYzZY--\r\n"
+			"epilogue";
+
+	static constexpr const char* expected =
+			"<"
+			"Content-Disposition=form-data; name=\"comment\";"
+			"[Hello\r\n-\r\n--xYz\r\r\n--xYzZ]"
+			"<"
+			"Content-Disposition=form-data; name=\"file\"; filename=\"a.txt\";"
+			"Content-Type=text/plain;"
+			"[\r\n--]";
+}
+
+TEST_GROUP(MultipartParser) {
+	class UUT: public MultipartParser<UUT, 16> {
+		friend MultipartParser<UUT, 16>;
+		bool inBody = false;
+
+		void onPartStart() {
+			result += "<";
+		}
+
+		void onHeaderName(const char* buff, uint32_t length) {
+			result += std::string(buff, length);
+		}
+
+		void onHeaderNameEnd() {
+			result += "=";
+		}
+
+		void onHeaderValue(const char* buff, uint32_t length) {
+			result += std::string(buff, length);
+		}
+
+		void onHeaderValueEnd() {
+			result += ";";
+		}
+
+		void onPartBody(const char* buff, uint32_t length) {
+			if(!inBody) {
+				result += "[";
+				inBody = true;
+			}
+
+			result += std::string(buff, length);
+		}
+
+		void onPartEnd() {
+			result += inBody ? "]" : "[]";
+			inBody = false;
+		}
+
+	public:
+		std::string result;
+	};
+
+	UUT uut;
+
+	bool parse(const char* input, unsigned int first, unsigned int second) {
+		const unsigned int length = strlen(input);
+		return uut.parseMultipart(input, first)
+			&& uut.parseMultipart(input + first, second - first)
+			&& uut.parseMultipart(input + second, length - second)
+			&& uut.done();
+	}
+};
+
+TEST(MultipartParser, Learned) {
+	for(unsigned int i = 0; i <= strlen(upload); i++) {
+		for(unsigned int j = i; j <= strlen(upload); j++) {
+			uut.result.clear();
+			uut.reset();
+			CHECK(parse(upload, i, j));
+			CHECK(uut.result == expected);
+		}
+	}
+}
+
+TEST(MultipartParser, Explicit) {
+	const std::string input = std::string("preamble\r\n") + upload;
+
+	for(unsigned int i = 0; i <= input.length(); i++) {
+		uut.result.clear();
+		CHECK(uut.reset("xYzZY", 5));
+		CHECK(parse(input.c_str(), i, i));
+		CHECK(uut.result == expected);
+	}
+}
+
+TEST(MultipartParser, Empty) {
+	static constexpr const char* input = "--b\r\n\r\n\r\n--b--";
+
+	uut.reset();
+	CHECK(parse(input, 0, 0));
+	CHECK(uut.result == "<[]");
+}
+
+TEST(MultipartParser, Unterminated) {
+	static constexpr const char* input = "--b\r\n\r\ndata\r\n--";
+
+	uut.reset();
+	CHECK(!parse(input, 0, 0));
+}
+
+TEST(MultipartParser, HeaderWithoutColon) {
+	static constexpr const char* input =
+			"--xyz\r\nBogusLine\r\n\r\nsecret data\r\n"
+			"--xyz\r\nContent-Type: text/plain\r\n\r\ndata\r\n--xyz--";
+
+	for(unsigned int i = 0; i <= strlen(input); i++) {
+		uut.result.clear();
+		uut.reset();
+		CHECK(!parse(input, i, i));
+		CHECK(uut.result.find("secret") == std::string::npos);
+	}
+}
+
+TEST(MultipartParser, Invalid) {
+	static constexpr const char* inputs[] = {
+		"-b\r\n\r\n\r\n--b--",
+		"--\r\n\r\n\r\n--",
+		"--0123456789abcdefX\r\n\r\n\r\n--0123456789abcdefX--",
+		"--b\rx\r\n\r\n--b--",
+		"--b\r\n\r\n\r\n--bx",
+		"--b\r\nName: value\rx",
+	};
+
+	for(auto input: inputs) {
+		uut.reset();
+		CHECK(!parse(input, 0, 0));
+	}
+
+	CHECK(!uut.reset("0123456789abcdefX", 17));
+	CHECK(!uut.reset("b\r", 2));
+	CHECK(!uut.reset("", 0));
+}
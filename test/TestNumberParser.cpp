@@ -0,0 +1,109 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2017 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#include "1test/Test.h"
+
+#include "NumberParser.h"
+
+#include <string.h>
+
+TEST_GROUP(NumberParser) {
+    NumberParser uut;
+
+    bool parse(const char* str, unsigned int split) {
+        uut.reset();
+        const bool first = uut.parse(str, split);
+        return uut.parse(str + split, strlen(str) - split) && first && uut.done();
+    }
+
+    void integer(const char* str, int64_t expected) {
+        for(unsigned int i = 0; i < strlen(str); i++) {
+            CHECK(parse(str, i));
+            CHECK(uut.isInteger());
+            CHECK(uut.getInteger() == expected);
+        }
+    }
+
+    void real(const char* str, double expected) {
+        for(unsigned int i = 0; i < strlen(str); i++) {
+            CHECK(parse(str, i));
+            CHECK(!uut.isInteger());
+            CHECK(uut.getDouble() == expected);
+        }
+    }
+
+    void invalid(const char* str) {
+        for(unsigned int i = 0; i < strlen(str); i++)
+            CHECK(!parse(str, i));
+    }
+};
+
+TEST(NumberParser, Integers) {
+    integer("0", 0);
+    integer("-0", 0);
+    integer("42", 42);
+    integer("-42", -42);
+    integer("9223372036854775807", INT64_MAX);
+    integer("-9223372036854775808", INT64_MIN);
+}
+
+TEST(NumberParser, IntegerOverflow) {
+    real("9223372036854775808", 9223372036854775808.0);
+    real("-9223372036854775809", -9223372036854775809.0);
+    real("123456789012345678901234567890", 123456789012345678901234567890.0);
+}
+
+TEST(NumberParser, Fractions) {
+    real("0.5", 0.5);
+    real("-0.25", -0.25);
+    real("23.45", 23.45);
+    real("0.000001", 0.000001);
+    real("3.141592653589793", 3.141592653589793);
+}
+
+TEST(NumberParser, Exponents) {
+    real("1e3", 1e3);
+    real("1E+3", 1e3);
+    real("-2.5e-3", -2.5e-3);
+    real("6.02214076e23", 6.02214076e23);
+    real("1.7976931348623157e308", 1.7976931348623157e308);
+    real("4.9406564584124654e-324", 4.9406564584124654e-324);
+    real("2.2250738585072014E-308", 2.2250738585072014e-308);
+}
+
+TEST(NumberParser, LongMantissa) {
+    real("0.1000000000000000055511151231257827", 0.1);
+    real("3.14159265358979323846264338327950288", 3.14159265358979323846264338327950288);
+    real("100000000000000000000000.0", 1e23);
+}
+
+TEST(NumberParser, Invalid) {
+    invalid("-");
+    invalid("01");
+    invalid("-01");
+    invalid("1.");
+    invalid(".1");
+    invalid("1e");
+    invalid("1e+");
+    invalid("1.e3");
+    invalid("1-2");
+    invalid("--1");
+    invalid("+1");
+    invalid("1x");
+}
@@ -22,6 +22,8 @@
 
 #include "PathParser.h"
 
+#include <string>
+
 #include <stdio.h>
 #include <string.h>
 
@@ -121,3 +123,76 @@ TEST(PathParser, DirSegmented3) {
         }
     }
 }
+
+TEST_GROUP(PathParserEscapes) {
+	class UUT: public PathParser<UUT> {
+		friend PathParser<UUT>;
+		std::string current;
+
+		void beforeElement() {
+			current.clear();
+		}
+
+		void parseElement(const char* buff, unsigned int length) {
+			current += std::string(buff, length);
+		}
+
+		void elementDone() {
+			result += "<" + current + ">";
+		}
+
+	public:
+		std::string result;
+
+		void reset() {
+			result.clear();
+			PathParser<UUT>::reset();
+		}
+	};
+
+	UUT uut;
+
+	/*
+	 * Parses the input split at every possible pair of positions,
+	 * returns true if it is valid and the elements are as expected.
+	 */
+	bool check(const char* input, const char* expected, bool valid = true) {
+		for(unsigned int i = 0; i <= strlen(input); i++) {
+			for(unsigned int j = i; j <= strlen(input); j++) {
+				uut.reset();
+				uut.parsePath(input, i);
+				uut.parsePath(input + i, j - i);
+				uut.parsePath(input + j, strlen(input) - j);
+				uut.done();
+
+				if(uut.isValid() != valid || (valid && uut.result != expected))
+					return false;
+			}
+		}
+
+		return true;
+	}
+};
+
+TEST(PathParserEscapes, Plain) {
+	CHECK(check("/foo/bar", "<foo><bar>"));
+}
+
+TEST(PathParserEscapes, Decoded) {
+	CHECK(check("/foo%20bar/%41%62c", "<foo bar><Abc>"));
+	CHECK(check("/%e2%9C%93/x%25y/", "<\xe2\x9c\x93><x%y>"));
+	CHECK(check("%66oo", "<foo>"));
+}
+
+TEST(PathParserEscapes, Invalid) {
+	CHECK(check("/foo%2", "", false));
+	CHECK(check("/foo%/bar", "", false));
+	CHECK(check("/foo%g0", "", false));
+	CHECK(check("/foo%0g", "", false));
+}
+
+TEST(PathParserEscapes, Forbidden) {
+	CHECK(check("/foo%2fbar", "", false));
+	CHECK(check("/foo%2Fbar", "", false));
+	CHECK(check("/foo%00", "", false));
+}
@@ -0,0 +1,156 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2017 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#include "1test/Test.h"
+
+#include "QueryParser.h"
+
+#include <string>
+
+#include <string.h>
+
+TEST_GROUP(QueryParser) {
+	class UUT: public QueryParser<UUT> {
+		friend QueryParser<UUT>;
+		std::string key, value;
+
+		void parseKey(const char* buff, unsigned int length) {
+			key += std::string(buff, length);
+		}
+
+		void keyDone() {
+			result += key + "=";
+			key.clear();
+		}
+
+		void parseValue(const char* buff, unsigned int length) {
+			value += std::string(buff, length);
+		}
+
+		void valueDone() {
+			result += value + ";";
+			value.clear();
+		}
+
+	public:
+		std::string result;
+	};
+
+	static std::string parse(const char* input, unsigned int split, bool* valid = nullptr) {
+		UUT uut;
+		uut.reset();
+		uut.parseQuery(input, split);
+		uut.parseQuery(input + split, strlen(input) - split);
+		uut.done();
+
+		if(valid)
+			*valid = uut.isValid();
+
+		return uut.result;
+	}
+
+	static bool check(const char* input, const char* expected) {
+		for(unsigned int i = 0; i <= strlen(input); i++) {
+			bool valid;
+
+			if(parse(input, i, &valid) != expected || !valid)
+				return false;
+		}
+
+		return true;
+	}
+};
+
+TEST(QueryParser, Simple) {
+	CHECK(check("foo=bar&baz=qux", "foo=bar;baz=qux;"));
+}
+
+TEST(QueryParser, Empty) {
+	CHECK(check("", ""));
+	CHECK(check("&&", ""));
+	CHECK(check("foo=&&=bar&", "foo=;=bar;"));
+}
+
+TEST(QueryParser, NoValue) {
+	CHECK(check("foo&bar", "foo=;bar=;"));
+}
+
+TEST(QueryParser, Decoded) {
+	CHECK(check("f%6Fo=a+b%20c&x=1%3d2%26", "foo=a b c;x=1=2&;"));
+}
+
+TEST(QueryParser, EqualsInValue) {
+	CHECK(check("a=b=c", "a=b=c;"));
+}
+
+TEST(QueryParser, Invalid) {
+	static constexpr const char* inputs[] = {"a=%g0", "a=%0g", "a=%", "a=%1", "%&a=b"};
+
+	for(auto input: inputs) {
+		for(unsigned int i = 0; i <= strlen(input); i++) {
+			bool valid;
+			parse(input, i, &valid);
+			CHECK(!valid);
+		}
+	}
+}
+
+namespace {
+	struct Params {
+		enum Key {Foo, Bar};
+		static const Keywords<Key, 2> keywords;
+	};
+
+	const Keywords<Params::Key, 2> Params::keywords(
+		Keywords<Params::Key, 2>::Keyword("foo", Params::Foo),
+		Keywords<Params::Key, 2>::Keyword("bar", Params::Bar)
+	);
+}
+
+TEST_GROUP(QueryDispatcher) {
+	class UUT: public QueryDispatcher<UUT, Params> {
+		friend QueryDispatcher<UUT, Params>;
+
+		void onParameter(Params::Key key, const char* buff, uint32_t length) {
+			result += std::string(buff, length);
+		}
+
+		void parameterDone(Params::Key key) {
+			result += (key == Params::Foo) ? "<foo;" : "<bar;";
+		}
+
+	public:
+		std::string result;
+	};
+};
+
+TEST(QueryDispatcher, Known) {
+	static constexpr const char* input = "bar=1&fo=2&foo=3+4&foobar=5&baz&foo";
+
+	for(unsigned int i = 0; i <= strlen(input); i++) {
+		UUT uut;
+		uut.reset();
+		uut.parseQuery(input, i);
+		uut.parseQuery(input + i, strlen(input) - i);
+		uut.done();
+
+		CHECK(uut.isValid());
+		CHECK(uut.result == "1<bar;3 4<foo;<foo;");
+	}
+}
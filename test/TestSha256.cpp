@@ -0,0 +1,83 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2017 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#include "1test/Test.h"
+
+#include "sha256/sha256.h"
+
+#include <string>
+#include <string.h>
+
+TEST_GROUP(Sha256) {
+	static std::string hash(const std::string& in, unsigned int chunk) {
+		static const char hex[] = "0123456789abcdef";
+		unsigned char temp[32];
+		std::string ret;
+		SHA256_CTX ctx;
+		SHA256_Init(&ctx);
+
+		for(unsigned int i = 0; i < in.length(); i += chunk)
+			SHA256_Update(&ctx, in.data() + i, (in.length() - i < chunk) ? (in.length() - i) : chunk);
+
+		SHA256_Final(temp, &ctx);
+
+		for(unsigned char c: temp)
+			ret += std::string(1, hex[c >> 4]) + hex[c & 0xf];
+
+		return ret;
+	}
+
+	/*
+	 * Checks the result with the portable and (if available) the accelerated
+	 * kernel, feeding the input in one piece and in odd sized chunks too.
+	 */
+	static bool check(const std::string& in, const char* expected) {
+		for(int accelerated = 0; accelerated < 2; accelerated++) {
+			if(SHA256_Accelerate(accelerated) != accelerated)
+				continue;
+
+			for(unsigned int chunk: {(unsigned int)in.length() + 1, 1u, 3u, 63u, 65u})
+				if(hash(in, chunk) != expected)
+					return false;
+		}
+
+		return true;
+	}
+
+	TEST_TEARDOWN() {
+		SHA256_Accelerate(1);
+	}
+};
+
+TEST(Sha256, Empty) {
+	CHECK(check("", "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"));
+}
+
+TEST(Sha256, Short) {
+	CHECK(check("abc", "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"));
+}
+
+TEST(Sha256, TwoBlocks) {
+	CHECK(check("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq",
+			"248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1"));
+}
+
+TEST(Sha256, Long) {
+	CHECK(check(std::string(1000000, 'a'), "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0"));
+}
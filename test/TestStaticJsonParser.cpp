@@ -0,0 +1,197 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2017 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#include "1test/Test.h"
+
+#include "StaticJsonParser.h"
+
+#include <string.h>
+
+namespace {
+	constexpr char idKey[] = "id";
+	constexpr char typeKey[] = "type";
+	constexpr char ppuKey[] = "ppu";
+	constexpr char battersKey[] = "batters";
+	constexpr char batterKey[] = "batter";
+	constexpr char toppingKey[] = "topping";
+	constexpr char aKey[] = "a";
+	constexpr char bKey[] = "b";
+	constexpr char andKey[] = "and";
+	constexpr char flagKey[] = "flag";
+	constexpr char foobarKey[] = "foobar";
+	constexpr char fooKey[] = "foo";
+	constexpr char fobKey[] = "fob";
+	constexpr char collidingKey[] = "wHieEk";
+
+	static_assert(KeywordHash::of(foobarKey) == KeywordHash::of(collidingKey), "Not a collision");
+
+	constexpr const char* arrayTestDocument = "[\"0\", \"1\", \"2\", \"3\", \"4\", null, true, false]";
+	constexpr const char* nestObjectTestDocument = "{\"a\":{\"a\":0,\"b\":1},\"b\":{\"a\":2,\"b\":3}}";
+	constexpr const char* mismatchedTestDocument = "{\"a\":[{\"b\":1}],\"b\":{\"a\":2,\"b\":3},\"flag\":\"true\"}";
+	constexpr const char* collisionTestDocument = "{\"wHieEk\":1,\"fo\":2,\"fooba\":3,\"fob\":4,\"foo\":5,\"foobarr\":6,\"\":7}";
+	constexpr const char* erroneousTestDocument = "{0:\"meaning\", \"stupid\": [\"shit\"}, \"and\": \"one correct\", \"more\": bullshit, \"deep\":[[[[[[[[]]]]]]]]";
+	constexpr const char* complexTestDocument =
+		"{\r\n"
+		"  \"id\": \"0001\",\r\n"
+		"  \"type\": \"donut\",\r\n"
+		"  \"name\": \"Cake\",\r\n"
+		"  \"ppu\": 0.55,\r\n"
+		"  \"batters\":\r\n"
+		"    {\r\n"
+		"      \"batter\":\r\n"
+		"        [\r\n"
+		"          { \"id\": 1001, \"type\": \"Regular\" },\r\n"
+		"          { \"id\": 1002, \"type\": \"Chocolate\" },\r\n"
+		"          { \"id\": 1003, \"type\": \"Blueberry\" },\r\n"
+		"          { \"id\": 1004, \"type\": \"Devil's Food\" }\r\n"
+		"        ]\r\n"
+		"    },\r\n"
+		"  \"topping\":\r\n"
+		"    [\r\n"
+		"      { \"id\": 5001, \"type\": \"None\" },\r\n"
+		"      { \"id\": 5002, \"type\": \"Glazed\" },\r\n"
+		"      { \"id\": 5005, \"type\": \"Sugar\" },\r\n"
+		"      { \"id\": 5007, \"type\": \"Powdered Sugar\" },\r\n"
+		"      { \"id\": 5006, \"type\": \"Chocolate with Sprinkles\" },\r\n"
+		"      { \"id\": 5003, \"type\": \"Chocolate\" },\r\n"
+		"      { \"id\": 5004, \"type\": \"Maple\" }\r\n"
+		"    ]\r\n"
+		"}\r\n";
+
+	template<class Root>
+	bool parse(StaticJsonParser<8, Root>& uut, const char* document, size_t step = 0) {
+		const size_t length = strlen(document);
+
+		if(!step)
+			step = length;
+
+		uut.reset();
+		for(size_t offset = 0; offset < length; offset += step) {
+			const size_t n = (length - offset < step) ? (length - offset) : step;
+			if(!uut.parse(document + offset, n))
+				return false;
+		}
+
+		return uut.done();
+	}
+}
+
+TEST_GROUP(StaticJsonParser) {};
+
+TEST(StaticJsonParser, RootValues) {
+	StaticJsonParser<8, NumberExtractorT> number;
+	CHECK(parse(number, "42"));
+	CHECK(number.filter().value == 42);
+
+	StaticJsonParser<8, StringExtractorT<8>> string;
+	CHECK(parse(string, "\"foo\""));
+	CHECK(strcmp(string.filter().value, "foo") == 0);
+
+	StaticJsonParser<8, BoolExtractorT> boolean;
+	CHECK(parse(boolean, "true"));
+	CHECK(boolean.filter().value);
+}
+
+TEST(StaticJsonParser, SimpleArray) {
+	StaticJsonParser<8, ArrayFilterT<
+		Element<3, StringExtractorT<8>>,
+		Element<1, StringExtractorT<8>>,
+		Element<6, BoolExtractorT>
+	>> uut;
+
+	CHECK(parse(uut, arrayTestDocument));
+	CHECK(strcmp(uut.filter().get<1>().value, "1") == 0);
+	CHECK(strcmp(uut.filter().get<0>().value, "3") == 0);
+	CHECK(uut.filter().get<2>().value);
+}
+
+TEST(StaticJsonParser, NestedObjects) {
+	StaticJsonParser<8, ObjectFilterT<
+		Member<aKey, ObjectFilterT<Member<bKey, NumberExtractorT>>>,
+		Member<bKey, ObjectFilterT<Member<aKey, NumberExtractorT>>>
+	>> uut;
+
+	CHECK(parse(uut, nestObjectTestDocument));
+	CHECK(uut.filter().get<0>().get<0>().value == 1);
+	CHECK(uut.filter().get<1>().get<0>().value == 2);
+}
+
+TEST(StaticJsonParser, Mismatched) {
+	StaticJsonParser<8, ObjectFilterT<
+		Member<aKey, ObjectFilterT<Member<bKey, NumberExtractorT>>>,
+		Member<bKey, ArrayFilterT<Element<0, NumberExtractorT>>>,
+		Member<flagKey, BoolExtractorT>
+	>> uut;
+
+	CHECK(parse(uut, mismatchedTestDocument));
+	CHECK(uut.filter().get<0>().get<0>().value == 0);
+	CHECK(uut.filter().get<1>().get<0>().value == 0);
+	CHECK(!uut.filter().get<2>().value);
+}
+
+TEST(StaticJsonParser, Complex) {
+	StaticJsonParser<8, ObjectFilterT<
+		Member<typeKey, StringExtractorT<16>>,
+		Member<ppuKey, DoubleExtractorT>,
+		Member<battersKey, ObjectFilterT<
+			Member<batterKey, ArrayFilterT<
+				Element<3, ObjectFilterT<Member<typeKey, StringExtractorT<6>>>>
+			>>
+		>>,
+		Member<toppingKey, ArrayFilterT<
+			Element<1, ObjectFilterT<Member<idKey, NumberExtractorT>, Member<typeKey, StringExtractorT<16>>>>,
+			Element<6, ObjectFilterT<Member<idKey, NumberExtractorT>>>
+		>>
+	>> uut;
+
+	for(size_t step = 1; step <= 16; step++) {
+		CHECK(parse(uut, complexTestDocument, step));
+
+		auto& root = uut.filter();
+		CHECK(strcmp(root.get<0>().value, "donut") == 0);
+		CHECK(root.get<1>().value == 0.55);
+		CHECK(strcmp(root.get<2>().get<0>().get<0>().get<0>().value, "Devil") == 0);
+		CHECK(root.get<3>().get<0>().get<0>().value == 5002);
+		CHECK(strcmp(root.get<3>().get<0>().get<1>().value, "Glazed") == 0);
+		CHECK(root.get<3>().get<1>().get<0>().value == 5004);
+	}
+}
+
+TEST(StaticJsonParser, Collision) {
+	StaticJsonParser<8, ObjectFilterT<
+		Member<foobarKey, NumberExtractorT>,
+		Member<fooKey, NumberExtractorT>,
+		Member<fobKey, NumberExtractorT>
+	>> uut;
+
+	for(size_t step = 1; step <= 8; step++) {
+		CHECK(parse(uut, collisionTestDocument, step));
+		CHECK(uut.filter().get<0>().value == 0);
+		CHECK(uut.filter().get<1>().value == 5);
+		CHECK(uut.filter().get<2>().value == 4);
+	}
+}
+
+TEST(StaticJsonParser, Erroneous) {
+	StaticJsonParser<8, ObjectFilterT<Member<andKey, StringExtractorT<16>>>> uut;
+
+	parse(uut, erroneousTestDocument);
+	CHECK(!uut.isValid());
+	CHECK(strcmp(uut.filter().get<0>().value, "") == 0);
+}
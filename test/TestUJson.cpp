@@ -285,3 +285,221 @@ TEST(UJson, BunchOfStuffz) {
         expectLeaveObject();
     });
 }
+
+TEST(UJson, LongStrings) {
+    const std::string text = "Lorem ipsum dolor sit amet, consectetur adipiscing elit";
+    const std::string input = "[\"" + text + "\", \"" + text + "\\\\" + text + "\\\\\", {\"" + text + "\": \"\"}]";
+
+    for(bool vectorized: {false, true}) {
+        uut.accelerate(vectorized);
+
+        process(input.c_str(), [&](){
+            expectEnterArray();
+            expectString(text.c_str());
+            expectString((text + "\\" + text + "\\").c_str());
+            expectEnterObject();
+            expectKey(text.c_str());
+            expectString("");
+            expectLeaveObject();
+            expectLeaveArray();
+        });
+    }
+
+    uut.accelerate(true);
+}
+
+TEST(UJson, LongWhitespace) {
+    const std::string ws = "\r\n\t\t\t\t                    \t";
+    const std::string input = ws + "{" + ws + "\"foo\"" + ws + ":" + ws + "[" + ws + "1" + ws + "," + ws + "true" + ws + "]" + ws + "}" + ws;
+
+    for(bool vectorized: {false, true}) {
+        uut.accelerate(vectorized);
+
+        process(input.c_str(), [&](){
+            expectEnterObject();
+            expectKey("foo");
+            expectEnterArray();
+            expectNumber(1);
+            expectBoolean(true);
+            expectLeaveArray();
+            expectLeaveObject();
+        });
+    }
+
+    uut.accelerate(true);
+}
+
+TEST(UJson, Scanner) {
+    typedef detail::JsonScanner<> Scanner;
+    const char specials[] = {'"', '\\', '!', 'a', ' ', '\t', '\r', '\n', '\x80', '\xff'};
+
+    for(bool vectorized: {false, true}) {
+        Scanner::accelerate(vectorized);
+
+        for(char c: specials) {
+            for(unsigned int i = 0; i < 40; i++) {
+                std::string str(40, 'x'), ws(40, ' ');
+                str[i] = c;
+                ws[i] = c;
+
+                const char* expectedStr = str.data() + ((c == '"' || c == '\\') ? i : 40);
+                const char* expectedWs = ws.data() + ((c == ' ' || c == '\t' || c == '\r' || c == '\n') ? 40 : i);
+
+                CHECK(Scanner::string(str.data(), str.data() + 40) == expectedStr);
+                CHECK(Scanner::whitespace(ws.data(), ws.data() + 40) == expectedWs);
+                CHECK(Scanner::ascii(str.data(), str.data() + 40) == str.data() + ((c & 0x80) ? i : 40));
+            }
+        }
+    }
+
+    Scanner::accelerate(true);
+}
+
+TEST(UJson, Doubles) {
+    process("[0.5, -1.25e2, 3E-3, 1e400, -0.0]", [&](){
+        expectEnterArray();
+        expectDouble("0.5");
+        expectDouble("-125");
+        expectDouble("0.003");
+        expectDouble("inf");
+        expectDouble("-0");
+        expectLeaveArray();
+    });
+}
+
+TEST(UJson, BigIntegers) {
+    process("[2147483647, -2147483648, 2147483648, -9223372036854775809]", [&](){
+        expectEnterArray();
+        expectNumber(2147483647);
+        expectNumber(-2147483648);
+        expectValueError();
+        expectDouble("-9.22337e+18");
+        expectLeaveArray();
+    });
+}
+
+TEST(UJson, InvalidNumbers) {
+    process("[01, 1., -, 1e, .5, 1-2, 2]", [&](){
+        expectEnterArray();
+        expectValueError();
+        expectValueError();
+        expectValueError();
+        expectValueError();
+        expectValueError();
+        expectValueError();
+        expectNumber(2);
+        expectLeaveArray();
+    });
+}
+
+TEST(UJson, Truncated) {
+    process("{\"a\": [1]", [&](){
+        expectEnterObject();
+        expectKey("a");
+        expectEnterArray();
+        expectNumber(1);
+        expectLeaveArray();
+        expectStructureError();
+    });
+
+    process("[[1], 2", [&](){
+        expectEnterArray();
+        expectEnterArray();
+        expectNumber(1);
+        expectLeaveArray();
+        expectNumber(2);
+        expectStructureError();
+    });
+}
+
+TEST(UJson, Escapes) {
+    process("[\"a\\\"b\\/c\", \"\\u00e9\\u20AC\\ud83d\\ude00\", \"\\u0041\\u00\"]", [&](){
+        expectEnterArray();
+        expectString("a\"b/c");
+        expectString("\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80");
+        expectValueError();
+        expectString("A");
+        expectLeaveArray();
+    });
+}
+
+TEST(UJson, LoneSurrogates) {
+    process("[\"\\ud83dx\", \"\\ude00\", \"\\ud83d\\u0041\", \"\\ud83d\"]", [&](){
+        expectEnterArray();
+        expectString("\xef\xbf\xbdx");
+        expectString("\xef\xbf\xbd");
+        expectString("\xef\xbf\xbd" "A");
+        expectString("\xef\xbf\xbd");
+        expectLeaveArray();
+    });
+}
+
+TEST_GROUP(UJsonStrings) {
+    template<bool validate>
+    struct Uut: public UJson<Uut<validate>, 8> {
+        static constexpr bool validateUtf8 = validate;
+        std::string value;
+        unsigned int calls = 0, errors = 0;
+
+        inline void onString(const char *at, size_t length) {
+            value += std::string(at, length);
+            calls++;
+        }
+
+        inline void onKey(const char *at, size_t length) {
+            onString(at, length);
+        }
+
+        inline void onValueError() {errors++;}
+        inline void onKeyError() {errors++;}
+    };
+
+    template<bool validate>
+    void process(const std::string& input, const std::string& expected, unsigned int errors) {
+        for(unsigned int i = 0; i < input.length(); i++) {
+            Uut<validate> uut;
+            uut.reset();
+            uut.parse(input.data(), i);
+            uut.parse(input.data() + i, input.length() - i);
+            uut.done();
+
+            CHECK(uut.value == expected);
+            CHECK(uut.errors == errors);
+        }
+    }
+};
+
+TEST(UJsonStrings, Batched) {
+    Uut<false> uut;
+    const char* input = "\"\\t\\n\\u00e9\\\"\\\\\\/\\r\\b\\f\\u0041\\ud83d\\ude00x\\n\"";
+
+    uut.reset();
+    uut.parse(input, strlen(input));
+    uut.done();
+
+    CHECK(uut.value == "\t\n\xc3\xa9\"\\/\r\b\fA\xf0\x9f\x98\x80x\n");
+    CHECK(uut.calls == 3);
+}
+
+TEST(UJsonStrings, ValidUtf8) {
+    process<true>("\"h\xc3\xa9llo \xe2\x82\xac \xf0\x9f\x98\x80 \xef\xbf\xbf \xf4\x8f\xbf\xbf\"",
+            "h\xc3\xa9llo \xe2\x82\xac \xf0\x9f\x98\x80 \xef\xbf\xbf \xf4\x8f\xbf\xbf", 0);
+    process<true>("{\"\xc3\xa9\":\"" + std::string(40, 'x') + "\xc3\xa9" + std::string(40, 'x') + "\"}",
+            "\xc3\xa9" + std::string(40, 'x') + "\xc3\xa9" + std::string(40, 'x'), 0);
+}
+
+TEST(UJsonStrings, InvalidUtf8) {
+    process<true>("\"\xc3(\"", "\xc3(", 1);
+    process<true>("\"\xc0\xaf\"", "\xc0\xaf", 1);
+    process<true>("\"\xe0\x80\xaf\"", "\xe0\x80\xaf", 1);
+    process<true>("\"\xed\xa0\x80\"", "\xed\xa0\x80", 1);
+    process<true>("\"\xf4\x90\x80\x80\"", "\xf4\x90\x80\x80", 1);
+    process<true>("\"\xff\"", "\xff", 1);
+    process<true>("\"\xc3\"", "\xc3", 1);
+    process<true>("\"\xc3\\n\"", "\xc3\n", 1);
+    process<true>("{\"" + std::string(40, 'x') + "\x80\":1}", std::string(40, 'x') + "\x80", 1);
+}
+
+TEST(UJsonStrings, NotValidated) {
+    process<false>("\"\xc3(\"", "\xc3(", 0);
+}
@@ -0,0 +1,199 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2017 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+#include "1test/Test.h"
+
+#include "UJsonWriter.h"
+
+#include <math.h>
+
+namespace {
+	template<uint32_t bufferSize>
+	struct Writer: UJsonWriter<Writer<bufferSize>, bufferSize, 3> {
+		char output[512];
+		uint32_t length = 0, calls = 0, largest = 0;
+
+		void sendJson(const char* data, uint32_t n) {
+			memcpy(output + length, data, n);
+			length += n;
+			output[length] = '\0';
+			calls++;
+
+			if(n > largest)
+				largest = n;
+		}
+
+		inline Writer() {
+			this->reset();
+			output[0] = '\0';
+		}
+	};
+
+	template<class W>
+	void writeDocument(W& uut) {
+		auto root = uut.object();
+		root.string("name", "sensor");
+		root.integer("id", 17);
+		root.real("ratio", 0.25);
+		root.boolean("enabled", true);
+		root.null("comment");
+
+		auto list = root.array("values");
+		list.integer(-1);
+		list.boolean(false);
+		list.string("x");
+		list.null();
+
+		auto nested = list.object();
+		nested.string("a", "b");
+		nested.end();
+
+		auto empty = list.array();
+		empty.end();
+
+		list.end();
+		root.end();
+		uut.done();
+	}
+
+	constexpr const char* expectedDocument =
+			"{\"name\":\"sensor\",\"id\":17,\"ratio\":0.25,\"enabled\":true,\"comment\":null,"
+			"\"values\":[-1,false,\"x\",null,{\"a\":\"b\"},[]]}";
+}
+
+TEST_GROUP(UJsonWriter) {};
+
+TEST(UJsonWriter, Structure) {
+	Writer<64> uut;
+	writeDocument(uut);
+	CHECK(strcmp(uut.output, expectedDocument) == 0);
+	CHECK(uut.calls == 2);
+}
+
+TEST(UJsonWriter, SmallBuffer) {
+	Writer<1> one;
+	writeDocument(one);
+	CHECK(strcmp(one.output, expectedDocument) == 0);
+	CHECK(one.largest == 1);
+
+	Writer<7> seven;
+	writeDocument(seven);
+	CHECK(strcmp(seven.output, expectedDocument) == 0);
+	CHECK(seven.largest == 7);
+	CHECK(seven.calls == (strlen(expectedDocument) + 6) / 7);
+}
+
+TEST(UJsonWriter, EmptyRoot) {
+	Writer<16> uut;
+	uut.array().end();
+	uut.done();
+	CHECK(strcmp(uut.output, "[]") == 0);
+
+	Writer<16> other;
+	other.object().end();
+	other.done();
+	CHECK(strcmp(other.output, "{}") == 0);
+}
+
+TEST(UJsonWriter, Escapes) {
+	Writer<8> uut;
+	auto root = uut.array();
+	root.string("a\"b\\c/d");
+	root.string("\b\f\n\r\t");
+	root.string("\x01\x1f\x7f");
+	root.string("\xc3\xa1rv\xc3\xadz");
+	root.string("nul\0l", 5);
+	root.end();
+	uut.done();
+
+	CHECK(strcmp(uut.output,
+			"[\"a\\\"b\\\\c/d\",\"\\b\\f\\n\\r\\t\",\"\\u0001\\u001f\x7f\","
+			"\"\xc3\xa1rv\xc3\xadz\",\"nul\\u0000l\"]") == 0);
+}
+
+TEST(UJsonWriter, EscapedKeys) {
+	Writer<8> uut;
+	auto root = uut.object();
+	root.integer("\"quoted\"", 1);
+	root.end();
+	uut.done();
+
+	CHECK(strcmp(uut.output, "{\"\\\"quoted\\\"\":1}") == 0);
+}
+
+TEST(UJsonWriter, Integers) {
+	Writer<16> uut;
+	auto root = uut.array();
+	root.integer(0);
+	root.integer(7);
+	root.integer(10);
+	root.integer(99);
+	root.integer(100);
+	root.integer(-12345);
+	root.integer(INT64_MAX);
+	root.integer(INT64_MIN);
+	root.end();
+	uut.done();
+
+	CHECK(strcmp(uut.output, "[0,7,10,99,100,-12345,9223372036854775807,-9223372036854775808]") == 0);
+}
+
+TEST(UJsonWriter, Reals) {
+	Writer<16> uut;
+	auto root = uut.array();
+	root.real(0.0);
+	root.real(1.0);
+	root.real(-2.5);
+	root.real(0.1);
+	root.real(1e300);
+	root.real(-1.5e-10);
+	root.real(9007199254740993.0);
+	root.real(NAN);
+	root.real(INFINITY);
+	root.real(-INFINITY);
+	root.end();
+	uut.done();
+
+	CHECK(strcmp(uut.output, "[0,1,-2.5,0.1,1e+300,-1.5e-10,9007199254740992,null,null,null]") == 0);
+}
+
+TEST(UJsonWriter, RoundTrip) {
+	const double values[] = {1.0 / 3, 2.0 / 3, 0.55, 1e-300, 123456.789, 4.9e-324, 1.7976931348623157e308};
+
+	for(double value: values) {
+		Writer<16> uut;
+		auto root = uut.array();
+		root.real(value);
+		root.end();
+		uut.done();
+
+		CHECK(strtod(uut.output + 1, nullptr) == value);
+	}
+}
+
+TEST(UJsonWriter, Reuse) {
+	Writer<64> uut;
+	writeDocument(uut);
+
+	uut.length = 0;
+	uut.reset();
+	writeDocument(uut);
+
+	CHECK(strcmp(uut.output, expectedDocument) == 0);
+}
@@ -0,0 +1,541 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2017 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+#include "AuthDigest.h"
+#include "Base64.h"
+#include "HttpLogic.h"
+#include "JsonParser.h"
+#include "StaticJsonParser.h"
+#include "UJson.h"
+#include "UJsonWriter.h"
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <iostream>
+
+#include <stdio.h>
+#include <string.h>
+
+/*
+ * Throughput of the hash kernels and the rate of the digest
+ * authorization checks for both the MD5 and SHA-256 policies,
+ * the throughput of the base64 kernels and the JSON parser, the rate of
+ * the virtual and compile-time composed JSON filters, the throughput of
+ * the JSON writer, the throughput of chunked uploads and the number of writes
+ * it takes, followed by the per session memory usage of a few
+ * configurations.
+ */
+
+extern "C" {
+	void MD5Reference_Init(MD5_CTX *ctx);
+	void MD5Reference_Update(MD5_CTX *ctx, const void *data, unsigned long size);
+	void MD5Reference_Final(unsigned char *result, MD5_CTX *ctx);
+}
+
+/// The original MD5 implementation (see Md5Reference.c).
+struct DigestMd5Reference: DigestMd5 {
+	static inline void init(Context* ctx) {
+		MD5Reference_Init(ctx);
+	}
+
+	static inline void update(Context* ctx, const void* data, uint32_t size) {
+		MD5Reference_Update(ctx, data, size);
+	}
+
+	static inline void final(unsigned char* result, Context* ctx) {
+		MD5Reference_Final(result, ctx);
+	}
+};
+
+template<class Hash>
+static double hashThroughput(const std::string& data, unsigned int rounds)
+{
+	unsigned char result[Hash::length];
+	typename Hash::Context ctx;
+	volatile unsigned char sink = 0;
+
+	auto start = std::chrono::steady_clock::now();
+
+	for(unsigned int i = 0; i < rounds; i++) {
+		Hash::init(&ctx);
+		Hash::update(&ctx, data.data(), data.length());
+		Hash::final(result, &ctx);
+		sink ^= result[0];
+	}
+
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	return (double)data.length() * rounds / elapsed.count() / (1024 * 1024);
+}
+
+struct Md5Provider {
+	static constexpr const char* username = "Mufasa";
+	static constexpr const char* realm = "http-auth@example.org";
+	static constexpr const char* RFC2069_A1 = "3d78807defe7de2157e2b0b6573a855f";
+};
+
+struct Sha256Provider {
+	static constexpr const char* username = "Mufasa";
+	static constexpr const char* realm = "http-auth@example.org";
+	static constexpr const char* RFC2069_A1 = "7987c64c30e25f1b74be53f966b49b90f2808aa92faf9a00262392d7b4794232";
+};
+
+template<class Provider, class Hash>
+static double authRate(const char* response, unsigned int rounds)
+{
+	const std::string field = std::string("Digest username=\"Mufasa\", realm=\"http-auth@example.org\", "
+			"uri=\"/dir/index.html\", nonce=\"7ypf/xlj9XXwfDPEoM4URrv/xwf94BcC\", "
+			"nc=00000001, cnonce=\"f2/wE4q74E6zIJEtWaHKaf5wv/H5Qzzp\", qop=auth, "
+			"response=\"") + response + "\"";
+
+	AuthDigest<Provider, Hash> uut;
+	unsigned int authorized = 0;
+
+	auto start = std::chrono::steady_clock::now();
+
+	for(unsigned int i = 0; i < rounds; i++) {
+		uut.reset("GET");
+		uut.parseAuthField(field.data(), field.length());
+		uut.authFieldDone();
+		authorized += uut.isAuthorized();
+	}
+
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	if(authorized != rounds)
+		std::cerr << "Unexpected authorization failure" << std::endl;
+
+	return rounds / elapsed.count();
+}
+
+static void run(const char* name, bool accelerated)
+{
+	if(SHA256_Accelerate(accelerated) != accelerated) {
+		std::cout << name << ": not supported by the CPU" << std::endl;
+		return;
+	}
+
+	std::cout << name << ":" << std::endl;
+	std::cout << "\tSHA-256 64B: " << hashThroughput<DigestSha256>(std::string(64, 'x'), 1000000) << " MiB/s" << std::endl;
+	std::cout << "\tSHA-256 64KiB: " << hashThroughput<DigestSha256>(std::string(65536, 'x'), 2000) << " MiB/s" << std::endl;
+	std::cout << "\tSHA-256 auth: " << authRate<Sha256Provider, DigestSha256>(
+			"232f884cfd73b5407d03b8bbbdac93821d7ea8b4a8e041213d0246edc6517f7f", 200000) << " checks/s" << std::endl;
+}
+
+namespace {
+	struct Base64Sink: Base64::Parser<Base64Sink>, Base64::Formater<Base64Sink> {
+		std::string encoded;
+		volatile char sink = 0;
+
+		inline void bytesDecoded(const char* buff, uint32_t length) {
+			sink ^= buff[length - 1];
+		}
+
+		inline void bytesEncoded(const char* buff, uint32_t length) {
+			encoded.append(buff, length);
+		}
+	};
+}
+
+static void base64Throughput(const char* name, bool accelerated)
+{
+	if(Base64::accelerate(accelerated) != accelerated) {
+		std::cout << name << ": not supported by the CPU" << std::endl;
+		return;
+	}
+
+	static constexpr unsigned int rounds = 200;
+	const std::string data(65536, 'x');
+	Base64Sink uut;
+
+	auto start = std::chrono::steady_clock::now();
+
+	for(unsigned int i = 0; i < rounds; i++) {
+		uut.encoded.clear();
+		uut.Base64::Formater<Base64Sink>::reset();
+		uut.format(data.data(), data.length());
+		uut.Base64::Formater<Base64Sink>::done();
+	}
+
+	std::chrono::duration<double> encode = std::chrono::steady_clock::now() - start;
+	start = std::chrono::steady_clock::now();
+
+	for(unsigned int i = 0; i < rounds; i++) {
+		uut.Base64::Parser<Base64Sink>::reset();
+		uut.parse(uut.encoded.data(), uut.encoded.length());
+	}
+
+	std::chrono::duration<double> decode = std::chrono::steady_clock::now() - start;
+
+	std::cout << name << ":" << std::endl;
+	std::cout << "\tBase64 encode 64KiB: " << (double)data.length() * rounds / encode.count() / (1024 * 1024) << " MiB/s" << std::endl;
+	std::cout << "\tBase64 decode 64KiB: " << (double)data.length() * rounds / decode.count() / (1024 * 1024) << " MiB/s" << std::endl;
+}
+
+namespace {
+	struct JsonSink: UJson<JsonSink, 16> {
+		volatile size_t sink = 0;
+
+		inline void onKey(const char *at, size_t length) {
+			sink += length;
+		}
+
+		inline void onString(const char *at, size_t length) {
+			sink += length;
+		}
+	};
+}
+
+/*
+ * A pretty printed array of objects with mostly textual content,
+ * fed in TCP segment sized blocks.
+ */
+static void ujsonThroughput(const char* name, bool accelerated)
+{
+	if(JsonSink::accelerate(accelerated) != accelerated) {
+		std::cout << name << ": not supported by the CPU" << std::endl;
+		return;
+	}
+
+	static constexpr unsigned int rounds = 200;
+	static constexpr unsigned int segment = 1460;
+	std::string data = "[\n";
+
+	while(data.length() < 65536) {
+		data += "    {\n"
+				"        \"name\": \"sensor-node-17\",\n"
+				"        \"description\": \"Temperature and humidity sensor in the north wing, second floor\",\n"
+				"        \"location\": {\"building\": \"B\", \"room\": \"2.17\"},\n"
+				"        \"enabled\": true,\n"
+				"        \"interval\": 60\n"
+				"    },\n";
+	}
+
+	data += "    null\n]\n";
+
+	JsonSink uut;
+	auto start = std::chrono::steady_clock::now();
+
+	for(unsigned int i = 0; i < rounds; i++) {
+		uut.reset();
+
+		for(unsigned int j = 0; j < data.length(); j += segment)
+			uut.parse(data.data() + j, std::min<size_t>(segment, data.length() - j));
+
+		uut.done();
+	}
+
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	std::cout << name << ":" << std::endl;
+	std::cout << "\tUJson 64KiB: " << (double)data.length() * rounds / elapsed.count() / (1024 * 1024) << " MiB/s" << std::endl;
+}
+
+namespace {
+	constexpr const char configDocument[] =
+		"{\n"
+		"    \"version\": 3,\n"
+		"    \"hostname\": \"gateway-01\",\n"
+		"    \"network\": {\n"
+		"        \"dhcp\": false,\n"
+		"        \"address\": \"192.168.1.20\",\n"
+		"        \"netmask\": \"255.255.255.0\",\n"
+		"        \"gateway\": \"192.168.1.1\",\n"
+		"        \"dns\": [\"192.168.1.1\", \"8.8.8.8\"],\n"
+		"        \"mtu\": 1500\n"
+		"    },\n"
+		"    \"http\": {\"port\": 8080, \"keepAlive\": true, \"timeout\": 2.5},\n"
+		"    \"sensors\": [\n"
+		"        {\"name\": \"temperature\", \"interval\": 60, \"offset\": -0.25, \"enabled\": true},\n"
+		"        {\"name\": \"humidity\", \"interval\": 120, \"offset\": 1.5, \"enabled\": false},\n"
+		"        {\"name\": \"pressure\", \"interval\": 300, \"offset\": 0.0, \"enabled\": true}\n"
+		"    ],\n"
+		"    \"logging\": {\"level\": \"info\", \"remote\": null}\n"
+		"}\n";
+
+	constexpr char hostnameKey[] = "hostname";
+	constexpr char networkKey[] = "network";
+	constexpr char dhcpKey[] = "dhcp";
+	constexpr char addressKey[] = "address";
+	constexpr char mtuKey[] = "mtu";
+	constexpr char httpKey[] = "http";
+	constexpr char portKey[] = "port";
+	constexpr char timeoutKey[] = "timeout";
+	constexpr char sensorsKey[] = "sensors";
+	constexpr char intervalKey[] = "interval";
+	constexpr char offsetKey[] = "offset";
+	constexpr char loggingKey[] = "logging";
+	constexpr char levelKey[] = "level";
+
+	typedef ObjectFilterT<Member<intervalKey, NumberExtractorT>, Member<offsetKey, DoubleExtractorT>> SensorFilter;
+
+	typedef ObjectFilterT<
+		Member<hostnameKey, StringExtractorT<32>>,
+		Member<networkKey, ObjectFilterT<
+			Member<dhcpKey, BoolExtractorT>,
+			Member<addressKey, StringExtractorT<16>>,
+			Member<mtuKey, NumberExtractorT>
+		>>,
+		Member<httpKey, ObjectFilterT<Member<portKey, NumberExtractorT>, Member<timeoutKey, DoubleExtractorT>>>,
+		Member<sensorsKey, ArrayFilterT<Element<0, SensorFilter>, Element<2, SensorFilter>>>,
+		Member<loggingKey, ObjectFilterT<Member<levelKey, StringExtractorT<8>>>>
+	> ConfigFilter;
+}
+
+/*
+ * Extraction of the same handful of settings from a small configuration
+ * document using the virtual filter tree and the compile-time composed one.
+ */
+static void jsonFilterRate(unsigned int rounds)
+{
+	const size_t length = strlen(configDocument);
+	volatile int sink = 0;
+
+	char hostname[32], address[16], level[8];
+	int mtu, port, interval[2];
+	double timeout, offset[2];
+	bool dhcp;
+
+	auto hostnameExtractor = makeStringExtractor(hostname);
+	auto addressExtractor = makeStringExtractor(address);
+	auto levelExtractor = makeStringExtractor(level);
+	NumberExtractor mtuExtractor(mtu), portExtractor(port), intervalExtractors[] = {interval[0], interval[1]};
+	DoubleExtractor timeoutExtractor(timeout), offsetExtractors[] = {offset[0], offset[1]};
+	BoolExtractor dhcpExtractor(dhcp);
+
+	auto network = assemble<ObjectFilter>(
+			FilterEntry("dhcp", &dhcpExtractor),
+			FilterEntry("address", &addressExtractor),
+			FilterEntry("mtu", &mtuExtractor));
+	auto http = assemble<ObjectFilter>(FilterEntry("port", &portExtractor), FilterEntry("timeout", &timeoutExtractor));
+	auto first = assemble<ObjectFilter>(FilterEntry("interval", intervalExtractors + 0), FilterEntry("offset", offsetExtractors + 0));
+	auto last = assemble<ObjectFilter>(FilterEntry("interval", intervalExtractors + 1), FilterEntry("offset", offsetExtractors + 1));
+	auto sensors = assemble<ArrayFilter>(FilterEntry(0u, &first), FilterEntry(2u, &last));
+	auto logging = assemble<ObjectFilter>(FilterEntry("level", &levelExtractor));
+	auto root = assemble<ObjectFilter>(
+			FilterEntry("hostname", &hostnameExtractor),
+			FilterEntry("network", &network),
+			FilterEntry("http", &http),
+			FilterEntry("sensors", &sensors),
+			FilterEntry("logging", &logging));
+
+	JsonParser<8> virtualParser;
+	auto start = std::chrono::steady_clock::now();
+
+	for(unsigned int i = 0; i < rounds; i++) {
+		virtualParser.reset(&root);
+		virtualParser.parse(configDocument, length);
+		virtualParser.done();
+		sink += port + interval[1];
+	}
+
+	std::chrono::duration<double> virtualElapsed = std::chrono::steady_clock::now() - start;
+
+	StaticJsonParser<8, ConfigFilter> staticParser;
+	start = std::chrono::steady_clock::now();
+
+	for(unsigned int i = 0; i < rounds; i++) {
+		staticParser.reset();
+		staticParser.parse(configDocument, length);
+		staticParser.done();
+		sink += staticParser.filter().get<2>().get<0>().value + staticParser.filter().get<3>().get<1>().get<0>().value;
+	}
+
+	std::chrono::duration<double> staticElapsed = std::chrono::steady_clock::now() - start;
+
+	std::cout << "JSON filters (" << length << " byte configuration):" << std::endl;
+	std::cout << "	Virtual: " << rounds / virtualElapsed.count() << " docs/s" << std::endl;
+	std::cout << "	Static: " << rounds / staticElapsed.count() << " docs/s" << std::endl;
+}
+
+namespace {
+	struct JsonOutput: UJsonWriter<JsonOutput, 1460> {
+		size_t bytes = 0;
+		volatile char sink = 0;
+
+		inline void sendJson(const char* data, uint32_t length) {
+			bytes += length;
+			sink ^= data[length - 1];
+		}
+	};
+}
+
+/*
+ * An array of sensor readings with mixed value types,
+ * handed over in TCP segment sized blocks.
+ */
+static void ujsonWriterThroughput(unsigned int rounds)
+{
+	static constexpr unsigned int records = 1000;
+	JsonOutput uut;
+
+	auto start = std::chrono::steady_clock::now();
+
+	for(unsigned int i = 0; i < rounds; i++) {
+		uut.reset();
+
+		auto root = uut.array();
+
+		for(unsigned int j = 0; j < records; j++) {
+			auto record = root.object();
+			record.string("name", "sensor-node-17");
+			record.integer("timestamp", 1500000000 + j);
+			record.real("temperature", 21.5 + j * 0.01);
+			record.integer("humidity", 40 + j % 20);
+			record.boolean("valid", j & 1);
+			record.end();
+		}
+
+		root.end();
+		uut.done();
+	}
+
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	std::cout << "JSON writer:" << std::endl;
+	std::cout << "\t" << records << " records: " << (double)uut.bytes / elapsed.count() / (1024 * 1024) << " MiB/s" << std::endl;
+}
+
+namespace {
+	constexpr const char realm[] = "test";
+	constexpr const char nonceKey[] = "secret";
+
+	template<class... Options>
+	struct Session: HttpLogic<Session<Options...>, Options...> {
+		void send(const char* str, unsigned int length) {}
+		void flush() {}
+	};
+}
+
+namespace {
+	template<class... Options>
+	struct Upload: HttpLogic<Upload<Options...>, Options...> {
+		unsigned long writes = 0;
+		volatile char sink = 0;
+
+		void send(const char* str, unsigned int length) {}
+		void flush() {}
+
+		HttpStatus writeContent(const char* buff, uint32_t length) {
+			writes++;
+			sink ^= buff[length - 1];
+			return HTTP_STATUS_OK;
+		}
+	};
+}
+
+/*
+ * A chunked PUT request of 1 MiB content with the specified chunk size,
+ * fed in TCP segment sized blocks.
+ */
+template<class... Options>
+static void chunkedUpload(const char* name, unsigned int chunkSize, unsigned int rounds)
+{
+	static constexpr unsigned int size = 1024 * 1024;
+	static constexpr unsigned int segment = 1460;
+
+	std::string request = "PUT /upload HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n";
+	char header[16];
+
+	for(unsigned int i = 0; i < size; i += chunkSize) {
+		snprintf(header, sizeof(header), "%x\r\n", chunkSize);
+		request += header + std::string(chunkSize, 'x') + "\r\n";
+	}
+
+	request += "0\r\n\r\n";
+
+	Upload<Options...> uut;
+	auto start = std::chrono::steady_clock::now();
+
+	for(unsigned int i = 0; i < rounds; i++) {
+		uut.reset();
+
+		for(unsigned int j = 0; j < request.length(); j += segment)
+			uut.parse(request.data() + j, std::min<size_t>(segment, request.length() - j));
+
+		uut.done();
+	}
+
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	std::cout << "\t" << name << ": " << (double)size * rounds / elapsed.count() / (1024 * 1024) << " MiB/s, "
+			<< uut.writes / rounds << " writes/MiB" << std::endl;
+}
+
+template<class... Options>
+static void memoryReport(const char* name)
+{
+	typedef typename HttpLogic<Session<Options...>, Options...>::MemoryReport Report;
+
+	std::cout << "\t" << name << ": " << Report::session() << " bytes" << std::endl;
+	std::cout << "\t\tpath element: " << Report::pathElement() << std::endl;
+	std::cout << "\t\tdav request: " << Report::davRequest() << std::endl;
+	std::cout << "\t\tbody buffer: " << Report::bodyBuffer() << std::endl;
+	std::cout << "\t\tjson body: " << Report::jsonBody() << std::endl;
+	std::cout << "\t\tauthorization: " << Report::authorization() << std::endl;
+	std::cout << "\t\tauth cache: " << Report::authCache() << std::endl;
+	std::cout << "\t\tcontent digest: " << Report::contentDigest() << std::endl;
+}
+
+int main()
+{
+	std::cout << "MD5:" << std::endl;
+	std::cout << "\tMD5 64B: " << hashThroughput<DigestMd5>(std::string(64, 'x'), 1000000) << " MiB/s" << std::endl;
+	std::cout << "\tMD5 64KiB: " << hashThroughput<DigestMd5>(std::string(65536, 'x'), 2000) << " MiB/s" << std::endl;
+	std::cout << "\tMD5 auth: " << authRate<Md5Provider, DigestMd5>(
+			"8dd1e1a48a34eeb8b8aafc5df0765824", 200000) << " checks/s" << std::endl;
+
+	std::cout << "MD5 (reference):" << std::endl;
+	std::cout << "\tMD5 64B: " << hashThroughput<DigestMd5Reference>(std::string(64, 'x'), 1000000) << " MiB/s" << std::endl;
+	std::cout << "\tMD5 64KiB: " << hashThroughput<DigestMd5Reference>(std::string(65536, 'x'), 2000) << " MiB/s" << std::endl;
+	std::cout << "\tMD5 auth: " << authRate<Md5Provider, DigestMd5Reference>(
+			"8dd1e1a48a34eeb8b8aafc5df0765824", 200000) << " checks/s" << std::endl;
+
+	run("Portable", false);
+	run("SHA-NI", true);
+
+	base64Throughput("Base64 (portable)", false);
+	base64Throughput("Base64 (SSSE3)", true);
+
+	ujsonThroughput("JSON (portable)", false);
+	ujsonThroughput("JSON (SSE2)", true);
+
+	jsonFilterRate(200000);
+	ujsonWriterThroughput(200);
+
+	std::cout << "Chunked upload (64 byte chunks):" << std::endl;
+	chunkedUpload<>("Unbuffered", 64, 100);
+	chunkedUpload<HttpConfig::BodyBufferSize<512>>("BodyBufferSize<512>", 64, 100);
+	chunkedUpload<HttpConfig::BodyBufferSize<4096>>("BodyBufferSize<4096>", 64, 100);
+
+	std::cout << "Chunked upload (8 KiB chunks):" << std::endl;
+	chunkedUpload<>("Unbuffered", 8192, 100);
+	chunkedUpload<HttpConfig::BodyBufferSize<4096>>("BodyBufferSize<4096>", 8192, 100);
+
+	std::cout << "Session memory:" << std::endl;
+	memoryReport<>("Default");
+	memoryReport<HttpConfig::PathElementLength<255>>("PathElementLength<255>");
+	memoryReport<HttpConfig::DavStackSize<192>>("DavStackSize<192>");
+	memoryReport<HttpConfig::AuthRealm<realm>, HttpConfig::AuthNonceKey<nonceKey>, HttpConfig::AuthCache<true>>("AuthCache<true>");
+	memoryReport<HttpConfig::AuthRealm<realm>, HttpConfig::AuthNonceKey<nonceKey>, HttpConfig::AuthHash<DigestSha256>, HttpConfig::AuthCache<true>>("AuthHash<DigestSha256>, AuthCache<true>");
+	memoryReport<HttpConfig::ContentMd5<true>>("ContentMd5<true>");
+	memoryReport<HttpConfig::BodyBufferSize<512>>("BodyBufferSize<512>");
+	memoryReport<HttpConfig::JsonBodyDepth<8>>("JsonBodyDepth<8>");
+
+	return 0;
+}
@@ -0,0 +1,30 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2017 Tamás Seller. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *******************************************************************************/
+
+/*
+ * The original (unmodified step definitions) MD5 implementation under
+ * different names, as a baseline for the benchmark.
+ */
+
+#define MD5_REFERENCE
+#define MD5_Init MD5Reference_Init
+#define MD5_Update MD5Reference_Update
+#define MD5_Final MD5Reference_Final
+
+#include "md5/md5.c"